@@ -0,0 +1,509 @@
+/*
+
+Flash-Sale Admission Control and Virtual Waiting Room
+
+When a blockbuster opens, every request goes straight into BookTicketServiceDIP::execute
+(DIP/example.cpp). The seat DB and the payment gateway get far more work than they can do,
+their queues grow, every request gets slow, clients retry, and it collapses.
+
+Virtual waiting room :
+
+    user arrives -> gets a queue token (1, 2, 3 ...)     <- cheap, no backend work
+                 -> "you are #4521, about 40s"           <- or rejected right away if the
+                                                            estimated wait is too long
+                 -> polls until token < admittedUpTo      <- FIFO, fair
+                 -> execute() on the backend
+
+The waiting room is just a few atomic counters :
+
+    issued        next token to hand out
+    admittedUpTo  tokens below this may enter
+    finished      admitted requests that completed
+
+A million waiting users cost the server nothing : each user holds their own number.
+
+Every admitted token holds a backend slot under a lease (default 30s), kept in a fixed ring
+of 2 * maxLimit slots. complete() releases it, and the service wrapper calls complete() even
+when the backend throws. A user who is admitted and never comes back, or a call that hangs,
+loses the slot when the lease runs out. join(), mayEnter() and complete() take no lock :
+admission and release are CAS on the counters and the lease slots.
+
+How fast do we admit? Adaptive concurrency limit (AIMD, like TCP congestion control) :
+
+> at most `limit` admitted requests are in the backend at once
+> every window of completions we look at backend latency :
+    p90 below target -> limit + 1            (additive increase)
+    p90 above target -> limit * 0.8          (multiplicative decrease)
+
+So the limit settles around what the backend can really handle, and users wait in the
+cheap waiting room instead of in the expensive backend queue.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Admission controller
+//////////////////////////////////////////
+
+class AdmissionController {
+public:
+    struct Ticket {
+        bool accepted;
+        uint64_t token;
+        double estimatedWaitSec;     // for accepted and rejected users
+    };
+
+    using NowFn = function<double()>;    // seconds on a monotonic clock
+
+private:
+    // Leases : an admitted token holds slot (token & mask) until it completes OR its lease
+    // runs out (the user walked away, or the call hung). holder = token + 1, 0 = free;
+    // kClaiming marks a slot whose deadline is still being written.
+    static constexpr uint64_t kClaiming = 1ull << 63;
+
+    struct alignas(16) LeaseSlot {
+        atomic<uint64_t> holder{0};
+        atomic<double> deadline{0};
+    };
+
+    alignas(64) atomic<uint64_t> issued{0};
+    alignas(64) atomic<uint64_t> admittedUpTo{0};
+    alignas(64) atomic<uint64_t> finished{0};
+    alignas(64) atomic<double> limit;
+    atomic<double> rateEstimate{0};   // completions per second (EWMA)
+    atomic<double> nextExpiryScan{0};
+
+    // AIMD latency window : completions claim a cell, the one that fills the window closes it.
+    // Samples that arrive while a window is being closed are dropped.
+    alignas(64) atomic<size_t> windowClaimed{0};
+    atomic<size_t> windowWritten{0};
+    atomic<double> lastWindowEnd{-1};
+    unique_ptr<atomic<double>[]> window;
+
+    const double targetLatencySec;
+    const double maxWaitSec;
+    const double minLimit, maxLimit;
+    const size_t windowSize;
+    const double leaseSec;
+    const uint64_t leaseMask;
+    unique_ptr<LeaseSlot[]> leases;
+    NowFn now;
+
+    static double steadySeconds() { return chrono::duration<double>(Clock::now().time_since_epoch()).count(); }
+
+    LeaseSlot& slotOf(uint64_t token) const { return leases[token & leaseMask]; }
+
+    // Frees a lease if it ran out. Exactly one CAS wins, so the slot is counted finished once.
+    bool expire(LeaseSlot& slot, double t) {
+        uint64_t h = slot.holder.load(memory_order_acquire);
+        if (h == 0 || (h & kClaiming) || slot.deadline.load(memory_order_relaxed) > t) return false;
+        if (!slot.holder.compare_exchange_strong(h, 0, memory_order_acq_rel)) return false;
+        finished.fetch_add(1, memory_order_acq_rel);
+        return true;
+    }
+
+    // Leases that ran out behind the head are found by a sweep, at most every leaseSec / 8.
+    bool sweepExpired(double t) {
+        double due = nextExpiryScan.load(memory_order_relaxed);
+        if (t < due || !nextExpiryScan.compare_exchange_strong(due, t + leaseSec / 8)) return false;
+        bool freed = false;
+        for (uint64_t i = 0; i <= leaseMask; i++) freed |= expire(leases[i], t);
+        return freed;
+    }
+
+    // Lets more tokens in while fewer than `limit` admitted requests hold a slot. Lock-free :
+    // a token is admitted by claiming its lease slot, then moving admittedUpTo past it.
+    // Any thread that finds a claimed slot helps move admittedUpTo along.
+    void advance(double t) {
+        while (true) {
+            uint64_t a = admittedUpTo.load(memory_order_acquire);
+            if (a >= issued.load(memory_order_acquire)) return;
+            if (a - finished.load(memory_order_acquire) >= (uint64_t)limit.load(memory_order_relaxed)) {
+                if (sweepExpired(t)) continue;
+                return;
+            }
+            LeaseSlot& slot = slotOf(a);
+            uint64_t h = slot.holder.load(memory_order_acquire);
+            if ((h & ~kClaiming) == a + 1) {                 // already claimed for a : help
+                admittedUpTo.compare_exchange_strong(a, a + 1, memory_order_acq_rel);
+                continue;
+            }
+            if (h != 0) {                                     // an older token still holds the slot
+                if (expire(slot, t)) continue;
+                return;
+            }
+            if (!slot.holder.compare_exchange_strong(h, (a + 1) | kClaiming, memory_order_acq_rel)) continue;
+            if (admittedUpTo.load(memory_order_acquire) != a) {  // a was admitted and released meanwhile
+                slot.holder.store(0, memory_order_release);
+                continue;
+            }
+            slot.deadline.store(t + leaseSec, memory_order_relaxed);
+            slot.holder.store(a + 1, memory_order_release);
+            admittedUpTo.compare_exchange_strong(a, a + 1, memory_order_acq_rel);
+        }
+    }
+
+    void closeWindow(double t) {
+        vector<double> latencies(windowSize);
+        for (size_t i = 0; i < windowSize; i++) latencies[i] = window[i].load(memory_order_relaxed);
+        nth_element(latencies.begin(), latencies.begin() + windowSize * 9 / 10, latencies.end());
+        double p90 = latencies[windowSize * 9 / 10];
+        double current = limit.load();
+        double next = p90 <= targetLatencySec ? current + 1 : current * 0.8;
+        limit.store(clamp(next, minLimit, maxLimit));
+
+        double last = lastWindowEnd.load(memory_order_relaxed);
+        if (last >= 0 && t > last) {
+            double rate = windowSize / (t - last);
+            double old = rateEstimate.load(memory_order_relaxed);
+            rateEstimate.store(old == 0 ? rate : 0.8 * old + 0.2 * rate, memory_order_relaxed);
+        }
+        lastWindowEnd.store(t, memory_order_relaxed);
+        windowWritten.store(0, memory_order_relaxed);
+        windowClaimed.store(0, memory_order_release);
+    }
+
+public:
+    // leaseSec = infinity turns lease expiry off.
+    AdmissionController(double targetLatencySec, double maxWaitSec, double initialLimit = 10,
+                        double minLimit = 1, double maxLimit = 10000, size_t windowSize = 50,
+                        double leaseSec = 30, NowFn now = steadySeconds)
+        : limit(initialLimit), window(new atomic<double>[max<size_t>(windowSize, 1)]),
+          targetLatencySec(targetLatencySec), maxWaitSec(maxWaitSec), minLimit(minLimit), maxLimit(maxLimit),
+          windowSize(max<size_t>(windowSize, 1)), leaseSec(leaseSec),
+          leaseMask(bit_ceil((uint64_t)(2 * maxLimit)) - 1), leases(new LeaseSlot[leaseMask + 1]), now(move(now)) {}
+
+    double estimatedWait(uint64_t position) const {
+        double rate = rateEstimate.load(memory_order_relaxed);
+        if (rate <= 0) rate = limit.load() / targetLatencySec;
+        return position / rate;
+    }
+
+    // Join the queue. Rejected early if the wait would be longer than maxWaitSec.
+    Ticket join() {
+        uint64_t ahead = issued.load(memory_order_relaxed) - admittedUpTo.load(memory_order_relaxed);
+        double wait = estimatedWait(ahead);
+        if (wait > maxWaitSec) return {false, 0, wait};
+        uint64_t token = issued.fetch_add(1, memory_order_relaxed);
+        return {true, token, wait};
+    }
+
+    void advance() { advance(now()); }
+
+    // Poll : may this token enter now? Otherwise, how long is left?
+    // Throws if the token was admitted but its lease ran out before it came back.
+    bool mayEnter(uint64_t token, double* waitSec = nullptr) {
+        advance(now());
+        uint64_t admitted = admittedUpTo.load(memory_order_acquire);
+        if (token < admitted) {
+            if ((slotOf(token).holder.load(memory_order_acquire) & ~kClaiming) != token + 1) {
+                throw runtime_error("admission lease expired, join the queue again");
+            }
+            return true;
+        }
+        if (waitSec) *waitSec = estimatedWait(token - admitted + 1);
+        return false;
+    }
+
+    // Report a finished backend call, successful or not. Releases the token's slot once.
+    void complete(uint64_t token, double latencySec) {
+        double t = now();
+        LeaseSlot& slot = slotOf(token);
+        uint64_t h;
+        while ((h = slot.holder.load(memory_order_acquire)) == ((token + 1) | kClaiming)) this_thread::yield();
+        if (h == token + 1 && slot.holder.compare_exchange_strong(h, 0, memory_order_acq_rel)) {
+            finished.fetch_add(1, memory_order_acq_rel);
+        }
+
+        size_t cell = windowClaimed.fetch_add(1, memory_order_acq_rel);
+        if (cell < windowSize) {
+            window[cell].store(latencySec, memory_order_relaxed);
+            if (windowWritten.fetch_add(1, memory_order_acq_rel) + 1 == windowSize) closeWindow(t);
+        }
+        advance(t);
+    }
+
+    double currentLimit() const { return limit.load(); }
+    uint64_t waiting() const { return issued.load() - admittedUpTo.load(); }
+    uint64_t inBackend() const { return admittedUpTo.load() - finished.load(); }
+
+    // Fixed at construction : the lease ring and latency window are sized by maxLimit and
+    // windowSize, and a waiting user is only a number they hold.
+    size_t stateBytes() const {
+        return sizeof(*this) + (leaseMask + 1) * sizeof(LeaseSlot) + windowSize * sizeof(atomic<double>);
+    }
+};
+
+
+//////////////////////////////////////////
+// Service wrapper (DIP layers)
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class TicketRepositoryDIP : public ITicketRepository {
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        return "booking-for-" + userId;
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+// Sits in front of the service. Same execute() once the user's token is admitted.
+class AdmittedBookTicketService {
+private:
+    BookTicketServiceDIP& service;
+    AdmissionController& admission;
+
+public:
+    AdmittedBookTicketService(BookTicketServiceDIP& service, AdmissionController& admission)
+        : service(service), admission(admission) {}
+
+    AdmissionController::Ticket join() { return admission.join(); }
+
+    // Returns nullopt (and the remaining wait) while the token is still queued.
+    // The slot is released whether execute() returns or throws (sold out, payment failed).
+    optional<string> execute(uint64_t token, const string& userId, const string& movieId, double* waitSec) {
+        if (!admission.mayEnter(token, waitSec)) return nullopt;
+        struct Release {
+            AdmissionController& admission;
+            uint64_t token;
+            Clock::time_point start = Clock::now();
+            ~Release() { admission.complete(token, chrono::duration<double>(Clock::now() - start).count()); }
+        } release{admission, token};
+        return service.execute(userId, movieId);
+    }
+};
+
+
+//////////////////////////////////////////
+// Flash-sale simulation (discrete events, virtual time)
+//////////////////////////////////////////
+
+struct SimResult {
+    vector<double> backendLatency, totalLatency;
+    long rejected = 0;
+    size_t maxBackendQueue = 0;
+    uint64_t maxWaitingRoom = 0;
+};
+
+static double pct(vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    return v[min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+// Backend : `servers` parallel workers, exponential service time, unbounded FIFO queue.
+SimResult simulate(bool withAdmission, double arrivalRate, double burstSec, int servers, double meanServiceSec,
+                   double maxWaitSec) {
+    mt19937_64 rng(2024);
+    exponential_distribution<double> interArrival(arrivalRate), service(1.0 / meanServiceSec);
+    double simNow = 0;
+    AdmissionController admission(4 * meanServiceSec, maxWaitSec, servers / 2.0, 1, 10000, 50,
+                                  numeric_limits<double>::infinity(), [&] { return simNow; });
+    SimResult r;
+
+    struct Event {
+        double time;
+        int kind;        // 0 arrival, 1 backend completion
+        long user;
+        bool operator>(const Event& o) const { return time > o.time; }
+    };
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+    vector<double> arrivedAt, enteredBackendAt;
+    vector<uint64_t> tokenOf;
+    deque<long> backendQueue;
+    deque<pair<uint64_t, long>> waitingRoom;     // (token, user) in FIFO order
+    int busy = 0;
+
+    auto startService = [&](double now) {
+        while (busy < servers && !backendQueue.empty()) {
+            long u = backendQueue.front();
+            backendQueue.pop_front();
+            busy++;
+            events.push({now + service(rng), 1, u});
+        }
+    };
+    auto enterBackend = [&](long u, double now) {
+        enteredBackendAt[u] = now;
+        backendQueue.push_back(u);
+        r.maxBackendQueue = max(r.maxBackendQueue, backendQueue.size());
+        startService(now);
+    };
+    auto admitWaiting = [&](double now) {
+        while (!waitingRoom.empty() && admission.mayEnter(waitingRoom.front().first)) {
+            enterBackend(waitingRoom.front().second, now);
+            waitingRoom.pop_front();
+        }
+    };
+
+    for (double t = interArrival(rng); t < burstSec; t += interArrival(rng)) {
+        events.push({t, 0, (long)arrivedAt.size()});
+        arrivedAt.push_back(t);
+    }
+    enteredBackendAt.resize(arrivedAt.size());
+    tokenOf.resize(arrivedAt.size());
+
+    while (!events.empty()) {
+        Event e = events.top();
+        events.pop();
+        simNow = e.time;
+        if (e.kind == 0) {
+            if (!withAdmission) { enterBackend(e.user, e.time); continue; }
+            auto ticket = admission.join();
+            if (!ticket.accepted) { r.rejected++; continue; }
+            tokenOf[e.user] = ticket.token;
+            waitingRoom.push_back({ticket.token, e.user});
+            r.maxWaitingRoom = max(r.maxWaitingRoom, admission.waiting());
+            admitWaiting(e.time);
+        } else {
+            busy--;
+            double backend = e.time - enteredBackendAt[e.user];
+            r.backendLatency.push_back(backend);
+            r.totalLatency.push_back(e.time - arrivedAt[e.user]);
+            startService(e.time);
+            if (withAdmission) {
+                admission.complete(tokenOf[e.user], backend);
+                admitWaiting(e.time);
+            }
+        }
+    }
+    return r;
+}
+
+void report(const string& label, SimResult r) {
+    cout << label << " : served " << r.backendLatency.size() << ", rejected early " << r.rejected
+         << "\n    backend latency  p50 " << fixed << setprecision(3) << pct(r.backendLatency, 0.5)
+         << "s  p99 " << pct(r.backendLatency, 0.99) << "s  p99.9 " << pct(r.backendLatency, 0.999)
+         << "s   (max backend queue " << r.maxBackendQueue << ")"
+         << "\n    user total wait  p50 " << pct(r.totalLatency, 0.5) << "s  p99 " << pct(r.totalLatency, 0.99)
+         << "s   (max waiting room " << r.maxWaitingRoom << ")\n";
+}
+
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+class SoldOutRepository : public ITicketRepository {
+public:
+    string bookTicket(const string& userId, const string& movieId) override { throw runtime_error("sold out"); }
+};
+
+void checks() {
+    double t = 0;
+    auto clock = [&] { return t; };
+
+    AdmissionController fifo(1.0, 1e9, 3, 1, 10000, 50, 30, clock);
+    vector<uint64_t> tokens;
+    for (int i = 0; i < 10; i++) tokens.push_back(fifo.join().token);
+    bool order = fifo.mayEnter(tokens[0]) && fifo.mayEnter(tokens[2]) && !fifo.mayEnter(tokens[3]);
+    fifo.complete(tokens[0], 0.1);
+    order &= fifo.mayEnter(tokens[3]) && !fifo.mayEnter(tokens[4]);
+    check(order, "tokens are admitted in FIFO order, at most `limit` in the backend");
+
+    AdmissionController aimd(0.05, 1e9, 10, 1, 100, 10, 30, clock);
+    for (int i = 0; i < 30; i++) aimd.join();
+    aimd.advance();
+    for (int i = 0; i < 10; i++) aimd.complete(i, 0.01);
+    double grown = aimd.currentLimit();
+    for (int i = 10; i < 20; i++) aimd.complete(i, 0.5);
+    check(grown == 11 && aimd.currentLimit() < grown, "limit grows when fast, shrinks when slow");
+
+    // A throwing backend must still hand the slot back.
+    SoldOutRepository soldOut;
+    BookTicketServiceDIP failing(&soldOut);
+    AdmissionController one(1.0, 1e9, 1, 1, 1, 50, 30, clock);
+    AdmittedBookTicketService gate(failing, one);
+    long thrown = 0;
+    for (int i = 0; i < 5; i++) {
+        auto ticket = gate.join();
+        try { gate.execute(ticket.token, "u", "m", nullptr); } catch (const runtime_error&) { thrown++; }
+    }
+    check(thrown == 5 && one.inBackend() == 0, "a request that throws releases its admission slot");
+
+    // A user who is admitted and walks away only holds the slot until the lease runs out.
+    AdmissionController leased(1.0, 1e9, 1, 1, 1, 50, 10, clock);
+    auto gone = leased.join(), next = leased.join();
+    bool admittedThenBlocked = leased.mayEnter(gone.token) && !leased.mayEnter(next.token);
+    t = 11;
+    bool expiredThrows = false;
+    bool nextIn = leased.mayEnter(next.token);
+    try { leased.mayEnter(gone.token); } catch (const runtime_error&) { expiredThrows = true; }
+    check(admittedThenBlocked && nextIn && expiredThrows, "an abandoned token's lease expires and frees its slot");
+    leased.complete(gone.token, 0.1);
+    check(leased.inBackend() == 1, "a late complete() for an expired lease is not counted twice");
+    t = 0;
+
+    // Many threads polling and completing at once : never more than `limit` inside, nothing leaks.
+    AdmissionController shared(1.0, 1e9, 8, 8, 8, 50, 30);
+    atomic<int> inside{0}, peak{0};
+    vector<thread> users;
+    for (int w = 0; w < 4; w++) {
+        users.emplace_back([&] {
+            for (int i = 0; i < 2000; i++) {
+                uint64_t token = shared.join().token;
+                while (!shared.mayEnter(token)) this_thread::yield();
+                int now = ++inside;
+                for (int seen = peak.load(); now > seen && !peak.compare_exchange_weak(seen, now);) {}
+                inside--;
+                shared.complete(token, 0.001);
+            }
+        });
+    }
+    for (auto& u : users) u.join();
+    check(peak <= 8 && shared.inBackend() == 0 && shared.waiting() == 0,
+          "concurrent polls and completions keep the limit and release every slot (peak " + to_string(peak.load()) + ")");
+
+    AdmissionController small(1.0, 5.0, 2, 1, 10000, 50, 30, clock);         // ~2 admissions/sec, so ~10 users fit in 5s
+    int accepted = 0;
+    for (int i = 0; i < 100; i++) accepted += small.join().accepted;
+    check(accepted > 5 && accepted < 20, "users beyond the max wait are rejected early");
+}
+
+
+int main() {
+    checks();
+    cout << "\n";
+
+    TicketRepositoryDIP repo;
+    BookTicketServiceDIP service(&repo);
+    AdmissionController admission(0.05, 60.0, 2);
+    AdmittedBookTicketService gate(service, admission);
+
+    vector<AdmissionController::Ticket> tickets;
+    for (int i = 0; i < 4; i++) tickets.push_back(gate.join());
+    for (int i = 0; i < 4; i++) {
+        double wait = 0;
+        auto id = gate.execute(tickets[i].token, "u" + to_string(i), "m101", &wait);
+        if (id) cout << "user " << i << " admitted : " << *id << "\n";
+        else cout << "user " << i << " waiting, about " << fixed << setprecision(2) << wait << "s\n";
+    }
+    cout << "admission state is " << admission.stateBytes() << " bytes, fixed at construction, no matter how many users wait\n";
+
+    cout << "\n--- flash sale : 5000 req/s for 20s, backend 50 workers x 20ms (capacity 2500 req/s) ---\n";
+    report("without admission      ", simulate(false, 5000, 20, 50, 0.02, 0));
+    report("with admission         ", simulate(true, 5000, 20, 50, 0.02, 1e9));
+    report("with admission, max 5s ", simulate(true, 5000, 20, 50, 0.02, 5));
+
+    return 0;
+}
@@ -0,0 +1,680 @@
+/*
+
+Per-Subsystem Allocation Accounting
+
+Problem :
+    We think allocation churn is where the booking path spends its CPU :
+        > string copies in BookTicketControllerDIP::handleRequest (map<string,string> in and out)
+        > vector<string> in Order (SOLID/SRP/examples.cpp)
+        > a fresh unique_ptr<PaymentStrategy>/<DiscountStrategy> per PaymentProcessor/DiscountEngine
+    But nothing shows us who allocates what.
+
+Solution :
+
+    global operator new / delete (replaced)
+        -> every block gets a 16 byte header : { size, subsystem tag }
+        -> counters are PER THREAD (owner thread writes, no lock, no shared cache line)
+        -> the tag comes from a thread-local "current subsystem", set by AllocScope (RAII, nests)
+        -> delete reads the header, so a free is charged to the subsystem that allocated it,
+           whichever thread or scope frees it
+
+    snapshotAllocations()  : sums all threads (live + exited) -> AllocSnapshot, supports a - b
+    AllocSampler           : background thread taking a snapshot every interval
+    stack sampling         : optional, 1 in N allocations records a backtrace() into a ring
+
+Build modes :
+    > default (no NDEBUG)         : tracking compiled in
+    > -DNDEBUG (release)          : compiled OUT, AllocScope is an empty struct, operator new is the library one
+    > -DNDEBUG -DALLOC_TRACKING   : force it on in a release build
+
+*/
+
+#include<bits/stdc++.h>
+#include<cxxabi.h>
+#include<execinfo.h>
+using namespace std;
+
+#if !defined(NDEBUG) || defined(ALLOC_TRACKING)
+#define ALLOC_TRACKING_ENABLED 1
+#else
+#define ALLOC_TRACKING_ENABLED 0
+#endif
+
+
+//////////////////////////////////////////
+// Tags + snapshots
+//////////////////////////////////////////
+
+enum class Subsystem : uint8_t { Untagged, Controller, Service, Repository, Order, Payment, Discount, Notification, Count };
+
+constexpr int SubsystemCount = (int)Subsystem::Count;
+
+const char* subsystemName(Subsystem s) {
+    static const char* names[] = {"untagged", "controller", "service", "repository", "order", "payment", "discount", "notification"};
+    return names[(int)s];
+}
+
+struct AllocCounters {
+    uint64_t allocs = 0, bytes = 0;
+    uint64_t frees = 0, freedBytes = 0;
+
+    uint64_t liveBytes() const { return bytes - freedBytes; }
+};
+
+struct AllocSnapshot {
+    array<AllocCounters, SubsystemCount> by{};
+
+    const AllocCounters& operator[](Subsystem s) const { return by[(int)s]; }
+
+    AllocCounters total() const {
+        AllocCounters t;
+        for (auto& c : by) { t.allocs += c.allocs; t.bytes += c.bytes; t.frees += c.frees; t.freedBytes += c.freedBytes; }
+        return t;
+    }
+
+    AllocSnapshot operator-(const AllocSnapshot& earlier) const {
+        AllocSnapshot d;
+        for (int i = 0; i < SubsystemCount; i++) {
+            d.by[i] = {by[i].allocs - earlier.by[i].allocs, by[i].bytes - earlier.by[i].bytes,
+                       by[i].frees - earlier.by[i].frees, by[i].freedBytes - earlier.by[i].freedBytes};
+        }
+        return d;
+    }
+};
+
+struct StackSample {
+    Subsystem tag;
+    uint32_t size;
+    int depth;
+    void* frames[16];
+};
+
+
+#if ALLOC_TRACKING_ENABLED
+
+//////////////////////////////////////////
+// Per-thread counters
+//////////////////////////////////////////
+
+// One slot per thread. Slots are never freed : when a thread exits its slot is handed to
+// the next new thread and keeps counting, so totals never go backwards.
+struct ThreadAllocStats {
+    struct Counter {
+        atomic<uint64_t> allocs{0}, bytes{0}, frees{0}, freedBytes{0};
+    };
+    Counter by[SubsystemCount];
+    atomic<bool> inUse{true};
+    bool shared = false;                  // the overflow slot, written by many threads
+    ThreadAllocStats* next = nullptr;
+
+    // Owner-only writes don't need an atomic read-modify-write, just a relaxed store
+    // that snapshot readers can load without tearing.
+    void add(atomic<uint64_t>& c, uint64_t v) {
+        if (shared) c.fetch_add(v, memory_order_relaxed);
+        else c.store(c.load(memory_order_relaxed) + v, memory_order_relaxed);
+    }
+};
+
+class AllocRegistry {
+private:
+    atomic<ThreadAllocStats*> head{nullptr};
+    ThreadAllocStats overflow;            // used while a thread is being torn down
+
+    static inline thread_local ThreadAllocStats* mine = nullptr;
+    static inline thread_local bool exiting = false;
+
+    struct ReleaseOnExit {
+        ~ReleaseOnExit() {
+            if (mine) mine->inUse.store(false, memory_order_release);
+            mine = nullptr;
+            exiting = true;
+        }
+    };
+
+    ThreadAllocStats* claim() {
+        for (ThreadAllocStats* s = head.load(memory_order_acquire); s; s = s->next) {
+            bool expected = false;
+            if (s->inUse.compare_exchange_strong(expected, true, memory_order_acquire)) return s;
+        }
+        // malloc, not new : we are inside operator new
+        auto* s = new (malloc(sizeof(ThreadAllocStats))) ThreadAllocStats();
+        s->next = head.load(memory_order_relaxed);
+        while (!head.compare_exchange_weak(s->next, s, memory_order_release)) {}
+        return s;
+    }
+
+public:
+    AllocRegistry() { overflow.shared = true; }
+
+    ThreadAllocStats& local() {
+        if (mine) [[likely]] return *mine;
+        if (exiting) return overflow;
+        static thread_local ReleaseOnExit guard;
+        (void)guard;
+        mine = claim();
+        return *mine;
+    }
+
+    AllocSnapshot snapshot() {
+        AllocSnapshot snap;
+        auto collect = [&](ThreadAllocStats& s) {
+            for (int i = 0; i < SubsystemCount; i++) {
+                snap.by[i].allocs += s.by[i].allocs.load(memory_order_relaxed);
+                snap.by[i].bytes += s.by[i].bytes.load(memory_order_relaxed);
+                snap.by[i].frees += s.by[i].frees.load(memory_order_relaxed);
+                snap.by[i].freedBytes += s.by[i].freedBytes.load(memory_order_relaxed);
+            }
+        };
+        for (ThreadAllocStats* s = head.load(memory_order_acquire); s; s = s->next) collect(*s);
+        collect(overflow);
+        return snap;
+    }
+};
+
+AllocRegistry& registry() {
+    static AllocRegistry r;               // constant-initialised members : safe before main()
+    return r;
+}
+
+
+//////////////////////////////////////////
+// Scopes + stack sampling
+//////////////////////////////////////////
+
+thread_local Subsystem currentSubsystem = Subsystem::Untagged;
+thread_local bool insideHook = false;
+thread_local uint32_t sampleCountdown = 0;
+
+class AllocScope {
+private:
+    Subsystem previous;
+
+public:
+    explicit AllocScope(Subsystem tag) : previous(currentSubsystem) { currentSubsystem = tag; }
+    ~AllocScope() { currentSubsystem = previous; }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+};
+
+class StackSampler {
+private:
+    static constexpr uint32_t Capacity = 4096;
+    StackSample ring[Capacity];
+    mutex ringLock;                       // writers fill a slot and readers copy the ring under it
+    uint32_t written = 0;
+    atomic<uint32_t> every{0};            // 0 = off
+
+public:
+    void enable(uint32_t oneIn) { every.store(oneIn, memory_order_relaxed); }
+    void disable() { every.store(0, memory_order_relaxed); }
+
+    void maybeRecord(Subsystem tag, size_t size) {
+        uint32_t n = every.load(memory_order_relaxed);
+        if (n == 0) return;
+        if (sampleCountdown > 1 && sampleCountdown <= n) { sampleCountdown--; return; }
+        sampleCountdown = n;
+        StackSample sample;                // unwind outside the lock, only the copy is serialised
+        sample.tag = tag;
+        sample.size = (uint32_t)min<size_t>(size, UINT32_MAX);
+        sample.depth = backtrace(sample.frames, 16);
+        lock_guard<mutex> guard(ringLock);
+        ring[written++ % Capacity] = sample;
+    }
+
+    // Safe while other threads are still sampling. The vector is sized before taking the lock :
+    // allocating under it would re-enter maybeRecord() on this thread and self-deadlock.
+    vector<StackSample> samples() {
+        vector<StackSample> out(Capacity);
+        lock_guard<mutex> guard(ringLock);
+        out.resize(min(written, Capacity));
+        copy(ring, ring + out.size(), out.begin());
+        return out;
+    }
+
+    void clear() {
+        lock_guard<mutex> guard(ringLock);
+        written = 0;
+    }
+};
+
+StackSampler& stackSampler() {
+    static StackSampler s;
+    return s;
+}
+
+AllocSnapshot snapshotAllocations() { return registry().snapshot(); }
+
+
+//////////////////////////////////////////
+// The hook
+//////////////////////////////////////////
+
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    Subsystem tag;
+};
+static_assert(sizeof(BlockHeader) == 16);
+
+static void* trackedAlloc(size_t size) {
+    if (size > SIZE_MAX - sizeof(BlockHeader)) return nullptr;    // header would wrap the request
+    auto* h = (BlockHeader*)malloc(size + sizeof(BlockHeader));
+    if (!h) return nullptr;
+    h->size = size;
+    h->tag = currentSubsystem;
+    if (!insideHook) {
+        insideHook = true;
+        auto& stats = registry().local();
+        auto& c = stats.by[(int)h->tag];
+        stats.add(c.allocs, 1);
+        stats.add(c.bytes, size);
+        stackSampler().maybeRecord(h->tag, size);
+        insideHook = false;
+    }
+    return h + 1;
+}
+
+static void trackedFree(void* p) {
+    if (!p) return;
+    auto* h = (BlockHeader*)p - 1;
+    if (!insideHook) {
+        insideHook = true;
+        auto& stats = registry().local();
+        auto& c = stats.by[(int)h->tag];
+        stats.add(c.frees, 1);
+        stats.add(c.freedBytes, h->size);
+        insideHook = false;
+    }
+    free(h);
+}
+
+void* operator new(size_t size) {
+    if (void* p = trackedAlloc(size)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { trackedFree(p); }
+// over-aligned new/delete are left to the library; they never see our header.
+
+#else
+
+struct AllocScope {
+    explicit AllocScope(Subsystem) {}
+};
+
+struct StackSampler {
+    void enable(uint32_t) {}
+    void disable() {}
+    vector<StackSample> samples() { return {}; }
+    void clear() {}
+};
+
+StackSampler& stackSampler() {
+    static StackSampler s;
+    return s;
+}
+
+AllocSnapshot snapshotAllocations() { return {}; }
+
+#endif
+
+
+//////////////////////////////////////////
+// Periodic snapshots
+//////////////////////////////////////////
+
+class AllocSampler {
+private:
+    chrono::milliseconds interval;
+    vector<pair<double, AllocSnapshot>> history;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+    thread worker;
+
+public:
+    explicit AllocSampler(chrono::milliseconds interval) : interval(interval) {
+        auto start = chrono::steady_clock::now();
+        history.reserve(1024);
+        worker = thread([this, start] {
+            unique_lock<mutex> guard(lock);
+            while (!stopping) {
+                AllocSnapshot snap = snapshotAllocations();
+                if (history.size() < history.capacity()) {
+                    history.push_back({chrono::duration<double>(chrono::steady_clock::now() - start).count(), snap});
+                }
+                wake.wait_for(guard, this->interval, [&] { return stopping; });
+            }
+        });
+    }
+
+    ~AllocSampler() { stop(); }
+
+    void stop() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+    vector<pair<double, AllocSnapshot>> snapshots() {
+        lock_guard<mutex> guard(lock);
+        return history;
+    }
+};
+
+
+//////////////////////////////////////////
+// The booking path, tagged (SOLID/DIP, SOLID/SRP, SOLID/OCP)
+//////////////////////////////////////////
+
+class Order {
+private:
+    vector<string> items;
+
+public:
+    void addItem(const string& item) {
+        AllocScope scope(Subsystem::Order);
+        items.push_back(item);
+    }
+
+    int getTotalPrice() const { return items.size() * 100; }
+};
+
+class PaymentStrategy {
+public:
+    virtual bool pay(int amount) const = 0;
+    virtual ~PaymentStrategy() = default;
+};
+
+class UPIPayment : public PaymentStrategy {
+public:
+    bool pay(int amount) const override { return amount > 0; }
+};
+
+class PaymentProcessor {
+private:
+    unique_ptr<PaymentStrategy> strategy;
+
+public:
+    PaymentProcessor(unique_ptr<PaymentStrategy> strategy) : strategy(move(strategy)) {}
+    bool process(int amount) const { return strategy->pay(amount); }
+};
+
+class DiscountStrategy {
+public:
+    virtual int getDiscount(int amount) = 0;
+    virtual ~DiscountStrategy() = default;
+};
+
+class StudentDiscount : public DiscountStrategy {
+public:
+    int getDiscount(int amount) override { return static_cast<int>(amount * 0.1); }
+};
+
+class DiscountEngine {
+private:
+    unique_ptr<DiscountStrategy> discount;
+
+public:
+    DiscountEngine(unique_ptr<DiscountStrategy> discount) : discount(move(discount)) {}
+    int applyDiscount(int amount) { return amount - discount->getDiscount(amount); }
+};
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class TicketRepositoryDIP : public ITicketRepository {
+private:
+    unordered_map<string, vector<string>> bookingsByUser;
+
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        AllocScope scope(Subsystem::Repository);
+        string bookingId = "BK-" + movieId + "-" + userId + "-" + to_string(bookingsByUser.size());
+        bookingsByUser[userId].push_back(bookingId);
+        return bookingId;
+    }
+};
+
+class BookTicketServiceDIP {
+private:
+    ITicketRepository* repo;
+
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId, const string& seats) {
+        AllocScope scope(Subsystem::Service);
+        Order order;
+        stringstream parts(seats);
+        for (string seat; getline(parts, seat, ',');) order.addItem(movieId + ":" + seat);
+
+        int amount;
+        {
+            AllocScope discountScope(Subsystem::Discount);
+            DiscountEngine engine(make_unique<StudentDiscount>());
+            amount = engine.applyDiscount(order.getTotalPrice());
+        }
+        {
+            AllocScope paymentScope(Subsystem::Payment);
+            PaymentProcessor processor(make_unique<UPIPayment>());
+            if (!processor.process(amount)) throw runtime_error("payment failed");
+        }
+
+        string bookingId = repo->bookTicket(userId, movieId);
+        {
+            AllocScope notifyScope(Subsystem::Notification);
+            string message = "Hi " + userId + ", your booking " + bookingId + " for " + movieId + " is confirmed. Paid " + to_string(amount);
+            asm volatile("" : : "r"(message.data()) : "memory");
+        }
+        return bookingId;
+    }
+};
+
+class BookTicketControllerDIP {
+private:
+    BookTicketServiceDIP* service;
+
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        AllocScope scope(Subsystem::Controller);
+        string userId = reqBody.at("userId");
+        string movieId = reqBody.at("movieId");
+        string seats = reqBody.at("seats");
+        string bookingId = service->execute(userId, movieId, seats);
+        return {{"success", "true"}, {"bookingId", bookingId}};
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks + report
+//////////////////////////////////////////
+
+#if ALLOC_TRACKING_ENABLED
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    AllocSnapshot before = snapshotAllocations();
+    int* p;
+    {
+        AllocScope scope(Subsystem::Order);
+        p = new int[10];
+        {
+            AllocScope inner(Subsystem::Payment);
+            delete new int(1);
+        }
+        delete new int(2);
+    }
+    AllocSnapshot d = snapshotAllocations() - before;
+    check(d[Subsystem::Order].allocs == 2 && d[Subsystem::Order].bytes == 44 && d[Subsystem::Payment].allocs == 1,
+          "allocations are charged to the innermost scope and scopes restore on exit");
+    check(d[Subsystem::Order].liveBytes() == 40, "live bytes track the block that is still allocated");
+
+    before = snapshotAllocations();
+    thread([p] { AllocScope scope(Subsystem::Notification); delete[] p; }).join();
+    d = snapshotAllocations() - before;
+    check(d[Subsystem::Order].frees == 1 && d[Subsystem::Order].freedBytes == 40 && d[Subsystem::Notification].frees == 0,
+          "a free is charged to the allocating subsystem, whatever thread or scope frees it");
+
+    before = snapshotAllocations();
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([] {
+            AllocScope scope(Subsystem::Repository);
+            for (int i = 0; i < 1000; i++) delete new char[100];
+        });
+    }
+    for (auto& w : workers) w.join();
+    d = snapshotAllocations() - before;
+    check(d[Subsystem::Repository].allocs == 4000 && d[Subsystem::Repository].frees == 4000,
+          "counts from threads that have exited are kept");
+
+    stackSampler().clear();
+    stackSampler().enable(1);
+    {
+        AllocScope scope(Subsystem::Discount);
+        for (int i = 0; i < 10; i++) delete new string(100, 'x');
+    }
+    stackSampler().disable();
+    auto samples = stackSampler().samples();
+    check(samples.size() >= 10 && samples.back().tag == Subsystem::Discount && samples.back().depth > 2,
+          "stack sampling records tagged backtraces");
+
+    // Readers may copy the ring while sampling threads are still writing into it.
+    stackSampler().clear();
+    stackSampler().enable(1);
+    AllocScope scope(Subsystem::Payment);     // this thread's spawns and copies are sampled too
+    atomic<bool> stop{false};
+    vector<thread> samplers;
+    for (int t = 0; t < 2; t++) {
+        samplers.emplace_back([&] {
+            AllocScope scope(Subsystem::Payment);
+            while (!stop) delete new string(100, 'x');
+        });
+    }
+    long torn = 0, copies = 0;
+    for (; copies < 200; copies++) {
+        for (auto& sample : stackSampler().samples()) torn += sample.tag != Subsystem::Payment || sample.depth <= 0 || sample.depth > 16;
+    }
+    stop = true;
+    for (auto& s : samplers) s.join();
+    stackSampler().disable();
+    check(torn == 0, "samples() copies a consistent ring while other threads are sampling");
+    stackSampler().clear();
+
+    volatile size_t huge = SIZE_MAX - 8;
+    bool threw = false;
+    try { delete[] new char[huge]; } catch (const bad_alloc&) { threw = true; }
+    check(threw && new (nothrow) char[huge] == nullptr, "a size that would wrap the block header is refused");
+}
+#endif
+
+// "./bin(_ZN3Foo3barEv+0x1c) [0x...]" -> "Foo::bar()"
+string frameName(const char* symbol) {
+    string text = symbol;
+    size_t open = text.find('('), plus = text.find('+', open);
+    if (open == string::npos || plus == string::npos || plus == open + 1) return text;
+    string mangled = text.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    string name = status == 0 ? demangled : mangled;
+    free(demangled);
+    return name.size() > 90 ? name.substr(0, 87) + "..." : name;
+}
+
+void printReport(const AllocSnapshot& d, long bookings) {
+    cout << left << setw(14) << "subsystem" << right << setw(16) << "allocs/booking" << setw(16) << "bytes/booking"
+         << setw(14) << "live bytes" << "\n";
+    for (int i = 0; i < SubsystemCount; i++) {
+        auto& c = d.by[i];
+        if (!c.allocs) continue;
+        cout << left << setw(14) << subsystemName((Subsystem)i) << right << fixed << setprecision(2) << setw(16)
+             << (double)c.allocs / bookings << setw(16) << (double)c.bytes / bookings << setw(14) << (int64_t)c.liveBytes() << "\n";
+    }
+    auto t = d.total();
+    cout << left << setw(14) << "total" << right << setw(16) << (double)t.allocs / bookings << setw(16)
+         << (double)t.bytes / bookings << setw(14) << (int64_t)t.liveBytes() << "\n";
+}
+
+
+int main() {
+#if ALLOC_TRACKING_ENABLED
+    checks();
+#else
+    cout << "allocation tracking is compiled out (NDEBUG); rebuild with -DALLOC_TRACKING to enable\n";
+#endif
+
+    TicketRepositoryDIP repo;
+    BookTicketServiceDIP service(&repo);
+    BookTicketControllerDIP controller(&service);
+
+    const long bookings = 200000;
+    AllocSampler sampler(chrono::milliseconds(20));
+    stackSampler().enable(997);
+    AllocSnapshot before = snapshotAllocations();
+    auto start = chrono::steady_clock::now();
+    for (long i = 0; i < bookings; i++) {
+        map<string, string> request{{"userId", "user" + to_string(i % 5000)}, {"movieId", "movie" + to_string(i % 40)}, {"seats", "A1,A2,A3"}};
+        auto response = controller.handleRequest(request);
+        if (response["success"] != "true") throw runtime_error("booking failed");
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    AllocSnapshot d = snapshotAllocations() - before;
+    stackSampler().disable();
+    sampler.stop();
+
+    cout << "\n--- " << bookings << " bookings through BookTicketControllerDIP in " << fixed << setprecision(2)
+         << seconds << "s (" << seconds * 1e9 / bookings << " ns/booking) ---\n";
+    if (ALLOC_TRACKING_ENABLED) printReport(d, bookings);
+
+    auto series = sampler.snapshots();
+    if (ALLOC_TRACKING_ENABLED && series.size() > 2) {
+        cout << "\nallocation rate from periodic snapshots :\n";
+        size_t step = max<size_t>(1, series.size() / 5);
+        for (size_t i = step; i < series.size(); i += step) {
+            auto delta = series[i].second - series[i - step].second;
+            double dt = series[i].first - series[i - step].first;
+            cout << "  t=" << setprecision(2) << series[i].first << "s  " << setprecision(0) << delta.total().allocs / dt << " allocs/s, "
+                 << delta.total().bytes / dt / 1e6 << " MB/s\n";
+        }
+    }
+
+    auto samples = stackSampler().samples();
+    if (!samples.empty()) {
+        map<vector<void*>, pair<int, Subsystem>> byStack;
+        for (auto& s : samples) {
+            auto& e = byStack[vector<void*>(s.frames + 1, s.frames + min(s.depth, 6))];
+            e.first++;
+            e.second = s.tag;
+        }
+        vector<pair<int, vector<void*>>> top;
+        for (auto& [stack, e] : byStack) top.push_back({e.first, stack});
+        sort(top.rbegin(), top.rend());
+        cout << "\ntop sampled allocation stacks (" << samples.size() << " samples, 1 in 997; link with -rdynamic for names) :\n";
+        for (size_t i = 0; i < min<size_t>(3, top.size()); i++) {
+            cout << "  " << top[i].first << " samples [" << subsystemName(byStack[top[i].second].second) << "]\n";
+            char** names = backtrace_symbols(top[i].second.data(), top[i].second.size());
+            for (size_t f = 0; f < top[i].second.size(); f++) cout << "      " << (names ? frameName(names[f]) : "?") << "\n";
+            free(names);
+        }
+    }
+    return 0;
+}
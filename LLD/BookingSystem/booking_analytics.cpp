@@ -0,0 +1,502 @@
+/*
+
+Columnar Analytics over the Booking Log
+
+Problem :
+    "Revenue per movie per hour" and "fill rate per venue" are answered by replaying
+    the text logs LogFileWriter (SOLID/ISP) writes : parse every line, look strings up
+    in hash maps, one row at a time. That is a few million rows per second at best.
+
+Solution : convert the log once into COLUMNS, then scan the columns.
+
+    row log :    ts,type,movie,venue,user,seats,price,discount
+                 ts,type,movie,venue,user,seats,price,discount
+                 ...
+    columns :    hour     [ 471 471 471 472 ... ]   uint32
+                 movie    [   3   9   3   1 ... ]   uint32  <- dictionary code, not "m101"
+                 venue    [   0   4   0   2 ... ]   uint16
+                 user     [ ... ]                   uint32  <- dictionary code
+                 seats / type / price / discount
+
+> Dictionary encoding : every distinct movie / venue / user string gets a small integer.
+  Group-by on an integer is an array index, not a string hash.
+> Chunks of 64K rows : a query only touches the columns it needs.
+> Vectorized kernels : per block of 1024 rows, compute keys and values with simple
+  loops over arrays (the compiler turns these into SIMD), then add them into a dense
+  per-thread result array.
+> Parallel : threads grab chunks from a shared counter, each fills its OWN partial
+  result (no locks, no sharing), and the partials are summed at the end, each thread
+  summing its own slice of the groups.
+> Hour windows : (movie, hour) groups are aggregated a window of hours at a time, so a
+  partial stays a few MB however long the log is. Each chunk knows its hour range and
+  a log is written in time order, so a chunk is read by one or two windows only.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Dictionary + columnar table
+//////////////////////////////////////////
+
+class Dictionary {
+private:
+    unordered_map<string, uint32_t> codes;
+    vector<string> values;
+
+public:
+    uint32_t encode(string_view s) {
+        auto it = codes.find(string(s));
+        if (it != codes.end()) return it->second;
+        codes.emplace(string(s), values.size());
+        values.emplace_back(s);
+        return values.size() - 1;
+    }
+
+    bool contains(string_view s) const { return codes.count(string(s)) != 0; }
+    const string& decode(uint32_t code) const { return values.at(code); }
+    size_t size() const { return values.size(); }
+};
+
+enum EventType : uint8_t { Booked = 0, Cancelled = 1 };
+
+struct Chunk {
+    static constexpr size_t kRows = 1 << 16;
+
+    vector<uint32_t> hour, movie, user;
+    vector<uint16_t> venue;
+    vector<uint8_t> type, seats;
+    vector<int32_t> price, discount;        // cents
+    uint32_t minHour = UINT32_MAX, maxHour = 0;
+
+    size_t rows() const { return hour.size(); }
+
+    void reserve(size_t n) {
+        hour.reserve(n); movie.reserve(n); user.reserve(n); venue.reserve(n);
+        type.reserve(n); seats.reserve(n); price.reserve(n); discount.reserve(n);
+    }
+};
+
+struct BookingTable {
+    Dictionary movies, venues, users;
+    vector<Chunk> chunks;
+    uint32_t minHour = UINT32_MAX, maxHour = 0;
+
+    size_t rows() const {
+        size_t n = 0;
+        for (auto& c : chunks) n += c.rows();
+        return n;
+    }
+
+    size_t bytes() const {
+        return rows() * (4 + 4 + 4 + 2 + 1 + 1 + 4 + 4);
+    }
+
+    void append(uint32_t hour, uint8_t type, uint32_t movie, uint16_t venue, uint32_t user, uint8_t seats,
+                int32_t price, int32_t discount) {
+        if (chunks.empty() || chunks.back().rows() == Chunk::kRows) {
+            chunks.emplace_back();
+            chunks.back().reserve(Chunk::kRows);
+        }
+        Chunk& c = chunks.back();
+        c.hour.push_back(hour); c.type.push_back(type); c.movie.push_back(movie); c.venue.push_back(venue);
+        c.user.push_back(user); c.seats.push_back(seats); c.price.push_back(price); c.discount.push_back(discount);
+        c.minHour = min(c.minHour, hour);
+        c.maxHour = max(c.maxHour, hour);
+        minHour = min(minHour, hour);
+        maxHour = max(maxHour, hour);
+    }
+};
+
+// Text event : unixSeconds,BOOK|CANCEL,movieId,venueId,userId,seats,priceCents,discountCents
+class LogConverter {
+private:
+    // Whole field must be a number that fits T; anything else rejects the line.
+    template<class T>
+    static T num(string_view s, string_view line) {
+        long long v = 0;
+        auto [end, ec] = from_chars(s.data(), s.data() + s.size(), v);
+        if (ec != errc() || end != s.data() + s.size() || s.empty() ||
+            v < (long long)numeric_limits<T>::min() || v > (long long)numeric_limits<T>::max()) {
+            throw invalid_argument("bad number '" + string(s) + "' in log line : " + string(line));
+        }
+        return (T)v;
+    }
+
+    static EventType eventType(string_view s, string_view line) {
+        if (s == "BOOK") return Booked;
+        if (s == "CANCEL") return Cancelled;
+        throw invalid_argument("unknown event type '" + string(s) + "' in log line : " + string(line));
+    }
+
+public:
+    static void appendLine(BookingTable& t, string_view line) {
+        string_view f[8];
+        size_t start = 0;
+        for (int i = 0; i < 8; i++) {
+            size_t comma = line.find(',', start);
+            if (comma == string_view::npos && i < 7) throw invalid_argument("bad log line : " + string(line));
+            f[i] = line.substr(start, comma - start);
+            start = comma + 1;
+        }
+        // Validate every field before encoding, so a rejected line leaves the dictionaries untouched.
+        uint32_t hour = num<uint32_t>(f[0], line) / 3600;
+        EventType type = eventType(f[1], line);
+        uint8_t seats = num<uint8_t>(f[5], line);
+        int32_t price = num<int32_t>(f[6], line), discount = num<int32_t>(f[7], line);
+        if (t.venues.size() > UINT16_MAX && !t.venues.contains(f[3])) throw invalid_argument("too many venues");
+        t.append(hour, type, t.movies.encode(f[2]), t.venues.encode(f[3]), t.users.encode(f[4]), seats, price, discount);
+    }
+
+    static BookingTable fromFile(const string& path) {
+        BookingTable t;
+        ifstream in(path);
+        if (!in) throw runtime_error("cannot open " + path);
+        for (string line; getline(in, line);) {
+            if (!line.empty()) appendLine(t, line);
+        }
+        return t;
+    }
+};
+
+
+//////////////////////////////////////////
+// Queries
+//////////////////////////////////////////
+
+// Dense group-by result : sums and counts indexed by group id.
+struct GroupSums {
+    vector<int64_t> sum;
+    vector<int64_t> count;
+
+    explicit GroupSums(size_t groups = 0) : sum(groups, 0), count(groups, 0) {}
+
+    void add(const GroupSums& o, size_t from, size_t to) {
+        for (size_t g = from; g < to; g++) { sum[g] += o.sum[g]; count[g] += o.count[g]; }
+    }
+};
+
+// Runs kernel(chunk, partial) over the given chunks on up to `threads` threads; returns the
+// summed partials. The merge is parallel too : each thread adds up one slice of the groups.
+template<class Kernel>
+GroupSums parallelAggregate(const vector<const Chunk*>& chunks, int threads, size_t groups, Kernel kernel) {
+    threads = max<int>(1, min<size_t>(threads, chunks.size()));
+    vector<GroupSums> partials(threads, GroupSums(groups));
+    atomic<size_t> next{0};
+    vector<thread> workers;
+    for (int w = 0; w < threads; w++) {
+        workers.emplace_back([&, w] {
+            for (size_t c; (c = next.fetch_add(1)) < chunks.size();) kernel(*chunks[c], partials[w]);
+        });
+    }
+    for (auto& w : workers) w.join();
+    workers.clear();
+
+    GroupSums& total = partials[0];
+    for (int w = 0; w < threads && threads > 1; w++) {
+        workers.emplace_back([&, w] {
+            size_t from = groups * w / threads, to = groups * (w + 1) / threads;
+            for (int p = 1; p < threads; p++) total.add(partials[p], from, to);
+        });
+    }
+    for (auto& w : workers) w.join();
+    return move(total);
+}
+
+struct MovieHourRevenue { string movie; uint32_t hour; int64_t revenueCents; int64_t bookings; };
+struct VenueFill { string venue; int64_t seatsSold; double fillRate; };
+
+class BookingAnalytics {
+private:
+    const BookingTable& t;
+    int threads;
+
+    static constexpr size_t kBlock = 1024;
+    static constexpr size_t kWindowGroups = 1 << 20;       // (movie, hour) groups per pass : 16 MB per partial
+    static constexpr size_t kMaxMovies = 1 << 24;
+
+    vector<const Chunk*> chunksBetween(uint64_t fromHour, uint64_t toHour) const {
+        vector<const Chunk*> out;
+        for (auto& c : t.chunks) {
+            if (c.rows() > 0 && c.minHour <= toHour && c.maxHour >= fromHour) out.push_back(&c);
+        }
+        return out;
+    }
+
+public:
+    BookingAnalytics(const BookingTable& t, int threads) : t(t), threads(max(1, threads)) {}
+
+    // net revenue (price - discount, negative for cancellations) grouped by (movie, hour)
+    vector<MovieHourRevenue> revenuePerMoviePerHour() {
+        if (t.chunks.empty()) return {};
+        const uint32_t movieCount = t.movies.size();
+        if (movieCount > kMaxMovies) throw runtime_error("too many movies for a dense aggregate");
+        const uint64_t windowHours = max<size_t>(1, kWindowGroups / movieCount);
+
+        vector<MovieHourRevenue> result;
+        for (uint64_t from = t.minHour; from <= t.maxHour; from += windowHours) {
+            const uint64_t to = min<uint64_t>(t.maxHour, from + windowHours - 1);
+            const uint32_t base = from, hours = to - from + 1;
+            const size_t groups = (size_t)movieCount * hours, outside = groups;   // rows of other windows land in `outside`
+            auto chunks = chunksBetween(from, to);
+            if (chunks.empty()) continue;
+
+            GroupSums total = parallelAggregate(chunks, threads, groups + 1, [&](const Chunk& c, GroupSums& out) {
+                uint32_t key[kBlock];
+                int64_t net[kBlock];
+                for (size_t start = 0; start < c.rows(); start += kBlock) {
+                    size_t n = min(kBlock, c.rows() - start);
+                    const uint32_t* movie = c.movie.data() + start;
+                    const uint32_t* hour = c.hour.data() + start;
+                    const uint8_t* type = c.type.data() + start;
+                    const int32_t* price = c.price.data() + start;
+                    const int32_t* discount = c.discount.data() + start;
+                    for (size_t i = 0; i < n; i++) {
+                        uint32_t h = hour[i] - base;            // wraps for hours before the window
+                        key[i] = h < hours ? h * movieCount + movie[i] : outside;   // hour-major : a block's groups are adjacent
+                    }
+                    for (size_t i = 0; i < n; i++) net[i] = ((int64_t)price[i] - discount[i]) * (1 - 2 * type[i]);
+                    for (size_t i = 0; i < n; i++) {
+                        out.sum[key[i]] += net[i];
+                        out.count[key[i]] += 1 - 2 * type[i];
+                    }
+                }
+            });
+
+            for (size_t g = 0; g < groups; g++) {
+                if (total.count[g] == 0 && total.sum[g] == 0) continue;
+                result.push_back({t.movies.decode(g % movieCount), base + (uint32_t)(g / movieCount), total.sum[g], total.count[g]});
+            }
+        }
+        return result;
+    }
+
+    // seats sold (bookings minus cancellations) per venue over capacity * shows
+    vector<VenueFill> fillRatePerVenue(const unordered_map<string, int64_t>& seatCapacity) {
+        size_t groups = t.venues.size();
+        GroupSums total = parallelAggregate(chunksBetween(0, UINT32_MAX), threads, groups, [&](const Chunk& c, GroupSums& out) {
+            int32_t delta[kBlock];
+            for (size_t start = 0; start < c.rows(); start += kBlock) {
+                size_t n = min(kBlock, c.rows() - start);
+                const uint16_t* venue = c.venue.data() + start;
+                const uint8_t* seats = c.seats.data() + start;
+                const uint8_t* type = c.type.data() + start;
+                for (size_t i = 0; i < n; i++) delta[i] = seats[i] * (1 - 2 * type[i]);
+                for (size_t i = 0; i < n; i++) out.sum[venue[i]] += delta[i];
+            }
+        });
+
+        vector<VenueFill> result;
+        for (size_t v = 0; v < groups; v++) {
+            const string& name = t.venues.decode(v);
+            auto cap = seatCapacity.find(name);
+            double rate = cap == seatCapacity.end() || cap->second == 0 ? 0 : (double)total.sum[v] / cap->second;
+            result.push_back({name, total.sum[v], rate});
+        }
+        return result;
+    }
+};
+
+
+//////////////////////////////////////////
+// Row-at-a-time baseline (what replaying text logs does)
+//////////////////////////////////////////
+
+unordered_map<string, pair<int64_t, int64_t>> replayTextRevenue(const string& path) {
+    unordered_map<string, pair<int64_t, int64_t>> groups;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        vector<string> f;
+        stringstream ss(line);
+        for (string part; getline(ss, part, ',');) f.push_back(part);
+        int sign = f[1] == "CANCEL" ? -1 : 1;
+        auto& g = groups[f[2] + "|" + to_string(stol(f[0]) / 3600)];
+        g.first += sign * (stol(f[6]) - stol(f[7]));
+        g.second += sign;
+    }
+    return groups;
+}
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+// Skewed movie popularity, 30 days of traffic in time order (as a log is), ~5% cancellations.
+struct Synthetic {
+    mt19937_64 rng;
+    int movies, venues, users;
+    Synthetic(uint64_t seed, int movies, int venues, int users) : rng(seed), movies(movies), venues(venues), users(users) {}
+
+    template<class Emit>
+    void generate(long rows, Emit emit) {
+        const int64_t start = 1700000000;
+        for (long i = 0; i < rows; i++) {
+            uint64_t r = rng();
+            int movie = (int)((r & 0xffff) * (r & 0xffff) % ((uint64_t)movies * movies) / movies);   // skewed to low ids
+            emit(start + (int64_t)(i * (30.0 * 86400) / rows) + (int64_t)((r >> 16) % 60), (r >> 40) % 20 == 0 ? Cancelled : Booked, movie,
+                 (int)((r >> 45) % venues), (int)(rng() % users), (int)(1 + (r >> 50) % 4),
+                 (int32_t)(15000 + (r >> 20) % 30000), (int32_t)((r >> 54) % 4 == 0 ? 2000 : 0));
+        }
+    }
+};
+
+void checks(const string& dir) {
+    string path = dir + "/bookings.log";
+    {
+        ofstream out(path);
+        Synthetic gen(1, 40, 12, 500);
+        gen.generate(200000, [&](int64_t ts, EventType type, int m, int v, int u, int seats, int32_t price, int32_t discount) {
+            out << ts << "," << (type == Cancelled ? "CANCEL" : "BOOK") << ",m" << m << ",v" << v << ",u" << u << ","
+                << seats << "," << price << "," << discount << "\n";
+        });
+    }
+    BookingTable t = LogConverter::fromFile(path);
+    check(t.rows() == 200000 && t.chunks.size() == 4 && t.movies.size() == 40, "text log converts into 64K-row columnar chunks");
+
+    auto expected = replayTextRevenue(path);
+    bool same = true;
+    for (int threads : {1, 3}) {
+        auto result = BookingAnalytics(t, threads).revenuePerMoviePerHour();
+        size_t found = 0;
+        for (auto& r : result) {
+            auto it = expected.find(r.movie + "|" + to_string(r.hour));
+            same &= it != expected.end() && it->second.first == r.revenueCents && it->second.second == r.bookings;
+            found++;
+        }
+        same &= found == expected.size();
+    }
+    check(same, "revenue per movie per hour matches the row-by-row replay (1 and 3 threads)");
+
+    unordered_map<string, int64_t> capacity;
+    for (int v = 0; v < 12; v++) capacity["v" + to_string(v)] = 100000;
+    auto fill = BookingAnalytics(t, 2).fillRatePerVenue(capacity);
+    int64_t seats = 0, expectSeats = 0;
+    for (auto& f : fill) seats += f.seatsSold;
+    for (auto& c : t.chunks) {
+        for (size_t i = 0; i < c.rows(); i++) expectSeats += c.type[i] == Cancelled ? -c.seats[i] : c.seats[i];
+    }
+    check(seats == expectSeats && fill.size() == 12 && fill[0].fillRate > 0, "fill rate per venue adds up to all seats sold");
+
+    auto rejects = [&](const string& line) {
+        size_t rows = t.rows(), movies = t.movies.size();
+        try { LogConverter::appendLine(t, line); } catch (const invalid_argument&) { return t.rows() == rows && t.movies.size() == movies; }
+        return false;
+    };
+    check(rejects("1700000000,REFUND,m999,v0,u0,2,15000,0"), "an unknown event type is rejected, not counted as a booking");
+    check(rejects("1700000000,BOOK,m999,v0,u0,2,15k,0") && rejects("1700000000,BOOK,m999,v0,u0,,15000,0") &&
+          rejects("1700000000,BOOK,m999,v0,u0,300,15000,0") && rejects("1700000000,BOOK,m999,v0,u0,2,3000000000,0") &&
+          rejects("-1,BOOK,m999,v0,u0,2,15000,0"),
+          "malformed or out-of-range numbers are rejected instead of truncated");
+
+    // 2000 movies over ~14 months : 20M (movie, hour) groups, more than one dense partial holds
+    string longPath = dir + "/long.log";
+    {
+        ofstream out(longPath);
+        for (int i = 0; i < 20000; i++) {
+            out << 1700000000 + (int64_t)i * 2160 << "," << (i % 7 == 0 ? "CANCEL" : "BOOK") << ",m" << i % 2000 << ",v" << i % 5
+                << ",u" << i << ",2,15000," << (i % 3 == 0 ? 2000 : 0) << "\n";
+        }
+    }
+    BookingTable longTable = LogConverter::fromFile(longPath);
+    auto longExpected = replayTextRevenue(longPath);
+    bool sameLong = true;
+    for (int threads : {1, 3}) {
+        auto result = BookingAnalytics(longTable, threads).revenuePerMoviePerHour();
+        sameLong &= result.size() == longExpected.size();
+        for (auto& r : result) {
+            auto it = longExpected.find(r.movie + "|" + to_string(r.hour));
+            sameLong &= it != longExpected.end() && it->second.first == r.revenueCents && it->second.second == r.bookings;
+        }
+    }
+    check((size_t)longTable.movies.size() * (longTable.maxHour - longTable.minHour + 1) > (1 << 24) && sameLong,
+          "a log spanning more hours than one dense aggregate holds is summed window by window");
+
+    BookingTable venues;
+    for (int v = 0; v <= UINT16_MAX; v++) LogConverter::appendLine(venues, "1700000000,BOOK,m1,v" + to_string(v) + ",u1,1,100,0");
+    bool tooMany = false;
+    try { LogConverter::appendLine(venues, "1700000000,BOOK,m1,vNew,u1,1,100,0"); } catch (const invalid_argument&) { tooMany = true; }
+    LogConverter::appendLine(venues, "1700000000,BOOK,m1,v7,u1,1,100,0");
+    check(tooMany && venues.venues.size() == UINT16_MAX + 1 && !venues.venues.contains("vNew") && venues.rows() == UINT16_MAX + 2,
+          "a venue past the uint16 limit is rejected without being added to the dictionary");
+}
+
+void benchmark(const string& dir, long rows, int maxThreads) {
+    // text replay baseline on a slice
+    const long textRows = 1000000;
+    string path = dir + "/bench.log";
+    {
+        ofstream out(path);
+        Synthetic gen(7, 2000, 400, 1000000);
+        gen.generate(textRows, [&](int64_t ts, EventType type, int m, int v, int u, int seats, int32_t price, int32_t discount) {
+            out << ts << "," << (type == Cancelled ? "CANCEL" : "BOOK") << ",m" << m << ",v" << v << ",u" << u << ","
+                << seats << "," << price << "," << discount << "\n";
+        });
+    }
+    auto t0 = Clock::now();
+    auto replay = replayTextRevenue(path);
+    double replaySec = chrono::duration<double>(Clock::now() - t0).count();
+    t0 = Clock::now();
+    BookingTable converted = LogConverter::fromFile(path);
+    double convertSec = chrono::duration<double>(Clock::now() - t0).count();
+    cout << "text replay (row at a time) : " << (long)(textRows / replaySec) << " rows/sec;  one-off conversion to columns : "
+         << (long)(textRows / convertSec) << " rows/sec\n";
+
+    // Synthetic ids go through the same dictionaries as the text log ("m17" -> code), so every
+    // stored code decodes to the right name and stays within the dictionary's size.
+    BookingTable t;
+    t.movies = converted.movies;
+    t.venues = converted.venues;
+    t.users = converted.users;
+    t0 = Clock::now();
+    const int movieIds = 2000, venueIds = 400, userIds = 1000000;
+    vector<uint32_t> movieCode(movieIds), userCode(userIds);
+    vector<uint16_t> venueCode(venueIds);
+    for (int m = 0; m < movieIds; m++) movieCode[m] = t.movies.encode("m" + to_string(m));
+    for (int v = 0; v < venueIds; v++) venueCode[v] = t.venues.encode("v" + to_string(v));
+    for (int u = 0; u < userIds; u++) userCode[u] = t.users.encode("u" + to_string(u));
+    Synthetic gen(7, movieIds, venueIds, userIds);
+    gen.generate(rows, [&](int64_t ts, EventType type, int m, int v, int u, int seats, int32_t price, int32_t discount) {
+        t.append(ts / 3600, type, movieCode[m], venueCode[v], userCode[u], seats, price, discount);
+    });
+    cout << rows << " synthetic bookings in columns (" << t.bytes() / (1 << 20) << " MB), built in " << fixed
+         << setprecision(1) << chrono::duration<double>(Clock::now() - t0).count() << "s\n";
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        BookingAnalytics q(t, threads);
+        t0 = Clock::now();
+        auto revenue = q.revenuePerMoviePerHour();
+        double a = chrono::duration<double>(Clock::now() - t0).count();
+        t0 = Clock::now();
+        auto fill = q.fillRatePerVenue({});
+        double b = chrono::duration<double>(Clock::now() - t0).count();
+        cout << setw(2) << threads << " thread(s) : revenue per movie per hour " << setprecision(0) << rows / a / 1e6
+             << "M rows/sec (" << revenue.size() << " groups), fill per venue " << rows / b / 1e6 << "M rows/sec\n";
+    }
+}
+
+
+int main(int argc, char** argv) {
+    string dir = "/tmp/booking_analytics_demo";
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+
+    checks(dir);
+
+    long rows = argc > 1 ? stol(argv[1]) : 30000000;
+    cout << "\n--- scan rate ---\n";
+    benchmark(dir, rows, max(2u, thread::hardware_concurrency()));
+
+    filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,376 @@
+/*
+
+Unique Booking Id Generator
+
+TicketRepository::bookTicket in DIP/example.cpp returns "booking-id-123" every time.
+A real booking id must be :
+
+> unique       : two bookings never get the same id, even from different threads/machines
+> sortable     : newer bookings have bigger ids (good for DB indexes and pagination)
+> cheap        : generated thousands of times per second without a global lock
+
+Snowflake-style 64-bit id :
+
+    | 0 | 41 bits : ms since 2024-01-01 | 8 bits : node | 4 bits : slot | 10 bits : sequence |
+
+> timestamp : ~69 years of milliseconds
+> node      : which booking server (256 servers)
+> slot      : which thread on that server. Each thread claims its own slot, so it owns
+              its sequence counter and never has to share it -> no lock, no atomics
+              on the hot path.
+> sequence  : 1024 ids per millisecond per slot
+
+More than 16 threads : the extra threads share slot 15 through one atomic CAS word.
+
+Clock going backwards (NTP correction) :
+    we never reuse a timestamp. If the clock moves back we keep issuing from the last
+    timestamp we used; if its sequence runs out we borrow the next millisecond.
+    Only if we get too far ahead of the real clock do we wait for it to catch up.
+
+Throughput cap : 1024 ids per ms per slot = ~1.02M ids/sec per thread, sustained.
+    A burst can go faster by borrowing up to maxDriftMs (default 1000 ms) of future
+    timestamps, i.e. ~1M extra ids per slot; after that the slot runs at the cap.
+
+Text form :
+    Crockford base32, always 13 characters. Fixed width + alphabet in ASCII order
+    means the strings sort in the same order as the numbers.
+    Base62 (11 characters) is shorter but still sortable with the 0-9A-Za-z alphabet.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Id layout
+//////////////////////////////////////////
+
+struct IdLayout {
+    static constexpr int kSequenceBits = 10;
+    static constexpr int kSlotBits = 4;
+    static constexpr int kNodeBits = 8;
+    static constexpr int kTimeBits = 41;
+
+    static constexpr uint64_t kMaxSequence = (1u << kSequenceBits) - 1;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int kSharedSlot = kSlots - 1;
+    static constexpr int64_t kEpochMs = 1704067200000;      // 2024-01-01T00:00:00Z
+
+    static uint64_t compose(int64_t ms, uint32_t node, uint32_t slot, uint64_t sequence) {
+        return (uint64_t)ms << (kNodeBits + kSlotBits + kSequenceBits)
+             | (uint64_t)node << (kSlotBits + kSequenceBits)
+             | (uint64_t)slot << kSequenceBits
+             | sequence;
+    }
+
+    static int64_t timestampMs(uint64_t id) { return (id >> (kNodeBits + kSlotBits + kSequenceBits)) + kEpochMs; }
+    static uint32_t node(uint64_t id) { return (id >> (kSlotBits + kSequenceBits)) & ((1u << kNodeBits) - 1); }
+    static uint32_t slot(uint64_t id) { return (id >> kSequenceBits) & (kSlots - 1); }
+};
+
+
+//////////////////////////////////////////
+// Generator
+//////////////////////////////////////////
+
+class BookingIdGenerator {
+private:
+    // State of one slot : last timestamp used + last sequence. Owned by one thread.
+    struct alignas(64) SlotState {
+        int64_t lastMs = -1;
+        uint64_t sequence = 0;
+    };
+
+    uint32_t nodeId;
+    int64_t maxDriftMs;
+    function<int64_t()> clockMs;            // replaceable for testing clock rollback
+
+    uint64_t instanceId;
+    // bit i set -> slot i owned by some thread. Shared with the leases so a thread that
+    // outlives the generator can still release its slot safely.
+    shared_ptr<atomic<uint32_t>> usedSlots = make_shared<atomic<uint32_t>>(0);
+    SlotState slots[IdLayout::kSlots];
+    alignas(64) atomic<uint64_t> shared{0}; // slot 15 : (ms << 10 | sequence), updated by CAS
+    atomic<long> rollbacks{0};
+
+    // thread_local handle that returns the slot when the thread exits
+    struct SlotLease {
+        shared_ptr<atomic<uint32_t>> usedSlots;
+        int slot = -1;
+        ~SlotLease() {
+            if (usedSlots && slot != IdLayout::kSharedSlot) usedSlots->fetch_and(~(1u << slot));
+        }
+    };
+
+    int acquireSlot() {
+        uint32_t used = usedSlots->load();
+        while (true) {
+            uint32_t freeMask = ~used & ((1u << IdLayout::kSharedSlot) - 1);
+            if (freeMask == 0) return IdLayout::kSharedSlot;
+            int slot = countr_zero(freeMask);
+            if (usedSlots->compare_exchange_weak(used, used | (1u << slot))) return slot;
+        }
+    }
+
+    int64_t nowMs() const { return clockMs() - IdLayout::kEpochMs; }
+
+    // Given the last (ms, sequence) of a slot, the next pair to use.
+    pair<int64_t, uint64_t> advance(int64_t lastMs, uint64_t lastSequence) {
+        int64_t now = nowMs();
+        if (now > lastMs) return {now, 0};
+        if (now < lastMs) rollbacks++;
+
+        if (lastSequence < IdLayout::kMaxSequence) return {lastMs, lastSequence + 1};
+        // sequence exhausted for this ms : borrow the next one, but do not run away from the clock
+        while (lastMs + 1 - nowMs() > maxDriftMs) this_thread::sleep_for(chrono::microseconds(100));
+        return {lastMs + 1, 0};
+    }
+
+    uint64_t nextShared() {
+        uint64_t current = shared.load(memory_order_relaxed);
+        while (true) {
+            int64_t lastMs = current == 0 ? -1 : (int64_t)(current >> IdLayout::kSequenceBits);
+            auto [ms, seq] = advance(lastMs, current & IdLayout::kMaxSequence);
+            uint64_t packed = (uint64_t)ms << IdLayout::kSequenceBits | seq;
+            if (shared.compare_exchange_weak(current, packed, memory_order_acq_rel)) {
+                return IdLayout::compose(ms, nodeId, IdLayout::kSharedSlot, seq);
+            }
+        }
+    }
+
+public:
+    BookingIdGenerator(uint32_t nodeId, function<int64_t()> clockMs = nullptr, int64_t maxDriftMs = 1000)
+        : nodeId(nodeId), maxDriftMs(maxDriftMs), clockMs(move(clockMs)) {
+        static atomic<uint64_t> instances{0};
+        instanceId = ++instances;
+        if (nodeId >= (1u << IdLayout::kNodeBits)) throw invalid_argument("node id out of range");
+        if (!this->clockMs) {
+            this->clockMs = [] {
+                return chrono::duration_cast<chrono::milliseconds>(
+                    chrono::system_clock::now().time_since_epoch()).count();
+            };
+        }
+    }
+
+    uint64_t next() {
+        // keyed by instance id, not address : a new generator may reuse an old address.
+        // The last lease used is cached, so the map is only searched when a thread
+        // switches generators. Map nodes never move, so the pointer stays valid.
+        thread_local unordered_map<uint64_t, SlotLease> leases;
+        thread_local uint64_t cachedInstance = 0;
+        thread_local SlotLease* cachedLease = nullptr;
+        if (cachedInstance != instanceId) {
+            cachedLease = &leases[instanceId];
+            cachedInstance = instanceId;
+        }
+        SlotLease& lease = *cachedLease;
+        if (!lease.usedSlots) {
+            lease.usedSlots = usedSlots;
+            lease.slot = acquireSlot();
+        }
+        if (lease.slot == IdLayout::kSharedSlot) return nextShared();
+
+        SlotState& state = slots[lease.slot];
+        auto [ms, seq] = advance(state.lastMs, state.sequence);
+        state.lastMs = ms;
+        state.sequence = seq;
+        return IdLayout::compose(ms, nodeId, lease.slot, seq);
+    }
+
+    long clockRollbacks() const { return rollbacks; }
+};
+
+
+//////////////////////////////////////////
+// Text encoders (write into caller's buffer, no allocation)
+//////////////////////////////////////////
+
+static constexpr char kBase32[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";    // Crockford
+static constexpr char kBase62[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+// Writes exactly 13 characters.
+inline void encodeBase32(uint64_t id, char* out) {
+    out[0] = kBase32[id >> 60];          // top 4 bits
+    for (int i = 12; i >= 1; i--) {
+        out[i] = kBase32[id & 31];
+        id >>= 5;
+    }
+}
+
+inline uint64_t decodeBase32(const char* in) {
+    static const auto table = [] {
+        array<int8_t, 128> t{};
+        t.fill(-1);
+        for (int i = 0; i < 32; i++) t[(unsigned char)kBase32[i]] = i;
+        return t;
+    }();
+    uint64_t id = 0;
+    for (int i = 0; i < 13; i++) {
+        int8_t v = table[(unsigned char)in[i] & 127];
+        if (v < 0) throw invalid_argument("bad base32 id");
+        id = id << 5 | v;
+    }
+    return id;
+}
+
+// Writes exactly 11 characters.
+inline void encodeBase62(uint64_t id, char* out) {
+    for (int i = 10; i >= 0; i--) {
+        out[i] = kBase62[id % 62];
+        id /= 62;
+    }
+}
+
+
+//////////////////////////////////////////
+// Repository using it (DIP/example.cpp)
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class TicketRepositoryDIP : public ITicketRepository {
+private:
+    BookingIdGenerator& ids;
+
+public:
+    TicketRepositoryDIP(BookingIdGenerator& ids) : ids(ids) {}
+
+    string bookTicket(const string& userId, const string& movieId) override {
+        char buf[13];
+        encodeBase32(ids.next(), buf);
+        cout << "[DIP] Saving booking in DB for user " << userId << " and movie " << movieId << "\n";
+        return string(buf, 13);
+    }
+};
+
+
+//////////////////////////////////////////
+// Stress test + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void uniquenessStressTest(int threads, int idsPerThread) {
+    BookingIdGenerator gen(7);
+    vector<vector<uint64_t>> perThread(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            perThread[t].reserve(idsPerThread);
+            for (int i = 0; i < idsPerThread; i++) perThread[t].push_back(gen.next());
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    bool increasing = true;
+    vector<uint64_t> all;
+    for (auto& ids : perThread) {
+        increasing &= is_sorted(ids.begin(), ids.end()) && adjacent_find(ids.begin(), ids.end()) == ids.end();
+        all.insert(all.end(), ids.begin(), ids.end());
+    }
+    sort(all.begin(), all.end());
+    check(adjacent_find(all.begin(), all.end()) == all.end(),
+          to_string(all.size()) + " ids from " + to_string(threads) + " threads are unique");
+    check(increasing, "ids from each thread are strictly increasing");
+}
+
+void clockRollbackTest() {
+    atomic<int64_t> fakeNow{IdLayout::kEpochMs + 1000000};
+    BookingIdGenerator gen(1, [&] { return fakeNow.load(); }, 60000);
+
+    uint64_t before = gen.next();
+    fakeNow -= 5000;                         // NTP moves the clock 5 seconds back
+    uint64_t after = gen.next();
+    for (int i = 0; i < 5000; i++) after = max(after, gen.next());   // exhaust a few sequences
+    check(after > before && gen.clockRollbacks() > 0, "ids keep increasing after the clock moves back");
+}
+
+void sortableTextTest() {
+    BookingIdGenerator gen(3);
+    char a[13], b[13];
+    uint64_t first = gen.next(), second = gen.next();
+    encodeBase32(first, a);
+    encodeBase32(second, b);
+    check(string(a, 13) < string(b, 13) && decodeBase32(a) == first, "base32 text sorts like the id and decodes back");
+    encodeBase62(first, a);
+    encodeBase62(second, b);
+    check(string(a, 11) < string(b, 11), "base62 text sorts like the id");
+}
+
+// Burst : the first 1M ids per thread, which fit in the 1000 ms drift allowance.
+// Steady : ids per second once the allowance is used up and the clock is the limit.
+void benchmark(int threads) {
+    const int burstIds = 1000000;
+    BookingIdGenerator gen(9);
+    struct alignas(64) Counter { atomic<long> ids{0}; };
+    vector<Counter> issued(threads);
+    atomic<bool> stop{false};
+    atomic<int> burstDone{0};
+    atomic<uint64_t> sink{0};
+    vector<thread> workers;
+    auto start = Clock::now();
+    Clock::time_point burstEnd;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            uint64_t x = 0;
+            char buf[13];
+            for (long i = 0; !stop.load(memory_order_relaxed); i++) {
+                encodeBase32(gen.next(), buf);
+                x += buf[12];
+                issued[t].ids.store(i + 1, memory_order_relaxed);
+                if (i + 1 == burstIds && ++burstDone == threads) burstEnd = Clock::now();
+            }
+            sink += x;
+        });
+    }
+    auto total = [&] {
+        long sum = 0;
+        for (auto& c : issued) sum += c.ids.load(memory_order_relaxed);
+        return sum;
+    };
+    this_thread::sleep_for(chrono::milliseconds(1500));        // past the drift allowance
+    while (burstDone < threads) this_thread::sleep_for(chrono::milliseconds(10));
+    long before = total();
+    auto t0 = Clock::now();
+    this_thread::sleep_for(chrono::seconds(1));
+    long after = total();
+    double steadySec = chrono::duration<double>(Clock::now() - t0).count();
+    stop = true;
+    for (auto& w : workers) w.join();
+
+    double burstSec = chrono::duration<double>(burstEnd - start).count();
+    cout << setw(2) << threads << " threads : burst " << (long)(threads * (double)burstIds / burstSec)
+         << " ids/sec, steady state " << (long)((after - before) / steadySec) << " ids/sec (cap "
+         << (long)(min(threads, IdLayout::kSlots) * 1024000.0) << ")\n";
+}
+
+
+int main() {
+    BookingIdGenerator ids(1);
+    TicketRepositoryDIP repo(ids);
+    for (string user : {"u2", "u3"}) {
+        string bookingId = repo.bookTicket(user, "m202");
+        cout << "{ success: true, bookingId: '" << bookingId << "' }\n";
+    }
+    cout << "\n";
+
+    uniquenessStressTest(8, 200000);
+    uniquenessStressTest(24, 20000);          // more threads than slots -> shared slot path
+    clockRollbackTest();
+    sortableTextTest();
+
+    cout << "\n--- ids/sec (id + base32 text) ---\n";
+    for (int threads : {1, 4, 8}) benchmark(threads);
+
+    return 0;
+}
@@ -0,0 +1,545 @@
+/*
+
+Bulk Refund Engine for Show Cancellations
+
+Problem :
+    Refundable::refund() (SOLID/ISP/examples.cpp) refunds one payment per call.
+    When a show is cancelled we must refund thousands of bookings. One gateway
+    round trip per booking, one after another, takes minutes, and if the job
+    crashes halfway nobody knows which bookings were already refunded.
+
+Solution :
+
+    repository --pages of bookings--> group by payment method --batches--> gateway lanes
+                                                                           (N workers each)
+                                                                               |
+                                                                  journal : bookingId -> done / failed
+
+> Streaming : bookings are read page by page; lanes have bounded queues, so a huge
+  show never sits in memory at once (back-pressure on the reader).
+> Batching : one gateway call refunds up to maxBatch() bookings.
+> Per-gateway concurrency limit : each payment method has its own lane with a fixed
+  number of workers, so a slow or strict gateway does not starve the others.
+> Resumable : finished bookings are appended to a journal (fdatasync per batch).
+  A restarted job skips everything in the journal.
+> Idempotency key = booking id. If we crash after the gateway refunded but before the
+  journal write, the retry is answered "already refunded", never a second payout.
+> Failed items are retried with backoff, then journaled as failed. Failed is not
+  "settled" : the next run of the job picks them up again, and failedIds() lists
+  them for manual follow-up until a later run refunds them.
+
+A new small interface BatchRefundable (ISP) is added next to Refundable. Gateways that
+only have the old single refund() are wrapped by OneByOneRefunds.
+
+*/
+
+#include<bits/stdc++.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+namespace fs = std::filesystem;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Interfaces
+//////////////////////////////////////////
+
+// Interface: Refundable (as in SOLID/ISP)
+class Refundable {
+public:
+    virtual void refund() = 0;
+    virtual ~Refundable() = default;
+};
+
+struct RefundRequest {
+    uint64_t bookingId;          // also the idempotency key
+    string chargeId;
+    int64_t amountCents;
+};
+
+enum class RefundOutcome : uint8_t { Refunded, AlreadyRefunded, Failed };
+
+// Interface: BatchRefundable
+class BatchRefundable {
+public:
+    virtual vector<RefundOutcome> refundBatch(const vector<RefundRequest>& batch) = 0;
+    virtual size_t maxBatch() const = 0;
+    virtual ~BatchRefundable() = default;
+};
+
+
+//////////////////////////////////////////
+// Fake gateways
+//////////////////////////////////////////
+
+// Local stand-in for a payment provider : fixed cost per call + per item, random failures,
+// dedupe on the idempotency key, and it remembers how many calls overlapped.
+class FakeGateway : public BatchRefundable {
+private:
+    chrono::microseconds perCall, perItem;
+    size_t batchLimit;
+    double failureRate;
+
+    mutex lock;
+    mt19937 rng{42};
+    unordered_map<uint64_t, int> payouts;    // bookingId -> times money was sent
+    atomic<int> inFlight{0};
+
+public:
+    atomic<int> maxInFlight{0};
+    atomic<long> calls{0};
+
+    FakeGateway(chrono::microseconds perCall, chrono::microseconds perItem, size_t batchLimit, double failureRate = 0)
+        : perCall(perCall), perItem(perItem), batchLimit(batchLimit), failureRate(failureRate) {}
+
+    vector<RefundOutcome> refundBatch(const vector<RefundRequest>& batch) override {
+        if (batch.size() > batchLimit) throw invalid_argument("batch too large");
+        int now = ++inFlight;
+        for (int seen = maxInFlight; now > seen && !maxInFlight.compare_exchange_weak(seen, now);) {}
+        calls++;
+        this_thread::sleep_for(perCall + perItem * batch.size());
+
+        vector<RefundOutcome> out;
+        {
+            lock_guard<mutex> guard(lock);
+            uniform_real_distribution<double> coin(0, 1);
+            for (auto& r : batch) {
+                if (payouts[r.bookingId] > 0) out.push_back(RefundOutcome::AlreadyRefunded);
+                else if (coin(rng) < failureRate) out.push_back(RefundOutcome::Failed);
+                else { payouts[r.bookingId]++; out.push_back(RefundOutcome::Refunded); }
+            }
+        }
+        --inFlight;
+        return out;
+    }
+
+    size_t maxBatch() const override { return batchLimit; }
+
+    int payoutsFor(uint64_t bookingId) {
+        lock_guard<mutex> guard(lock);
+        auto it = payouts.find(bookingId);
+        return it == payouts.end() ? 0 : it->second;
+    }
+};
+
+// Class: StripePayment implements Refundable for a single charge
+class StripePayment : public Refundable {
+private:
+    BatchRefundable& gateway;
+    RefundRequest charge;
+
+public:
+    StripePayment(BatchRefundable& gateway, RefundRequest charge) : gateway(gateway), charge(move(charge)) {}
+
+    void refund() override {
+        if (gateway.refundBatch({charge})[0] == RefundOutcome::Failed) throw runtime_error("Stripe refund failed");
+    }
+};
+
+// Adapter for providers that only offer the single refund() : a "batch" of one call per item.
+class OneByOneRefunds : public BatchRefundable {
+private:
+    function<unique_ptr<Refundable>(const RefundRequest&)> open;
+
+public:
+    OneByOneRefunds(function<unique_ptr<Refundable>(const RefundRequest&)> open) : open(move(open)) {}
+
+    vector<RefundOutcome> refundBatch(const vector<RefundRequest>& batch) override {
+        vector<RefundOutcome> out;
+        for (auto& r : batch) {
+            try { open(r)->refund(); out.push_back(RefundOutcome::Refunded); }
+            catch (const exception&) { out.push_back(RefundOutcome::Failed); }
+        }
+        return out;
+    }
+
+    size_t maxBatch() const override { return 16; }
+};
+
+
+//////////////////////////////////////////
+// Booking repository (paged scan)
+//////////////////////////////////////////
+
+struct Booking {
+    uint64_t id;
+    string showId, paymentMethod, chargeId;
+    int64_t amountCents;
+};
+
+class BookingRepository {
+private:
+    vector<Booking> rows;        // ordered by id
+
+public:
+    void add(Booking b) { rows.push_back(move(b)); }
+
+    // Bookings of a show with id > afterId, at most limit of them.
+    vector<Booking> page(const string& showId, uint64_t afterId, size_t limit) const {
+        vector<Booking> out;
+        auto it = upper_bound(rows.begin(), rows.end(), afterId, [](uint64_t id, const Booking& b) { return id < b.id; });
+        for (; it != rows.end() && out.size() < limit; ++it) {
+            if (it->showId == showId) out.push_back(*it);
+        }
+        return out;
+    }
+};
+
+
+//////////////////////////////////////////
+// Journal
+//////////////////////////////////////////
+
+class RefundJournal {
+private:
+    struct Entry { uint64_t bookingId; uint64_t outcome; };
+    int fd;
+    mutex lock;
+    unordered_map<uint64_t, RefundOutcome> finished;
+
+public:
+    explicit RefundJournal(const fs::path& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) throw runtime_error("cannot open " + path.string());
+        Entry e;
+        off_t offset = 0;
+        while (pread(fd, &e, sizeof(e), offset) == (ssize_t)sizeof(e)) {
+            finished[e.bookingId] = (RefundOutcome)e.outcome;
+            offset += sizeof(e);
+        }
+        if (ftruncate(fd, offset) != 0) throw runtime_error("cannot truncate journal");   // torn tail
+    }
+
+    ~RefundJournal() { ::close(fd); }
+
+    // Refunded (now or before). Failed entries are not settled and will be tried again.
+    bool isSettled(uint64_t bookingId) {
+        lock_guard<mutex> guard(lock);
+        auto it = finished.find(bookingId);
+        return it != finished.end() && it->second != RefundOutcome::Failed;
+    }
+
+    vector<uint64_t> failedIds() {
+        lock_guard<mutex> guard(lock);
+        vector<uint64_t> ids;
+        for (auto& [id, outcome] : finished) if (outcome == RefundOutcome::Failed) ids.push_back(id);
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    void record(const vector<pair<uint64_t, RefundOutcome>>& results) {
+        vector<Entry> entries;
+        for (auto& [id, outcome] : results) entries.push_back({id, (uint64_t)outcome});
+        lock_guard<mutex> guard(lock);
+        ssize_t bytes = entries.size() * sizeof(Entry);
+        if (::write(fd, entries.data(), bytes) != bytes || fdatasync(fd) != 0) throw runtime_error("journal write failed");
+        for (auto& [id, outcome] : results) finished[id] = outcome;
+    }
+
+    size_t settled() {
+        lock_guard<mutex> guard(lock);
+        return count_if(finished.begin(), finished.end(), [](auto& e) { return e.second != RefundOutcome::Failed; });
+    }
+};
+
+
+//////////////////////////////////////////
+// Bulk refund job
+//////////////////////////////////////////
+
+template<typename T>
+class BoundedQueue {
+private:
+    mutex lock;
+    condition_variable notEmpty, notFull;
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(T item) {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [&] { return items.size() < capacity || closed; });
+        items.push_back(move(item));
+        notEmpty.notify_one();
+    }
+
+    optional<T> pop() {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [&] { return !items.empty() || closed; });
+        if (items.empty()) return nullopt;
+        T item = move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+struct GatewayLane {
+    BatchRefundable* gateway;
+    int concurrency;
+};
+
+struct RetryPolicy {
+    int maxAttempts = 4;
+    chrono::milliseconds backoff{5};
+};
+
+struct RefundReport {
+    long refunded = 0, alreadyRefunded = 0, failed = 0, skipped = 0;
+    double seconds = 0;
+};
+
+class BulkRefundJob {
+private:
+    BookingRepository& repo;
+    map<string, GatewayLane> lanes;
+    RefundJournal journal;
+    RetryPolicy retry;
+    size_t pageSize;
+
+    mutex reportLock;
+    RefundReport report;
+
+    // Sends one batch, retrying the failed part. Returns the final outcome per booking.
+    vector<pair<uint64_t, RefundOutcome>> refundWithRetry(BatchRefundable& gateway, vector<RefundRequest> batch) {
+        vector<pair<uint64_t, RefundOutcome>> results;
+        for (int attempt = 1; !batch.empty(); attempt++) {
+            vector<RefundOutcome> outcomes;
+            try {
+                outcomes = gateway.refundBatch(batch);
+            } catch (const exception&) {
+                outcomes.assign(batch.size(), RefundOutcome::Failed);
+            }
+            vector<RefundRequest> again;
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (outcomes[i] != RefundOutcome::Failed || attempt == retry.maxAttempts) results.push_back({batch[i].bookingId, outcomes[i]});
+                else again.push_back(batch[i]);
+            }
+            batch = move(again);
+            if (!batch.empty()) this_thread::sleep_for(retry.backoff * (1 << (attempt - 1)));
+        }
+        return results;
+    }
+
+public:
+    BulkRefundJob(BookingRepository& repo, map<string, GatewayLane> lanes, const fs::path& journalPath,
+                  RetryPolicy retry = {}, size_t pageSize = 500)
+        : repo(repo), lanes(move(lanes)), journal(journalPath), retry(retry), pageSize(pageSize) {}
+
+    // crashAfterBatches >= 0 simulates a crash : that batch reaches the gateway but is not
+    // journaled, and the job stops.
+    RefundReport run(const string& showId, long crashAfterBatches = -1) {
+        auto start = Clock::now();
+        report = {};
+        atomic<long> batchesDone{0};
+        atomic<bool> crashed{false};
+
+        map<string, unique_ptr<BoundedQueue<vector<RefundRequest>>>> queues;
+        vector<thread> workers;
+        mutex errorLock;
+        exception_ptr workerError;
+        // On every way out (including a throw below) : close the queues and join the workers.
+        struct Shutdown {
+            map<string, unique_ptr<BoundedQueue<vector<RefundRequest>>>>& queues;
+            vector<thread>& workers;
+            ~Shutdown() {
+                for (auto& [method, q] : queues) q->close();
+                for (auto& w : workers) if (w.joinable()) w.join();
+            }
+        } shutdown{queues, workers};
+
+        for (auto& [method, lane] : lanes) {
+            auto& queue = queues[method] = make_unique<BoundedQueue<vector<RefundRequest>>>(lane.concurrency * 2);
+            for (int i = 0; i < lane.concurrency; i++) {
+                workers.emplace_back([&, q = queue.get(), gateway = lane.gateway] {
+                    while (auto batch = q->pop()) {
+                        if (crashed) continue;
+                        try {
+                            auto results = refundWithRetry(*gateway, move(*batch));
+                            if (crashAfterBatches >= 0 && batchesDone++ >= crashAfterBatches) { crashed = true; continue; }
+                            journal.record(results);
+                            lock_guard<mutex> guard(reportLock);
+                            for (auto& [id, outcome] : results) {
+                                if (outcome == RefundOutcome::Refunded) report.refunded++;
+                                else if (outcome == RefundOutcome::AlreadyRefunded) report.alreadyRefunded++;
+                                else report.failed++;
+                            }
+                        } catch (...) {                 // e.g. the journal write failed : stop the job
+                            lock_guard<mutex> guard(errorLock);
+                            if (!workerError) workerError = current_exception();
+                            crashed = true;
+                        }
+                    }
+                });
+            }
+        }
+
+        map<string, vector<RefundRequest>> pending;
+        uint64_t cursor = 0;
+        for (auto rows = repo.page(showId, 0, pageSize); !rows.empty() && !crashed; rows = repo.page(showId, cursor, pageSize)) {
+            for (auto& b : rows) {
+                cursor = b.id;
+                if (journal.isSettled(b.id)) { report.skipped++; continue; }
+                auto lane = lanes.find(b.paymentMethod);
+                if (lane == lanes.end()) throw runtime_error("no gateway for payment method " + b.paymentMethod);
+                auto& group = pending[b.paymentMethod];
+                group.push_back({b.id, b.chargeId, b.amountCents});
+                if (group.size() == lane->second.gateway->maxBatch()) {
+                    queues[b.paymentMethod]->push(move(group));
+                    group.clear();
+                }
+            }
+        }
+        for (auto& [method, group] : pending) {
+            if (!group.empty()) queues[method]->push(move(group));
+        }
+        for (auto& [method, q] : queues) q->close();
+        for (auto& w : workers) w.join();
+        if (workerError) rethrow_exception(workerError);
+
+        report.seconds = chrono::duration<double>(Clock::now() - start).count();
+        return report;
+    }
+
+    size_t settled() { return journal.settled(); }
+    vector<uint64_t> failedIds() { return journal.failedIds(); }
+};
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+BookingRepository makeBookings(int perShow, const vector<string>& methods) {
+    BookingRepository repo;
+    mt19937 rng(9);
+    uint64_t id = 0;
+    for (int i = 0; i < perShow; i++) {
+        for (string show : {"m101", "m202"}) {
+            string method = methods[rng() % methods.size()];
+            repo.add({++id, show, method, "ch_" + to_string(id), 500 + (int64_t)(rng() % 1500)});
+        }
+    }
+    return repo;
+}
+
+void checks(const fs::path& dir) {
+    FakeGateway stripe(chrono::microseconds(200), chrono::microseconds(2), 50, 0.05);
+    FakeGateway paypal(chrono::microseconds(300), chrono::microseconds(5), 20, 0.05);
+    FakeGateway legacyBackend(chrono::microseconds(100), chrono::microseconds(0), 1);
+    OneByOneRefunds legacy([&](const RefundRequest& r) { return make_unique<StripePayment>(legacyBackend, r); });
+
+    const int perShow = 3000;
+    BookingRepository repo = makeBookings(perShow, {"stripe", "paypal", "legacy"});
+    map<string, GatewayLane> lanes{{"stripe", {&stripe, 3}}, {"paypal", {&paypal, 2}}, {"legacy", {&legacy, 1}}};
+
+    RefundReport first, second;
+    {
+        BulkRefundJob job(repo, lanes, dir / "m101.journal");
+        first = job.run("m101", 20);
+    }
+    {
+        BulkRefundJob job(repo, lanes, dir / "m101.journal");
+        second = job.run("m101");
+        check(job.settled() == perShow, "every booking of the show is settled after resuming");
+    }
+    cout << "before crash : " << first.refunded << " refunded; after resume : " << second.skipped << " skipped, "
+         << second.refunded << " refunded, " << second.alreadyRefunded << " already refunded (crashed batch), "
+         << second.failed << " failed\n";
+    check(second.skipped == first.refunded + first.alreadyRefunded, "resume skips everything already refunded");
+    check(second.alreadyRefunded > 0, "the batch lost in the crash is answered by idempotency, not paid twice");
+
+    bool once = true;
+    for (auto b : repo.page("m101", 0, SIZE_MAX)) {
+        FakeGateway& g = b.paymentMethod == "stripe" ? stripe : b.paymentMethod == "paypal" ? paypal : legacyBackend;
+        once &= g.payoutsFor(b.id) <= 1;
+    }
+    check(once, "no booking is refunded twice");
+    for (auto b : repo.page("m202", 0, SIZE_MAX)) once &= stripe.payoutsFor(b.id) == 0 && paypal.payoutsFor(b.id) == 0;
+    check(once, "bookings of other shows are untouched");
+    check(stripe.maxInFlight <= 3 && paypal.maxInFlight <= 2 && legacyBackend.maxInFlight <= 1,
+          "per-gateway concurrency limits hold (stripe " + to_string(stripe.maxInFlight) + "/3, paypal " +
+          to_string(paypal.maxInFlight) + "/2)");
+
+    // A gateway that is down : its bookings are journaled as failed and retried by the next run.
+    FakeGateway down(chrono::microseconds(50), chrono::microseconds(0), 50, 1.0), up(chrono::microseconds(50), chrono::microseconds(0), 50);
+    BookingRepository single = makeBookings(200, {"stripe"});
+    RefundReport outage, retried;
+    size_t failedAfterOutage, failedAfterRetry;
+    {
+        BulkRefundJob job(single, {{"stripe", {&down, 2}}}, dir / "outage.journal", {2, chrono::milliseconds(1)});
+        outage = job.run("m101");
+        failedAfterOutage = job.failedIds().size();
+    }
+    {
+        BulkRefundJob job(single, {{"stripe", {&up, 2}}}, dir / "outage.journal", {2, chrono::milliseconds(1)});
+        retried = job.run("m101");
+        failedAfterRetry = job.failedIds().size();
+    }
+    check(outage.failed == 200 && failedAfterOutage == 200 && retried.skipped == 0 && retried.refunded == 200 &&
+          failedAfterRetry == 0, "bookings that failed every attempt are picked up again by the next run");
+
+    // A booking with no lane : the job throws (after joining its workers) instead of terminating.
+    bool threw = false;
+    try {
+        BulkRefundJob job(repo, {{"stripe", {&stripe, 3}}}, dir / "nolane.journal");
+        job.run("m202");
+    } catch (const runtime_error&) { threw = true; }
+    check(threw, "an unknown payment method fails the job cleanly");
+}
+
+void benchmark(const fs::path& dir) {
+    const int perShow = 20000;
+    const auto perCall = chrono::milliseconds(5);
+    const auto perItem = chrono::microseconds(20);
+    FakeGateway stripe(perCall, perItem, 100), paypal(perCall, perItem, 50);
+    BookingRepository repo = makeBookings(perShow, {"stripe", "paypal"});
+
+    auto bookings = repo.page("m202", 0, 400);
+    auto t0 = Clock::now();
+    for (auto& b : bookings) {
+        StripePayment payment(b.paymentMethod == "stripe" ? stripe : paypal, {b.id, b.chargeId, b.amountCents});
+        payment.refund();
+    }
+    double naive = bookings.size() / chrono::duration<double>(Clock::now() - t0).count();
+
+    BulkRefundJob job(repo, {{"stripe", {&stripe, 8}}, {"paypal", {&paypal, 4}}}, dir / "m101.bench.journal");
+    RefundReport r = job.run("m101");
+    cout << "gateway : " << perCall.count() << "ms per call + " << perItem.count() << "us per item\n";
+    cout << "one refund() at a time : " << (long)naive << " refunds/sec\n";
+    cout << "bulk job (" << perShow << " bookings, stripe x8 lanes, paypal x4) : "
+         << (long)((r.refunded + r.alreadyRefunded) / r.seconds) << " refunds/sec in " << fixed << setprecision(2)
+         << r.seconds << "s, " << stripe.calls + paypal.calls - (long)bookings.size() << " gateway calls\n";
+}
+
+
+int main() {
+    fs::path dir = "/tmp/bulk_refund_demo";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    checks(dir);
+
+    cout << "\n--- refunds per second ---\n";
+    benchmark(dir);
+
+    fs::remove_all(dir);
+    return 0;
+}
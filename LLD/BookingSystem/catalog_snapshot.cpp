@@ -0,0 +1,645 @@
+/*
+
+Fast-Startup Catalog : Perfect Hashing + mmap Snapshots
+
+Movies, venues and shows are looked up by string id everywhere ("m101", "m202").
+On a cold start the service would read a text/CSV dump and rebuild every unordered_map :
+millions of small string allocations before the first request can be served.
+
+Solution : build the catalog OFFLINE into one binary file that can be used as-is.
+
+    [ header | movie seeds | movie records | venue ... | show ... | string pool ]
+
+> No pointers inside the file, only offsets -> position independent, mmap anywhere.
+> Startup = open + mmap + check the header and the checksum. Pages are shared
+  between processes that map the same file.
+> The file is not trusted : every offset is bounds-checked without overflow at open,
+  and every string ref / movie / venue index is checked when a record is read, so a
+  corrupt or hostile file throws instead of reading outside the mapping.
+  A 64-bit checksum over the whole file catches torn or bit-flipped copies.
+> Index = minimal perfect hash (hash-and-displace) :
+      key -> bucket -> seed for that bucket -> slot
+  Every key has its own slot (no collisions, no probing), and records are stored
+  in slot order, so a lookup is 2 hashes + 1 string compare. The index costs
+  4 bytes per bucket (~1.3 bytes per key).
+> Shows point to their movie / venue by slot number, not by string.
+> Hot swap : a new version is written to a temp file, fsync'ed, renamed into place,
+  and the directory is fsync'ed so the rename itself survives a crash.
+  CatalogService swaps its atomic<shared_ptr> to the new mapping. Readers that still
+  hold the old snapshot keep using it; it is unmapped when the last one lets go.
+
+*/
+
+#include<bits/stdc++.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// File format
+//////////////////////////////////////////
+
+struct StrRef { uint32_t off, len; };          // into the string pool
+
+struct MovieRecord { StrRef id, title; uint32_t durationMin; };
+struct VenueRecord { StrRef id, name, city; uint32_t screens; };
+struct ShowRecord  { StrRef id; int64_t startsAt; uint32_t movie, venue, priceCents; };
+
+struct SectionHeader {
+    uint32_t count, buckets;
+    uint64_t seedsOff, recordsOff;
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fileSize;
+    SectionHeader movies, venues, shows;
+    uint64_t stringsOff, stringsSize;
+    uint64_t checksum;           // fileChecksum() with this field zeroed
+};
+
+static constexpr uint32_t kVersion = 2;
+
+static constexpr char kMagic[8] = {'C', 'A', 'T', 'S', 'N', 'A', 'P', '1'};
+
+static uint64_t hashKey(string_view s) {
+    uint64_t h = 1469598103934665603ull;
+    for (char c : s) h = (h ^ (uint8_t)c) * 1099511628211ull;
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint32_t slotFor(uint64_t h, int32_t seed, uint32_t n) {
+    uint64_t x = h + (uint64_t)seed * 0x9E3779B97F4A7C15ull;
+    x ^= x >> 31;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 29;
+    return (uint32_t)(((x & 0xffffffffull) * n) >> 32);
+}
+
+static uint32_t bucketFor(uint64_t h, uint32_t buckets) {
+    return (uint32_t)(((h >> 32) * buckets) >> 32);
+}
+
+// 8 bytes per step, so checking a 50 MB snapshot costs milliseconds, not a CRC's 100+.
+static uint64_t fileChecksum(const char* data, size_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    for (; i < n; i++) h = (h ^ (uint8_t)data[i]) * 1099511628211ull;
+    h ^= h >> 33;
+    return h * 0xc4ceb9fe1a85ec53ull;
+}
+
+static uint64_t headerChecksum(const char* file, size_t size) {
+    FileHeader h;
+    memcpy(&h, file, sizeof(h));
+    h.checksum = 0;
+    uint64_t a = fileChecksum(reinterpret_cast<const char*>(&h), sizeof(h));
+    return a ^ fileChecksum(file + sizeof(h), size - sizeof(h)) * 31;
+}
+
+// [off, off + count * elem) lies inside [0, size), computed without overflow.
+static bool fits(uint64_t off, uint64_t count, uint64_t elem, uint64_t size) {
+    return off <= size && (elem == 0 || count <= (size - off) / elem);
+}
+
+
+//////////////////////////////////////////
+// Minimal perfect hash builder (hash-and-displace)
+//////////////////////////////////////////
+
+// seeds[b] >= 0 : displacement seed for bucket b
+// seeds[b] <  0 : bucket has one key placed directly in slot -seeds[b]-1
+struct PerfectHash {
+    vector<int32_t> seeds;
+    vector<uint32_t> slotOf;     // slot of keys[i]
+};
+
+PerfectHash buildPerfectHash(const vector<string_view>& keys, uint32_t buckets) {
+    uint32_t n = keys.size();
+    PerfectHash ph;
+    ph.seeds.assign(buckets, 0);
+    ph.slotOf.assign(n, 0);
+    if (n == 0) return ph;
+
+    vector<uint64_t> hashes(n);
+    vector<vector<uint32_t>> members(buckets);
+    for (uint32_t i = 0; i < n; i++) {
+        hashes[i] = hashKey(keys[i]);
+        members[bucketFor(hashes[i], buckets)].push_back(i);
+    }
+
+    // big buckets first, while most slots are still free
+    vector<uint32_t> order(buckets);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return members[a].size() > members[b].size(); });
+
+    vector<bool> taken(n, false);
+    vector<uint32_t> freeSlots;
+    vector<uint32_t> trial;
+    for (uint32_t b : order) {
+        auto& keysInBucket = members[b];
+        if (keysInBucket.empty()) break;
+
+        if (keysInBucket.size() == 1) {
+            if (freeSlots.empty()) {
+                for (uint32_t s = n; s-- > 0;) if (!taken[s]) freeSlots.push_back(s);
+            }
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            taken[slot] = true;
+            ph.slotOf[keysInBucket[0]] = slot;
+            ph.seeds[b] = -(int32_t)slot - 1;
+            continue;
+        }
+
+        for (int32_t seed = 0;; seed++) {
+            if (seed == (1 << 24)) throw runtime_error("perfect hash : no seed found (duplicate keys?)");
+            trial.clear();
+            bool ok = true;
+            for (uint32_t i : keysInBucket) {
+                uint32_t s = slotFor(hashes[i], seed, n);
+                if (taken[s] || find(trial.begin(), trial.end(), s) != trial.end()) { ok = false; break; }
+                trial.push_back(s);
+            }
+            if (!ok) continue;
+            for (size_t k = 0; k < keysInBucket.size(); k++) {
+                taken[trial[k]] = true;
+                ph.slotOf[keysInBucket[k]] = trial[k];
+            }
+            ph.seeds[b] = seed;
+            break;
+        }
+    }
+    return ph;
+}
+
+
+//////////////////////////////////////////
+// Source data + offline snapshot writer
+//////////////////////////////////////////
+
+struct Movie { string id, title; uint32_t durationMin; };
+struct Venue { string id, name, city; uint32_t screens; };
+struct Show  { string id, movieId, venueId; int64_t startsAt; uint32_t priceCents; };
+
+struct CatalogSource {
+    vector<Movie> movies;
+    vector<Venue> venues;
+    vector<Show> shows;
+};
+
+class SnapshotWriter {
+private:
+    string file;
+    string strings;
+
+    StrRef intern(const string& s) {
+        StrRef r{(uint32_t)strings.size(), (uint32_t)s.size()};
+        strings += s;
+        return r;
+    }
+
+    template<class T>
+    uint64_t append(const vector<T>& items) {
+        file.resize((file.size() + 7) & ~size_t(7), '\0');
+        uint64_t off = file.size();
+        file.append(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(T));
+        return off;
+    }
+
+    // Builds the index for one table and returns records placed in slot order.
+    template<class Rec, class Item, class Fill>
+    SectionHeader section(const vector<Item>& items, vector<uint32_t>& slotOf, Fill fill) {
+        vector<string_view> keys;
+        for (auto& it : items) keys.push_back(it.id);
+        uint32_t buckets = max<uint32_t>(1, items.size() / 3);
+        PerfectHash ph = buildPerfectHash(keys, buckets);
+        slotOf = ph.slotOf;
+
+        vector<Rec> records(items.size());
+        for (size_t i = 0; i < items.size(); i++) records[ph.slotOf[i]] = fill(items[i]);
+        SectionHeader h{(uint32_t)items.size(), buckets, 0, 0};
+        h.seedsOff = append(ph.seeds);
+        h.recordsOff = append(records);
+        return h;
+    }
+
+public:
+    // Writes to a temp file and renames, so readers only ever see complete snapshots.
+    void write(const CatalogSource& src, const string& path) {
+        file.assign(sizeof(FileHeader), '\0');
+        strings.clear();
+        FileHeader header{};
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+
+        vector<uint32_t> movieSlot, venueSlot, showSlot;
+        header.movies = section<MovieRecord>(src.movies, movieSlot, [&](const Movie& m) {
+            return MovieRecord{intern(m.id), intern(m.title), m.durationMin};
+        });
+        header.venues = section<VenueRecord>(src.venues, venueSlot, [&](const Venue& v) {
+            return VenueRecord{intern(v.id), intern(v.name), intern(v.city), v.screens};
+        });
+
+        unordered_map<string_view, uint32_t> movieIndex, venueIndex;
+        for (size_t i = 0; i < src.movies.size(); i++) movieIndex[src.movies[i].id] = movieSlot[i];
+        for (size_t i = 0; i < src.venues.size(); i++) venueIndex[src.venues[i].id] = venueSlot[i];
+        header.shows = section<ShowRecord>(src.shows, showSlot, [&](const Show& s) {
+            auto m = movieIndex.find(s.movieId);
+            auto v = venueIndex.find(s.venueId);
+            if (m == movieIndex.end() || v == venueIndex.end()) throw invalid_argument("show " + s.id + " has unknown movie or venue");
+            return ShowRecord{intern(s.id), s.startsAt, m->second, v->second, s.priceCents};
+        });
+
+        header.stringsOff = file.size();
+        header.stringsSize = strings.size();
+        file += strings;
+        header.fileSize = file.size();
+        memcpy(file.data(), &header, sizeof(header));
+        header.checksum = headerChecksum(file.data(), file.size());
+        memcpy(file.data(), &header, sizeof(header));
+
+        publish(path);
+        file.clear();
+        file.shrink_to_fit();
+    }
+
+private:
+    // tmp file -> fsync -> rename -> fsync the directory : after a crash `path` is
+    // either the old snapshot or the complete new one.
+    void publish(const string& path) {
+        string tmp = path + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) throw runtime_error("cannot write " + tmp);
+        size_t done = 0;
+        while (done < file.size()) {
+            ssize_t w = ::write(fd, file.data() + done, file.size() - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            done += w;
+        }
+        bool ok = done == file.size() && fsync(fd) == 0;
+        ::close(fd);
+        if (!ok) {
+            ::unlink(tmp.c_str());
+            throw runtime_error("cannot write " + tmp);
+        }
+        if (rename(tmp.c_str(), path.c_str()) != 0) throw runtime_error("cannot publish " + path);
+
+        string dirCopy = path;
+        int dirFd = ::open(dirname(dirCopy.data()), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd < 0) throw runtime_error("cannot open directory of " + path);
+        ok = fsync(dirFd) == 0;
+        ::close(dirFd);
+        if (!ok) throw runtime_error("cannot sync directory of " + path);
+    }
+};
+
+
+//////////////////////////////////////////
+// Read side : mmap'ed snapshot
+//////////////////////////////////////////
+
+struct MovieView { string_view id, title; uint32_t durationMin; };
+struct VenueView { string_view id, name, city; uint32_t screens; };
+struct ShowView  { string_view id; MovieView movie; VenueView venue; int64_t startsAt; uint32_t priceCents; };
+
+class CatalogSnapshot {
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+    const FileHeader* header = nullptr;
+
+    [[noreturn]] static void corrupt() { throw runtime_error("catalog snapshot is corrupt"); }
+
+    template<class Rec>
+    void checkSection(const SectionHeader& s) const {
+        if (s.count > 0 && s.buckets == 0) corrupt();
+        if (s.seedsOff % alignof(int32_t) != 0 || s.recordsOff % alignof(Rec) != 0) corrupt();
+        if (!fits(s.seedsOff, s.buckets, sizeof(int32_t), size) || !fits(s.recordsOff, s.count, sizeof(Rec), size)) corrupt();
+    }
+
+    // String refs come from the file : check them against the pool before use.
+    string_view str(StrRef r) const {
+        if (!fits(r.off, r.len, 1, header->stringsSize)) corrupt();
+        return {base + header->stringsOff + r.off, r.len};
+    }
+
+    template<class Rec>
+    const Rec* find(const SectionHeader& s, string_view key) const {
+        if (s.count == 0) return nullptr;
+        uint64_t h = hashKey(key);
+        int32_t seed = reinterpret_cast<const int32_t*>(base + s.seedsOff)[bucketFor(h, s.buckets)];
+        uint32_t slot = seed < 0 ? (uint32_t)(-(seed + 1)) : slotFor(h, seed, s.count);
+        if (slot >= s.count) return nullptr;
+        const Rec* r = reinterpret_cast<const Rec*>(base + s.recordsOff) + slot;
+        return str(r->id) == key ? r : nullptr;       // keys not in the catalog land on some slot too
+    }
+
+    MovieView view(const MovieRecord& m) const { return {str(m.id), str(m.title), m.durationMin}; }
+    VenueView view(const VenueRecord& v) const { return {str(v.id), str(v.name), str(v.city), v.screens}; }
+
+public:
+    // verifyChecksum = false skips the whole-file pass (trusted, locally built files only);
+    // the bounds checks still apply.
+    explicit CatalogSnapshot(const string& path, bool verifyChecksum = true) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw runtime_error("cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+            ::close(fd);
+            throw runtime_error("catalog snapshot is corrupt");
+        }
+        size = st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw runtime_error("mmap failed for " + path);
+        base = static_cast<const char*>(p);
+        header = reinterpret_cast<const FileHeader*>(base);
+
+        try {
+            if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+                throw runtime_error("not a catalog snapshot : " + path);
+            }
+            if (header->fileSize != size || !fits(header->stringsOff, header->stringsSize, 1, size)) corrupt();
+            if (verifyChecksum && headerChecksum(base, size) != header->checksum) corrupt();
+            checkSection<MovieRecord>(header->movies);
+            checkSection<VenueRecord>(header->venues);
+            checkSection<ShowRecord>(header->shows);
+        } catch (...) {
+            munmap(const_cast<char*>(base), size);
+            throw;
+        }
+    }
+
+    ~CatalogSnapshot() { munmap(const_cast<char*>(base), size); }
+
+    CatalogSnapshot(const CatalogSnapshot&) = delete;
+    CatalogSnapshot& operator=(const CatalogSnapshot&) = delete;
+
+    optional<MovieView> movie(string_view id) const {
+        auto r = find<MovieRecord>(header->movies, id);
+        return r ? optional(view(*r)) : nullopt;
+    }
+
+    optional<VenueView> venue(string_view id) const {
+        auto r = find<VenueRecord>(header->venues, id);
+        return r ? optional(view(*r)) : nullopt;
+    }
+
+    optional<ShowView> show(string_view id) const {
+        auto r = find<ShowRecord>(header->shows, id);
+        if (!r) return nullopt;
+        if (r->movie >= header->movies.count || r->venue >= header->venues.count) corrupt();
+        auto movies = reinterpret_cast<const MovieRecord*>(base + header->movies.recordsOff);
+        auto venues = reinterpret_cast<const VenueRecord*>(base + header->venues.recordsOff);
+        return ShowView{str(r->id), view(movies[r->movie]), view(venues[r->venue]), r->startsAt, r->priceCents};
+    }
+
+    size_t showCount() const { return header->shows.count; }
+    size_t bytes() const { return size; }
+};
+
+// What the booking service holds. reload() can run while requests are in flight.
+class CatalogService {
+private:
+    atomic<shared_ptr<const CatalogSnapshot>> current;
+
+public:
+    explicit CatalogService(const string& path) : current(make_shared<const CatalogSnapshot>(path)) {}
+
+    void reload(const string& path) {
+        current.store(make_shared<const CatalogSnapshot>(path));
+    }
+
+    // Hold on to the returned pointer for the whole request : views point into it.
+    shared_ptr<const CatalogSnapshot> snapshot() const { return current.load(); }
+};
+
+
+//////////////////////////////////////////
+// Text catalog (the baseline we replace)
+//////////////////////////////////////////
+
+CatalogSource generateCatalog(int movies, int venues, int shows, uint32_t seed) {
+    mt19937 rng(seed);
+    CatalogSource src;
+    for (int i = 0; i < movies; i++) src.movies.push_back({"m" + to_string(i), "Movie number " + to_string(i), uint32_t(90 + rng() % 90)});
+    for (int i = 0; i < venues; i++) src.venues.push_back({"v" + to_string(i), "Cinema " + to_string(i), "City" + to_string(i % 50), uint32_t(1 + rng() % 12)});
+    for (int i = 0; i < shows; i++) {
+        src.shows.push_back({"s" + to_string(i), "m" + to_string(rng() % movies), "v" + to_string(rng() % venues),
+                             1700000000 + (int64_t)(rng() % 10000000), uint32_t(800 + rng() % 1200)});
+    }
+    return src;
+}
+
+void writeText(const CatalogSource& src, const string& path) {
+    ofstream out(path);
+    for (auto& m : src.movies) out << "movie," << m.id << "," << m.title << "," << m.durationMin << "\n";
+    for (auto& v : src.venues) out << "venue," << v.id << "," << v.name << "," << v.city << "," << v.screens << "\n";
+    for (auto& s : src.shows) out << "show," << s.id << "," << s.movieId << "," << s.venueId << "," << s.startsAt << "," << s.priceCents << "\n";
+}
+
+struct TextCatalog {
+    unordered_map<string, Movie> movies;
+    unordered_map<string, Venue> venues;
+    unordered_map<string, Show> shows;
+};
+
+TextCatalog loadText(const string& path) {
+    TextCatalog c;
+    ifstream in(path);
+    string line;
+    vector<string> f;
+    while (getline(in, line)) {
+        f.clear();
+        stringstream ss(line);
+        for (string part; getline(ss, part, ',');) f.push_back(part);
+        if (f[0] == "movie") c.movies[f[1]] = {f[1], f[2], (uint32_t)stoul(f[3])};
+        else if (f[0] == "venue") c.venues[f[1]] = {f[1], f[2], f[3], (uint32_t)stoul(f[4])};
+        else c.shows[f[1]] = {f[1], f[2], f[3], stoll(f[4]), (uint32_t)stoul(f[5])};
+    }
+    return c;
+}
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks(const string& dir) {
+    CatalogSource src = generateCatalog(300, 20, 5000, 1);
+    SnapshotWriter().write(src, dir + "/v1.snap");
+    CatalogSnapshot snap(dir + "/v1.snap");
+
+    bool all = true;
+    for (auto& s : src.shows) {
+        auto v = snap.show(s.id);
+        all &= v && v->movie.id == s.movieId && v->venue.id == s.venueId && v->priceCents == s.priceCents;
+    }
+    for (auto& m : src.movies) all &= snap.movie(m.id) && snap.movie(m.id)->title == m.title;
+    check(all, "every show, movie and venue is found with the right data");
+    check(!snap.show("s999999") && !snap.movie("nope") && !snap.venue(""), "unknown ids are rejected");
+
+    {
+        ofstream(dir + "/bad.snap", ios::binary) << "garbage that is not a catalog at all............................................";
+        bool rejected = false;
+        try { CatalogSnapshot bad(dir + "/bad.snap"); } catch (const runtime_error&) { rejected = true; }
+        check(rejected, "a corrupt snapshot is refused at load time");
+    }
+
+    {
+        auto readFile = [&](const string& path) {
+            ifstream in(path, ios::binary);
+            return string(istreambuf_iterator<char>(in), {});
+        };
+        auto writeFile = [&](const string& path, const string& bytes) { ofstream(path, ios::binary) << bytes; };
+        auto refused = [&](const string& path, bool verify) {
+            try { CatalogSnapshot s(path, verify); } catch (const runtime_error&) { return true; }
+            return false;
+        };
+        string good = readFile(dir + "/v1.snap");
+        FileHeader h;
+        memcpy(&h, good.data(), sizeof(h));
+
+        string flipped = good;
+        flipped[good.size() / 2] ^= 0x40;
+        writeFile(dir + "/flipped.snap", flipped);
+        check(refused(dir + "/flipped.snap", true), "a single flipped bit fails the checksum");
+
+        // Offsets that only pass with wrapping arithmetic, checksum fixed up so the bounds check must catch it.
+        string wrapped = good;
+        FileHeader w = h;
+        w.shows.recordsOff = UINT64_MAX - 15;
+        w.shows.count = 1;
+        memcpy(wrapped.data(), &w, sizeof(w));
+        w.checksum = headerChecksum(wrapped.data(), wrapped.size());
+        memcpy(wrapped.data(), &w, sizeof(w));
+        writeFile(dir + "/wrapped.snap", wrapped);
+        check(refused(dir + "/wrapped.snap", true) && refused(dir + "/wrapped.snap", false),
+              "a section running past the end of the file is refused");
+
+        // A record whose string ref points outside the pool : caught when the record is read.
+        string badRef = good;
+        auto* movies = reinterpret_cast<MovieRecord*>(badRef.data() + h.movies.recordsOff);
+        movies[0].title = {(uint32_t)h.stringsSize - 2, UINT32_MAX};
+        auto* shows = reinterpret_cast<ShowRecord*>(badRef.data() + h.shows.recordsOff);
+        shows[0].venue = h.venues.count;
+        writeFile(dir + "/badref.snap", badRef);
+        CatalogSnapshot trusting(dir + "/badref.snap", false);
+        bool refRejected = false, indexRejected = false;
+        try { for (auto& m : src.movies) trusting.movie(m.id); }
+        catch (const runtime_error&) { refRejected = true; }
+        try { for (auto& s : src.shows) trusting.show(s.id); } catch (const runtime_error&) { indexRejected = true; }
+        check(refRejected && indexRejected, "out-of-pool string refs and out-of-range venue indices throw instead of reading past the map");
+    }
+
+    // hot swap while readers are running
+    CatalogSource v2 = src;
+    for (auto& s : v2.shows) s.priceCents += 1;
+    SnapshotWriter().write(v2, dir + "/v2.snap");
+    CatalogService service(dir + "/v1.snap");
+    atomic<bool> stop{false};
+    atomic<long> reads{0}, bad{0};
+    thread reader([&] {
+        long i = 0;
+        while (!stop) {
+            auto s = service.snapshot();
+            auto& want = src.shows[i++ % src.shows.size()];
+            auto v = s->show(want.id);
+            if (!v || (v->priceCents != want.priceCents && v->priceCents != want.priceCents + 1)) bad++;
+            reads++;
+        }
+    });
+    for (int i = 0; i < 50; i++) {
+        service.reload(dir + (i % 2 ? "/v1.snap" : "/v2.snap"));
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    stop = true;
+    reader.join();
+    check(bad == 0 && reads > 0, "readers see a complete catalog during " + to_string(50) + " hot swaps (" + to_string(reads) + " reads)");
+}
+
+template<class F>
+double nsPerOp(long ops, F&& f) {
+    auto start = Clock::now();
+    f();
+    return chrono::duration<double, nano>(Clock::now() - start).count() / ops;
+}
+
+void benchmark(const string& dir, int shows) {
+    CatalogSource src = generateCatalog(shows / 20, 2000, shows, 7);
+    writeText(src, dir + "/catalog.csv");
+    auto buildStart = Clock::now();
+    SnapshotWriter().write(src, dir + "/catalog.snap");
+    double buildSec = chrono::duration<double>(Clock::now() - buildStart).count();
+
+    auto t0 = Clock::now();
+    TextCatalog text = loadText(dir + "/catalog.csv");
+    double textMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    { CatalogSnapshot trusted(dir + "/catalog.snap", false); }
+    double trustedMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    CatalogService service(dir + "/catalog.snap");
+    double snapMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+    auto snap = service.snapshot();
+
+    cout << shows << " shows, " << src.movies.size() << " movies, " << src.venues.size() << " venues"
+         << " (snapshot " << snap->bytes() / (1 << 20) << " MB, built offline in " << fixed << setprecision(2) << buildSec << "s)\n";
+    cout << "startup : text -> unordered_map " << setprecision(1) << textMs << " ms, mmap snapshot "
+         << setprecision(3) << snapMs << " ms with checksum, " << trustedMs << " ms header only\n";
+
+    const long lookups = 2000000;
+    mt19937 rng(3);
+    vector<string> keys;
+    for (int i = 0; i < 4096; i++) keys.push_back("s" + to_string(rng() % shows));
+    long found = 0;
+    double mapNs = nsPerOp(lookups, [&] {
+        for (long i = 0; i < lookups; i++) found += text.shows.find(keys[(i * 2654435761u) & 4095]) != text.shows.end();
+    });
+    double mphNs = nsPerOp(lookups, [&] {
+        for (long i = 0; i < lookups; i++) found += snap->show(keys[(i * 2654435761u) & 4095]).has_value();
+    });
+    cout << "lookup  : unordered_map " << setprecision(1) << mapNs << " ns, perfect hash " << mphNs << " ns"
+         << "   (" << found << " hits)\n";
+}
+
+
+int main() {
+    string dir = "/tmp/catalog_snapshot_demo";
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+
+    checks(dir);
+
+    cout << "\n--- startup and lookup ---\n";
+    benchmark(dir, 1000000);
+
+    filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,472 @@
+/*
+
+Coroutine Based Booking Flow
+
+Blocking Ticketbooking (SRP/theory.cpp) :
+
+    thread 1 : seat check ... wait ... payment ... wait 20ms ... notify ... wait ...
+    thread 2 : seat check ... wait ... payment ... wait 20ms ... notify ... wait ...
+
+Every booking in flight owns an OS thread, and the thread does nothing while it waits
+on the payment gateway. Threads are expensive : a stack, a kernel task, context switches.
+
+C++20 coroutines :
+
+    Task<bool> bookTicket(...) {
+        if (!co_await seatChecker.isSeatAvailable(...)) co_return false;
+        bool paid = co_await paymentService.processPayment(...);   // suspends, thread is free
+        ...
+    }
+
+> co_await suspends only this booking. Its local variables live in a small heap
+  "coroutine frame" (a few hundred bytes) instead of a whole thread stack.
+> An Executor runs on one thread (one per core). It keeps a queue of ready coroutines
+  and an epoll reactor : when a socket becomes readable or a timer expires,
+  the waiting coroutine is put back on the ready queue.
+> One core can now keep tens of thousands of bookings in flight.
+
+Compile : g++ -std=c++20 -O2 -pthread coroutine_booking.cpp
+(io_uring would be another reactor backend; epoll is used because it needs no extra library.)
+
+*/
+
+#include<bits/stdc++.h>
+#include <coroutine>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Task<T> : lazy coroutine that resumes its awaiter when done
+//////////////////////////////////////////
+
+// Counts coroutine frame memory so we can report bytes per suspended booking.
+// Per thread : an executor creates and destroys its frames on its own thread, so each
+// executor sees only its own frames and its own peak.
+static thread_local long liveFrameBytes = 0;
+static thread_local long peakFrameBytes = 0;
+
+struct PromiseBase {
+    coroutine_handle<> continuation = noop_coroutine();
+    exception_ptr error;
+
+    static void* operator new(size_t size) {
+        liveFrameBytes += size;
+        peakFrameBytes = max(peakFrameBytes, liveFrameBytes);
+        return ::operator new(size);
+    }
+
+    static void operator delete(void* ptr, size_t size) {
+        liveFrameBytes -= size;
+        ::operator delete(ptr);
+    }
+
+    suspend_always initial_suspend() noexcept { return {}; }
+
+    // When the task finishes, jump straight into whoever was awaiting it.
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        coroutine_handle<> await_suspend(coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = current_exception(); }
+};
+
+template <typename T> class Task;
+
+template <typename T>
+struct TaskPromise : PromiseBase {
+    T value{};
+    Task<T> get_return_object();
+    void return_value(T v) { value = move(v); }
+    T result() {
+        if (error) rethrow_exception(error);
+        return move(value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void result() {
+        if (error) rethrow_exception(error);
+    }
+};
+
+template <typename T>
+class Task {
+public:
+    using promise_type = TaskPromise<T>;
+
+private:
+    coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(exchange(other.handle, {})) {}
+    Task(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;          // start the child right away (symmetric transfer)
+    }
+    T await_resume() { return handle.promise().result(); }
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+
+//////////////////////////////////////////
+// Executor : ready queue + timers + epoll reactor (one per thread)
+//////////////////////////////////////////
+
+class Executor {
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        coroutine_handle<> handle;
+        bool operator>(const Timer& other) const { return deadline > other.deadline; }
+    };
+
+    int epollFd;
+    deque<coroutine_handle<>> ready;
+    priority_queue<Timer, vector<Timer>, greater<Timer>> timers;
+    long liveTasks = 0;
+    long peakLiveTasks = 0;
+
+    static thread_local Executor* currentExecutor;
+
+    // Top-level coroutine that owns a spawned task and frees itself at the end.
+    struct Detached {
+        struct promise_type : PromiseBase {
+            // plain allocation : only the booking Task frames are counted
+            static void* operator new(size_t size) { return ::operator new(size); }
+            static void operator delete(void* ptr) { ::operator delete(ptr); }
+            Detached get_return_object() { return {}; }
+            suspend_never initial_suspend() noexcept { return {}; }
+            suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { terminate(); }
+        };
+    };
+
+    static Detached runDetached(Executor* self, Task<void> task) {
+        co_await task;
+        self->liveTasks--;
+    }
+
+public:
+    Executor() : epollFd(epoll_create1(0)) {
+        if (epollFd < 0) throw runtime_error("epoll_create1 failed");
+    }
+    ~Executor() { ::close(epollFd); }
+
+    static Executor& current() { return *currentExecutor; }
+
+    void spawn(Task<void> task) {
+        liveTasks++;
+        peakLiveTasks = max(peakLiveTasks, liveTasks);
+        ready.push_back(noop_coroutine());   // keeps run() going even if task finishes immediately
+        Executor* previous = exchange(currentExecutor, this);
+        runDetached(this, move(task));       // runs until its first suspension
+        currentExecutor = previous;
+    }
+
+    void schedule(coroutine_handle<> h) { ready.push_back(h); }
+
+    void addTimer(Clock::time_point deadline, coroutine_handle<> h) { timers.push({deadline, h}); }
+
+    // One-shot readiness : the coroutine is resumed once when fd has the requested events.
+    void watch(int fd, uint32_t events, coroutine_handle<> h) {
+        epoll_event ev{};
+        ev.events = events | EPOLLONESHOT;
+        ev.data.ptr = h.address();
+        if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) < 0 && errno == ENOENT) {
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+
+    void unwatch(int fd) { epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr); }
+
+    // Runs until every spawned task has finished.
+    void run() {
+        Executor* previous = exchange(currentExecutor, this);
+        epoll_event events[256];
+        while (liveTasks > 0 || !ready.empty()) {
+            while (!ready.empty()) {
+                auto h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+            if (liveTasks == 0) break;
+
+            int timeoutMs = -1;
+            if (!timers.empty()) {
+                auto wait = chrono::ceil<chrono::milliseconds>(timers.top().deadline - Clock::now());
+                timeoutMs = max<long>(0, wait.count());
+            }
+            int n = epoll_wait(epollFd, events, 256, timeoutMs);
+            for (int i = 0; i < n; i++) ready.push_back(coroutine_handle<>::from_address(events[i].data.ptr));
+
+            auto now = Clock::now();
+            while (!timers.empty() && timers.top().deadline <= now) {
+                ready.push_back(timers.top().handle);
+                timers.pop();
+            }
+        }
+        currentExecutor = previous;
+    }
+
+    long peakInFlight() const { return peakLiveTasks; }
+};
+
+thread_local Executor* Executor::currentExecutor = nullptr;
+
+
+//////////////////////////////////////////
+// Awaitables
+//////////////////////////////////////////
+
+struct SleepFor {
+    chrono::microseconds duration;
+    bool await_ready() const noexcept { return duration.count() <= 0; }
+    void await_suspend(coroutine_handle<> h) {
+        Executor::current().addTimer(Clock::now() + duration, h);
+    }
+    void await_resume() noexcept {}
+};
+
+struct Readable {
+    int fd;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> h) { Executor::current().watch(fd, EPOLLIN, h); }
+    void await_resume() noexcept {}
+};
+
+// Reads exactly n bytes from a non-blocking socket, suspending while no data is there.
+Task<bool> readExact(int fd, char* buf, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = ::read(fd, buf + got, n - got);
+        if (r > 0) got += r;
+        else if (r == 0) co_return false;
+        else if (errno == EAGAIN) co_await Readable{fd};
+        else co_return false;
+    }
+    co_return true;
+}
+
+
+//////////////////////////////////////////
+// co_await-able services
+//////////////////////////////////////////
+
+// Simulated latencies of the real backends
+static const chrono::microseconds kSeatLatency(200);
+static const chrono::microseconds kPaymentLatency(20000);
+static const chrono::microseconds kNotifyLatency(5000);
+
+class SeatChecker {
+public:
+    Task<bool> isSeatAvailable(int movieId, string seatNumber) {
+        co_await SleepFor{kSeatLatency};
+        co_return seatNumber != "Z99";
+    }
+};
+
+class PriceCalculator {
+public:
+    int getPrice(int movieId, string seatNumber) {
+        return 100;     // pure computation, no need to suspend
+    }
+};
+
+class PaymentService {
+public:
+    Task<bool> processPayment(int userId, int amount) {
+        co_await SleepFor{kPaymentLatency};
+        co_return userId % 50 != 0;
+    }
+};
+
+class NotificationService {
+public:
+    Task<void> sendConfirmation(int userId, int movieId) {
+        co_await SleepFor{kNotifyLatency};
+    }
+};
+
+class Ticketbooking {
+private:
+    SeatChecker &seatchecker;
+    PriceCalculator &pricecalculator;
+    PaymentService &paymentservice;
+    NotificationService &notificationservice;
+
+public:
+    Ticketbooking(SeatChecker &seatchecker,
+        PriceCalculator &pricecalculator, PaymentService &paymentservice,
+        NotificationService &notificationservice):
+        seatchecker(seatchecker), pricecalculator(pricecalculator),
+        paymentservice(paymentservice), notificationservice(notificationservice) {
+    }
+
+    // Same steps as SRP/theory.cpp, only every wait is a co_await.
+    Task<bool> bookTicket(int userId, int movieId, string seatNumber) {
+        if (!co_await seatchecker.isSeatAvailable(movieId, seatNumber)) co_return false;
+        int price = pricecalculator.getPrice(movieId, seatNumber);
+        if (!co_await paymentservice.processPayment(userId, price)) co_return false;
+        co_await notificationservice.sendConfirmation(userId, movieId);
+        co_return true;
+    }
+};
+
+
+//////////////////////////////////////////
+// Demo : payment over a real socket, gateway and client on the same thread
+//////////////////////////////////////////
+
+Task<void> fakeGateway(int fd) {
+    int32_t amount;
+    while (co_await readExact(fd, reinterpret_cast<char*>(&amount), sizeof(amount))) {
+        co_await SleepFor{chrono::microseconds(1000)};
+        char approved = amount <= 500 ? 1 : 0;
+        if (::write(fd, &approved, 1) != 1) break;
+    }
+    Executor::current().unwatch(fd);
+}
+
+Task<void> payOverSocket(int fd, int userId, int32_t amount, int* approvedCount) {
+    if (::write(fd, &amount, sizeof(amount)) != sizeof(amount)) co_return;
+    char approved = 0;
+    if (co_await readExact(fd, &approved, 1) && approved) ++*approvedCount;
+    cout << "  user " << userId << " paid " << amount << " -> " << (approved ? "approved" : "declined") << "\n";
+}
+
+Task<void> socketDemo(int clientFd, int* approvedCount) {
+    co_await payOverSocket(clientFd, 1, 120, approvedCount);
+    co_await payOverSocket(clientFd, 2, 900, approvedCount);
+    co_await payOverSocket(clientFd, 3, 300, approvedCount);
+    Executor::current().unwatch(clientFd);
+    ::shutdown(clientFd, SHUT_WR);      // gateway sees EOF and stops
+}
+
+
+//////////////////////////////////////////
+// Benchmarks
+//////////////////////////////////////////
+
+static long residentKb() {
+    ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void benchmarkCoroutines(int bookings, int cores) {
+    SeatChecker s; PriceCalculator p; PaymentService pay; NotificationService n;
+    Ticketbooking booking(s, p, pay, n);
+    atomic<long> succeeded{0}, frameBytes{0}, peakInFlight{0};
+
+    auto spawnAll = [&](Executor& ex, int from, int to) {
+        for (int i = from; i < to; i++) {
+            ex.spawn([](Ticketbooking& b, int userId, atomic<long>& ok) -> Task<void> {
+                if (co_await b.bookTicket(userId, 101, "A" + to_string(userId % 200))) ok++;
+            }(booking, i, succeeded));
+        }
+    };
+
+    auto start = Clock::now();
+    vector<thread> perCore;
+    for (int c = 0; c < cores; c++) {
+        perCore.emplace_back([&, c] {
+            Executor ex;
+            spawnAll(ex, bookings * c / cores, bookings * (c + 1) / cores);
+            ex.run();
+            frameBytes += peakFrameBytes;           // this executor's peak, added after it is done
+            peakInFlight += ex.peakInFlight();
+        });
+    }
+    for (auto& t : perCore) t.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+
+    cout << "coroutines : " << bookings << " bookings on " << cores << " executor(s) in "
+         << fixed << setprecision(3) << sec << "s, peak in flight " << peakInFlight
+         << ", frame bytes/booking " << frameBytes / max(1L, peakInFlight.load())
+         << ", succeeded " << succeeded << "\n";
+}
+
+// Blocking version : one thread per in-flight booking.
+void benchmarkThreads(int bookings) {
+    atomic<long> succeeded{0};
+    atomic<int> started{0};
+    long rssBefore = residentKb(), rssPeak = rssBefore;
+
+    auto start = Clock::now();
+    vector<thread> threads;
+    threads.reserve(bookings);
+    for (int i = 0; i < bookings; i++) {
+        threads.emplace_back([&, i] {
+            started++;
+            this_thread::sleep_for(kSeatLatency);
+            this_thread::sleep_for(kPaymentLatency);
+            if (i % 50 != 0) {
+                this_thread::sleep_for(kNotifyLatency);
+                succeeded++;
+            }
+        });
+        if (i % 256 == 0) rssPeak = max(rssPeak, residentKb());
+    }
+    rssPeak = max(rssPeak, residentKb());
+    for (auto& t : threads) t.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+
+    cout << "threads    : " << bookings << " bookings, one thread each, in "
+         << fixed << setprecision(3) << sec << "s, RSS growth " << rssPeak - rssBefore
+         << " KB (" << (rssPeak - rssBefore) * 1024 / bookings << " bytes/booking), succeeded "
+         << succeeded << "\n";
+}
+
+
+int main() {
+    // fd awaitable demo
+    {
+        int fds[2];
+        socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds);
+        int approved = 0;
+        Executor ex;
+        ex.spawn(fakeGateway(fds[1]));
+        ex.spawn(socketDemo(fds[0], &approved));
+        ex.run();
+        cout << "  approved " << approved << " of 3 payments over the socket\n\n";
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    int cores = max(1u, thread::hardware_concurrency());
+    benchmarkThreads(2000);
+    benchmarkCoroutines(2000, 1);
+    benchmarkCoroutines(50000, 1);
+    benchmarkCoroutines(50000, cores);
+
+    return 0;
+}
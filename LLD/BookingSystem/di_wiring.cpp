@@ -0,0 +1,291 @@
+/*
+
+Compile-Time Dependency Wiring for the DIP Layers
+
+Problem :
+    BookTicketControllerDIP -> BookTicketServiceDIP* -> ITicketRepository* (SOLID/DIP/example.cpp)
+    Every request pays two pointer hops and a virtual call, and the compiler can inline none
+    of it, even though production always wires the same three classes.
+
+Solution :
+
+    Layers are templates over the layer below, and hold it BY VALUE :
+        BookTicketController<Service>     holds  Service
+        BookTicketService<Repository>     holds  Repository
+    Repository is checked by a concept (TicketRepository) instead of a base class.
+
+    Wire<Repository, Layer...>::type is the composition root :
+        Wire<TicketRepositoryDIP, BookTicketService, BookTicketController>::type
+            == BookTicketController<BookTicketService<TicketRepositoryDIP>>
+        One object, no pointers, every call resolved at compile time and inlinable.
+
+    Tests keep runtime polymorphism by wiring RuntimeRepository (holds an ITicketRepository&)
+    at the bottom instead : same layers, one virtual call, any fake can be injected.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+
+//////////////////////////////////////////
+// Repository abstraction (runtime + compile time)
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+template <typename R>
+concept TicketRepository = requires(R r, const string& id) {
+    { r.bookTicket(id, id) } -> convertible_to<string>;
+};
+
+class TicketRepositoryDIP final : public ITicketRepository {
+private:
+    long saved = 0;
+
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        saved++;
+        string id = "bk-";                 // short enough to stay in the string's inline buffer
+        id += movieId;
+        return id;
+    }
+
+    long bookings() const { return saved; }
+};
+
+// Bottom layer for tests : forwards to whatever ITicketRepository it is given.
+class RuntimeRepository {
+private:
+    ITicketRepository* impl;
+
+public:
+    explicit RuntimeRepository(ITicketRepository& impl) : impl(&impl) {}
+
+    string bookTicket(const string& userId, const string& movieId) {
+        return impl->bookTicket(userId, movieId);
+    }
+};
+
+
+//////////////////////////////////////////
+// Layers, templated over the layer below
+//////////////////////////////////////////
+
+template <TicketRepository Repository>
+class BookTicketService {
+private:
+    Repository repo;
+
+public:
+    // Constrained so that copying a service still picks the copy constructor.
+    template <typename... Args>
+        requires (!is_same_v<remove_cvref_t<Args>, BookTicketService> && ...)
+    explicit BookTicketService(Args&&... args) : repo(forward<Args>(args)...) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo.bookTicket(userId, movieId);
+    }
+
+    Repository& repository() { return repo; }
+};
+
+template <typename Service>
+class BookTicketController {
+private:
+    Service service;
+
+public:
+    template <typename... Args>
+        requires (!is_same_v<remove_cvref_t<Args>, BookTicketController> && ...)
+    explicit BookTicketController(Args&&... args) : service(forward<Args>(args)...) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        string bookingId = service.execute(reqBody.at("userId"), reqBody.at("movieId"));
+        return {{"success", "true"}, {"bookingId", bookingId}};
+    }
+
+    // Same request without the map round trip, for callers that already have the fields.
+    string book(const string& userId, const string& movieId) {
+        return service.execute(userId, movieId);
+    }
+
+    Service& downstream() { return service; }
+};
+
+
+//////////////////////////////////////////
+// Composition root
+//////////////////////////////////////////
+
+// Wire<Bottom, L1, L2>::type = L2<L1<Bottom>>. Constructor arguments go to the bottom layer.
+template <typename Bottom, template <typename> class... Layers>
+struct Wire;
+
+template <typename Bottom>
+struct Wire<Bottom> {
+    using type = Bottom;
+};
+
+template <typename Bottom, template <typename> class Next, template <typename> class... Rest>
+struct Wire<Bottom, Next, Rest...> {
+    using type = typename Wire<Next<Bottom>, Rest...>::type;
+};
+
+using ProductionController = Wire<TicketRepositoryDIP, BookTicketService, BookTicketController>::type;
+using TestableController = Wire<RuntimeRepository, BookTicketService, BookTicketController>::type;
+
+static_assert(is_same_v<ProductionController, BookTicketController<BookTicketService<TicketRepositoryDIP>>>);
+static_assert(sizeof(ProductionController) == sizeof(TicketRepositoryDIP), "production graph holds no pointers");
+static_assert(sizeof(TestableController) == sizeof(void*), "test graph holds exactly one pointer");
+static_assert(is_copy_constructible_v<ProductionController> && is_copy_constructible_v<TestableController>);
+
+
+//////////////////////////////////////////
+// The original pointer-wired layers (baseline)
+//////////////////////////////////////////
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+class BookTicketControllerDIP {
+    BookTicketServiceDIP* service;
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        string bookingId = service->execute(reqBody.at("userId"), reqBody.at("movieId"));
+        return {{"success", "true"}, {"bookingId", bookingId}};
+    }
+
+    string book(const string& userId, const string& movieId) {
+        return service->execute(userId, movieId);
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+class FakeTicketRepository : public ITicketRepository {
+public:
+    vector<pair<string, string>> calls;
+
+    string bookTicket(const string& userId, const string& movieId) override {
+        calls.push_back({userId, movieId});
+        return "fake-" + to_string(calls.size());
+    }
+};
+
+void checks() {
+    map<string, string> request = {{"userId", "u1"}, {"movieId", "m101"}};
+
+    ProductionController production;
+    auto response = production.handleRequest(request);
+    check(response["success"] == "true" && response["bookingId"] == "bk-m101" &&
+          production.downstream().repository().bookings() == 1,
+          "compile-time graph books through the concrete repository");
+
+    FakeTicketRepository fake;
+    TestableController testable(fake);
+    testable.handleRequest(request);
+    response = testable.handleRequest({{"userId", "u2"}, {"movieId", "m7"}});
+    check(fake.calls.size() == 2 && fake.calls[1] == pair<string, string>{"u2", "m7"} && response["bookingId"] == "fake-2",
+          "runtime variant lets a test inject a fake repository");
+
+    const TestableController original(fake);
+    TestableController copy(original);
+    ProductionController productionCopy(production);
+    check(copy.book("u3", "m8") == "fake-3" && productionCopy.downstream().repository().bookings() == 1,
+          "a wired controller copies like a value instead of forwarding itself to the bottom layer");
+
+    TicketRepositoryDIP repo;
+    BookTicketServiceDIP service(&repo);
+    BookTicketControllerDIP pointers(&service);
+    check(pointers.handleRequest(request) == production.handleRequest(request), "all wirings give the same response");
+}
+
+
+//////////////////////////////////////////
+// Benchmark : per-request overhead
+//////////////////////////////////////////
+
+template <typename Controller>
+[[gnu::noinline]] long driveBook(Controller& controller, const vector<pair<string, string>>& ids, long n) {
+    long sink = 0;
+    for (long i = 0; i < n; i++) {
+        auto& [user, movie] = ids[i & (ids.size() - 1)];
+        sink += controller.book(user, movie).size();
+    }
+    return sink;
+}
+
+template <typename Controller>
+[[gnu::noinline]] long driveHandle(Controller& controller, const vector<map<string, string>>& requests, long n) {
+    long sink = 0;
+    for (long i = 0; i < n; i++) sink += controller.handleRequest(requests[i & (requests.size() - 1)]).size();
+    return sink;
+}
+
+template <typename F>
+double nsPer(long n, F body) {
+    body(n / 10);                                   // warm up
+    auto start = chrono::steady_clock::now();
+    long sink = body(n);
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / n;
+    if (sink == 42) cout << "";
+    return ns;
+}
+
+int main(int argc, char** argv) {
+    checks();
+
+    vector<pair<string, string>> ids;
+    vector<map<string, string>> requests;
+    for (int i = 0; i < 64; i++) {
+        ids.push_back({"u" + to_string(i), "m" + to_string(100 + i)});
+        requests.push_back({{"userId", ids.back().first}, {"movieId", ids.back().second}});
+    }
+
+    // The repository behind the pointer graphs is picked at runtime, as it would be from
+    // config, so the compiler cannot devirtualise those calls.
+    FakeTicketRepository fake;
+    TicketRepositoryDIP concrete;
+    ITicketRepository& chosen = argc > 99 ? (ITicketRepository&)fake : concrete;
+
+    BookTicketServiceDIP service(&chosen);
+    BookTicketControllerDIP pointers(&service);
+    TestableController testable(chosen);
+    ProductionController production;
+
+    const long n = 20000000, nHandle = 2000000;
+    cout << "\n--- per-request cost, controller -> service -> repository ---\n";
+    cout << left << setw(46) << "wiring" << right << setw(14) << "book()" << setw(18) << "handleRequest()" << "\n";
+    auto row = [&](const string& label, auto& controller) {
+        double direct = nsPer(n, [&](long k) { return driveBook(controller, ids, k); });
+        double handled = nsPer(nHandle, [&](long k) { return driveHandle(controller, requests, k); });
+        cout << left << setw(46) << label << right << fixed << setprecision(2) << setw(11) << direct << " ns"
+             << setw(15) << handled << " ns\n";
+    };
+    row("pointers + virtual (BookTicketControllerDIP)", pointers);
+    row("runtime variant (TestableController)", testable);
+    row("compile time (ProductionController)", production);
+    return 0;
+}
@@ -0,0 +1,729 @@
+/*
+
+epoll HTTP Front End for BookTicketControllerDIP
+
+In DIP/example.cpp the only caller of BookTicketControllerDIP::handleRequest is main()
+with a hand-built map. To know what serving a booking really costs we need a network
+front end.
+
+    client --TCP--> Reactor thread (epoll) --> HttpParser --> handleRequest --> response
+
+Design :
+
+> Multi-reactor : N threads, each with its OWN listening socket on the same port
+  (SO_REUSEPORT, the kernel spreads new connections) and its own epoll instance.
+  A connection stays on one thread for its whole life -> no locks between threads.
+> Non-blocking sockets : a thread never waits on one slow client.
+> Keep-alive : one TCP connection carries many requests.
+> Pipelining : a client may send several requests without waiting; we parse every
+  complete request in the buffer and answer them in order.
+> Incremental, zero-copy parser : method / path / headers / body are string_views into
+  the connection's read buffer. If a request arrives in pieces the parser remembers how
+  far it already searched for the end of the headers.
+
+> Half-close : if the client shuts down its side, requests already buffered are still
+  answered before the connection is closed.
+
+Request :   POST /book  with body  userId=u1&movieId=m101     (form-encoded : '+', %XY decoded)
+Response :  {"success":"true","bookingId":"..."}              (values JSON-escaped)
+
+Run :   ./http_server              -> starts on loopback and runs the bundled load generator
+        ./http_server serve 8080   -> just serve
+
+*/
+
+#include<bits/stdc++.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// DIP layers (from DIP/example.cpp, quiet repository)
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class InMemoryTicketRepository : public ITicketRepository {
+private:
+    atomic<long> nextId{1};
+
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        return "booking-" + movieId + "-" + to_string(nextId++);
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+class BookTicketControllerDIP {
+    BookTicketServiceDIP* service;
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        string userId = reqBody.at("userId");
+        string movieId = reqBody.at("movieId");
+        string bookingId = service->execute(userId, movieId);
+
+        return {
+            {"success", "true"},
+            {"bookingId", bookingId}
+        };
+    }
+};
+
+
+//////////////////////////////////////////
+// Incremental zero-copy HTTP/1.1 parser
+//////////////////////////////////////////
+
+struct HttpRequest {
+    string_view method;
+    string_view target;
+    string_view body;
+    bool keepAlive = true;
+    vector<pair<string_view, string_view>> headers;
+};
+
+static bool equalsIgnoreCase(string_view a, string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) return false;
+    }
+    return true;
+}
+
+class HttpParser {
+private:
+    size_t scanned = 0;     // bytes already searched for "\r\n\r\n" in the current request
+
+public:
+    enum class Result { Complete, NeedMore, Error };
+
+    static constexpr size_t kMaxHeaderBytes = 16 * 1024;
+    static constexpr size_t kMaxBodyBytes = 1024 * 1024;
+
+    // Parses one request from data[0..len). On Complete, `consumed` is its total size
+    // and every view in `req` points into data.
+    Result parse(const char* data, size_t len, HttpRequest& req, size_t& consumed) {
+        string_view buf(data, len);
+        size_t from = scanned >= 3 ? scanned - 3 : 0;
+        size_t headerEnd = buf.find("\r\n\r\n", from);
+        if (headerEnd == string_view::npos) {
+            scanned = len;
+            return len > kMaxHeaderBytes ? Result::Error : Result::NeedMore;
+        }
+
+        // request line
+        size_t lineEnd = buf.find("\r\n");
+        string_view line = buf.substr(0, lineEnd);
+        size_t sp1 = line.find(' '), sp2 = line.rfind(' ');
+        if (sp1 == string_view::npos || sp2 == sp1) return Result::Error;
+        req.method = line.substr(0, sp1);
+        req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        string_view version = line.substr(sp2 + 1);
+        if (version.substr(0, 5) != "HTTP/") return Result::Error;
+        req.keepAlive = version == "HTTP/1.1";
+
+        // headers
+        req.headers.clear();
+        size_t contentLength = 0;
+        size_t pos = lineEnd + 2;
+        while (pos < headerEnd) {
+            size_t end = buf.find("\r\n", pos);
+            string_view header = buf.substr(pos, end - pos);
+            size_t colon = header.find(':');
+            if (colon == string_view::npos) return Result::Error;
+            string_view name = header.substr(0, colon);
+            string_view value = header.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+            while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+            req.headers.push_back({name, value});
+
+            if (equalsIgnoreCase(name, "Content-Length")) {
+                // the whole value must be the number : "5abc" is not a length of 5
+                auto [p, ec] = from_chars(value.data(), value.data() + value.size(), contentLength);
+                if (value.empty() || ec != errc() || p != value.data() + value.size() || contentLength > kMaxBodyBytes) {
+                    return Result::Error;
+                }
+            } else if (equalsIgnoreCase(name, "Connection")) {
+                if (equalsIgnoreCase(value, "close")) req.keepAlive = false;
+                else if (equalsIgnoreCase(value, "keep-alive")) req.keepAlive = true;
+            } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+                return Result::Error;           // chunked bodies are not needed for booking requests
+            }
+            pos = end + 2;
+        }
+
+        size_t bodyStart = headerEnd + 4;
+        if (len < bodyStart + contentLength) return Result::NeedMore;
+        req.body = buf.substr(bodyStart, contentLength);
+        consumed = bodyStart + contentLength;
+        scanned = 0;
+        return Result::Complete;
+    }
+};
+
+// application/x-www-form-urlencoded : '+' is a space, %XY is a byte. Throws on a bad escape.
+static string urlDecode(string_view s) {
+    auto hex = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '+') out += ' ';
+        else if (s[i] != '%') out += s[i];
+        else {
+            int hi = i + 2 < s.size() ? hex(s[i + 1]) : -1, lo = hi >= 0 ? hex(s[i + 2]) : -1;
+            if (lo < 0) throw invalid_argument("bad percent-escape in form body");
+            out += (char)(hi << 4 | lo);
+            i += 2;
+        }
+    }
+    return out;
+}
+
+// userId=u1&movieId=m101  ->  map the controller understands
+static map<string, string> parseForm(string_view body) {
+    map<string, string> fields;
+    while (!body.empty()) {
+        size_t amp = body.find('&');
+        string_view pair = body.substr(0, amp);
+        size_t eq = pair.find('=');
+        if (eq != string_view::npos) fields.emplace(urlDecode(pair.substr(0, eq)), urlDecode(pair.substr(eq + 1)));
+        if (amp == string_view::npos) break;
+        body.remove_prefix(amp + 1);
+    }
+    return fields;
+}
+
+// Appends s as the inside of a JSON string literal.
+static void appendJsonEscaped(string& out, string_view s) {
+    for (char ch : s) {
+        unsigned char c = ch;
+        if (c == '"' || c == '\\') { out += '\\'; out += ch; }
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else if (c == '\t') out += "\\t";
+        else if (c < 0x20) {
+            char esc[7];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        } else out += ch;
+    }
+}
+
+
+//////////////////////////////////////////
+// Reactor : one thread, one epoll, one listening socket
+//////////////////////////////////////////
+
+class Reactor {
+private:
+    struct Connection {
+        int fd;
+        string in;
+        size_t inStart = 0;       // first unparsed byte of `in`
+        string out;
+        size_t outSent = 0;
+        bool closeAfterWrite = false;
+        HttpParser parser;
+    };
+
+    BookTicketControllerDIP& controller;
+    atomic<bool>& stopping;
+    int listenFd;
+    int epollFd;
+    unordered_map<int, unique_ptr<Connection>> connections;
+    HttpRequest request;                  // reused for every request
+    long served = 0;
+
+    static void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+    void closeConnection(Connection& c) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        connections.erase(c.fd);
+    }
+
+    void appendResponse(Connection& c, int status, string_view reason, string_view body, bool keepAlive) {
+        char head[160];
+        int n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 %d %.*s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%s\r\n",
+                         status, (int)reason.size(), reason.data(), body.size(),
+                         keepAlive ? "" : "Connection: close\r\n");
+        c.out.append(head, n);
+        c.out.append(body);
+    }
+
+    void handle(Connection& c) {
+        if (request.method != "POST" || request.target != "/book") {
+            appendResponse(c, 404, "Not Found", "{\"success\":\"false\"}", request.keepAlive);
+            return;
+        }
+        try {
+            auto response = controller.handleRequest(parseForm(request.body));
+            string body = "{\"success\":\"";
+            appendJsonEscaped(body, response["success"]);
+            body += "\",\"bookingId\":\"";
+            appendJsonEscaped(body, response["bookingId"]);
+            body += "\"}";
+            appendResponse(c, 200, "OK", body, request.keepAlive);
+        } catch (const out_of_range&) {
+            appendResponse(c, 400, "Bad Request", "{\"success\":\"false\",\"error\":\"userId and movieId are required\"}",
+                           request.keepAlive);
+        } catch (const invalid_argument&) {
+            appendResponse(c, 400, "Bad Request", "{\"success\":\"false\",\"error\":\"malformed form body\"}",
+                           request.keepAlive);
+        } catch (...) {
+            // a failing controller costs this request, not the reactor and its other connections
+            appendResponse(c, 500, "Internal Server Error", "{\"success\":\"false\",\"error\":\"internal error\"}",
+                           request.keepAlive);
+        }
+        served++;
+    }
+
+    // Returns false if the connection was closed.
+    bool flush(Connection& c) {
+        while (c.outSent < c.out.size()) {
+            ssize_t n = ::send(c.fd, c.out.data() + c.outSent, c.out.size() - c.outSent, MSG_NOSIGNAL);
+            if (n > 0) { c.outSent += n; continue; }
+            if (n < 0 && errno == EAGAIN) {
+                epoll_event ev{EPOLLIN | EPOLLOUT, {.fd = c.fd}};
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+                return true;
+            }
+            closeConnection(c);
+            return false;
+        }
+        c.out.clear();
+        c.outSent = 0;
+        if (c.closeAfterWrite) {
+            closeConnection(c);
+            return false;
+        }
+        epoll_event ev{EPOLLIN, {.fd = c.fd}};
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        return true;
+    }
+
+    void onReadable(Connection& c) {
+        char chunk[16 * 1024];
+        bool peerDone = false;          // client shut down its side : answer what it sent, then close
+        while (true) {
+            ssize_t n = ::recv(c.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) { c.in.append(chunk, n); continue; }
+            if (n == 0) { peerDone = true; break; }
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) { closeConnection(c); return; }
+            break;
+        }
+
+        // answer every complete request in the buffer (pipelining)
+        while (!c.closeAfterWrite) {
+            size_t consumed = 0;
+            auto result = c.parser.parse(c.in.data() + c.inStart, c.in.size() - c.inStart, request, consumed);
+            if (result == HttpParser::Result::NeedMore) break;
+            if (result == HttpParser::Result::Error) {
+                appendResponse(c, 400, "Bad Request", "{\"success\":\"false\"}", false);
+                c.closeAfterWrite = true;
+                break;
+            }
+            handle(c);
+            c.inStart += consumed;
+            if (!request.keepAlive) c.closeAfterWrite = true;
+        }
+        // drop parsed bytes; unparsed tail moves to the front
+        if (c.inStart > 0) {
+            c.in.erase(0, c.inStart);
+            c.inStart = 0;
+        }
+        if (peerDone) c.closeAfterWrite = true;
+        if (!c.out.empty()) flush(c);
+        else if (c.closeAfterWrite) closeConnection(c);
+    }
+
+    void onAccept() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            auto conn = make_unique<Connection>();
+            conn->fd = fd;
+            epoll_event ev{EPOLLIN, {.fd = fd}};
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            connections.emplace(fd, move(conn));
+        }
+    }
+
+public:
+    Reactor(BookTicketControllerDIP& controller, uint16_t port, atomic<bool>& stopping)
+        : controller(controller), stopping(stopping) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1024) < 0) {
+            throw runtime_error("cannot listen on port " + to_string(port) + ": " + strerror(errno));
+        }
+        epollFd = epoll_create1(0);
+        epoll_event ev{EPOLLIN, {.fd = listenFd}};
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    }
+
+    ~Reactor() {
+        for (auto& [fd, c] : connections) ::close(fd);
+        ::close(listenFd);
+        ::close(epollFd);
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (!stopping) {
+            int n = epoll_wait(epollFd, events, 256, 100);
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) { onAccept(); continue; }
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                Connection& c = *it->second;
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) { closeConnection(c); continue; }
+                if ((events[i].events & EPOLLOUT) && !flush(c)) continue;
+                if (events[i].events & EPOLLIN) onReadable(c);
+            }
+        }
+    }
+
+    long requestsServed() const { return served; }
+};
+
+class HttpServer {
+private:
+    atomic<bool> stopping{false};
+    vector<unique_ptr<Reactor>> reactors;
+    vector<thread> threads;
+
+public:
+    HttpServer(BookTicketControllerDIP& controller, uint16_t port, int reactorCount) {
+        for (int i = 0; i < reactorCount; i++) reactors.push_back(make_unique<Reactor>(controller, port, stopping));
+    }
+
+    void start() {
+        for (auto& r : reactors) threads.emplace_back(&Reactor::run, r.get());
+    }
+
+    void stop() {
+        stopping = true;
+        for (auto& t : threads) t.join();
+        threads.clear();
+    }
+
+    long requestsServed() const {
+        long total = 0;
+        for (auto& r : reactors) total += r->requestsServed();
+        return total;
+    }
+};
+
+
+//////////////////////////////////////////
+// Load generator : closed loop, keep-alive, optional pipelining
+//////////////////////////////////////////
+
+struct LoadResult {
+    long requests = 0;
+    long errors = 0;
+    vector<uint32_t> latencyMicros;
+};
+
+// Size of the first complete response in `in`, or 0 if it has not fully arrived.
+static size_t responseLength(string_view in) {
+    size_t headerEnd = in.find("\r\n\r\n");
+    if (headerEnd == string_view::npos) return 0;
+    size_t at = in.substr(0, headerEnd).find("Content-Length: ");
+    if (at == string_view::npos) return 0;
+    size_t bodyLen = 0;
+    from_chars(in.data() + at + 16, in.data() + headerEnd, bodyLen);
+    return in.size() >= headerEnd + 4 + bodyLen ? headerEnd + 4 + bodyLen : 0;
+}
+
+// Drives every connection at once from one epoll loop. Each connection sends pipelineDepth
+// requests back to back, and each request's latency runs from its own send to its own response.
+LoadResult runClient(uint16_t port, int connections, int pipelineDepth, chrono::milliseconds duration, int seed) {
+    struct ClientConnection {
+        int fd;
+        string in;
+        deque<Clock::time_point> outstanding;     // send time of each request not answered yet
+    };
+
+    LoadResult result;
+    vector<string> requests;
+    for (int d = 0; d < pipelineDepth; d++) {
+        string body = "userId=u" + to_string(seed * 1000 + d) + "&movieId=m101";
+        requests.push_back("POST /book HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                           "Content-Length: " + to_string(body.size()) + "\r\n\r\n" + body);
+    }
+
+    int epollFd = epoll_create1(0);
+    vector<ClientConnection> conns;
+    conns.reserve(connections);
+    for (int i = 0; i < connections; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { ::close(fd); result.errors++; continue; }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        conns.push_back({fd, {}, {}});
+        epoll_event ev{EPOLLIN, {.u32 = (uint32_t)conns.size() - 1}};
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    // Requests are a few hundred bytes, so a burst always fits in the socket buffer.
+    auto sendBurst = [&](ClientConnection& c) {
+        for (auto& r : requests) {
+            c.outstanding.push_back(Clock::now());
+            if (::send(c.fd, r.data(), r.size(), MSG_NOSIGNAL) != (ssize_t)r.size()) { result.errors++; return false; }
+        }
+        return true;
+    };
+    auto drop = [&](ClientConnection& c) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        c.fd = -1;
+    };
+
+    for (auto& c : conns) if (!sendBurst(c)) drop(c);
+
+    auto deadline = Clock::now() + duration;
+    epoll_event events[256];
+    char chunk[64 * 1024];
+    while (Clock::now() < deadline) {
+        int n = epoll_wait(epollFd, events, 256, 10);
+        for (int i = 0; i < n; i++) {
+            ClientConnection& c = conns[events[i].data.u32];
+            if (c.fd < 0) continue;
+            ssize_t got;
+            while ((got = ::recv(c.fd, chunk, sizeof(chunk), 0)) > 0) c.in.append(chunk, got);
+            if (got == 0 || (got < 0 && errno != EAGAIN)) { result.errors++; drop(c); continue; }
+
+            size_t used = 0;
+            for (size_t len; !c.outstanding.empty() && (len = responseLength(string_view(c.in).substr(used))) > 0; used += len) {
+                auto now = Clock::now();
+                result.latencyMicros.push_back(chrono::duration_cast<chrono::microseconds>(now - c.outstanding.front()).count());
+                c.outstanding.pop_front();
+                result.requests++;
+            }
+            c.in.erase(0, used);
+            if (c.outstanding.empty() && !sendBurst(c)) drop(c);
+        }
+    }
+    for (auto& c : conns) if (c.fd >= 0) ::close(c.fd);
+    ::close(epollFd);
+    return result;
+}
+
+void loadTest(uint16_t port, int clientThreads, int connectionsPerThread, int pipelineDepth) {
+    vector<LoadResult> results(clientThreads);
+    vector<thread> clients;
+    auto start = Clock::now();
+    for (int t = 0; t < clientThreads; t++) {
+        clients.emplace_back([&, t] {
+            results[t] = runClient(port, connectionsPerThread, pipelineDepth, chrono::milliseconds(1000), t);
+        });
+    }
+    for (auto& c : clients) c.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+
+    LoadResult total;
+    for (auto& r : results) {
+        total.requests += r.requests;
+        total.errors += r.errors;
+        total.latencyMicros.insert(total.latencyMicros.end(), r.latencyMicros.begin(), r.latencyMicros.end());
+    }
+    sort(total.latencyMicros.begin(), total.latencyMicros.end());
+    auto pct = [&](double p) {
+        if (total.latencyMicros.empty()) return 0u;
+        return total.latencyMicros[min(total.latencyMicros.size() - 1, (size_t)(p * total.latencyMicros.size()))];
+    };
+    cout << clientThreads * connectionsPerThread << " connections, pipeline " << pipelineDepth << " : "
+         << (long)(total.requests / sec) << " req/s, p50 " << pct(0.50) << "us, p99 " << pct(0.99)
+         << "us, p99.9 " << pct(0.999) << "us, errors " << total.errors << "\n";
+}
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+// Sends each part (pausing between them), optionally half-closes, returns everything read until EOF.
+static string exchange(uint16_t port, const vector<string>& parts, bool halfClose) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { ::close(fd); return ""; }
+    for (auto& part : parts) {
+        send(fd, part.data(), part.size(), MSG_NOSIGNAL);
+        this_thread::sleep_for(chrono::milliseconds(20));
+    }
+    if (halfClose) shutdown(fd, SHUT_WR);
+    string reply;
+    char buf[4096];
+    for (ssize_t n; (n = recv(fd, buf, sizeof(buf), 0)) > 0;) reply.append(buf, n);
+    ::close(fd);
+    return reply;
+}
+
+static vector<string> bodies(string_view reply) {
+    vector<string> out;
+    for (size_t len; (len = responseLength(reply)) > 0; reply.remove_prefix(len)) {
+        out.emplace_back(reply.substr(reply.find("\r\n\r\n") + 4, len - reply.find("\r\n\r\n") - 4));
+    }
+    return out;
+}
+
+void checks(uint16_t port) {
+    HttpParser parser;
+    HttpRequest req;
+    size_t consumed = 0;
+    string full = "POST /book HTTP/1.1\r\nContent-Length: 5\r\nConnection: close\r\n\r\nhello";
+    bool whole = parser.parse(full.data(), full.size(), req, consumed) == HttpParser::Result::Complete &&
+                 req.method == "POST" && req.target == "/book" && req.body == "hello" && !req.keepAlive &&
+                 consumed == full.size();
+    check(whole, "parser : complete request with method, target, body and Connection: close");
+
+    HttpParser split;
+    bool partial = split.parse(full.data(), 30, req, consumed) == HttpParser::Result::NeedMore &&
+                   split.parse(full.data(), full.size() - 2, req, consumed) == HttpParser::Result::NeedMore &&
+                   split.parse(full.data(), full.size(), req, consumed) == HttpParser::Result::Complete && req.body == "hello";
+    check(partial, "parser : request split across reads needs more, then completes");
+
+    string bad = "GARBAGE\r\n\r\n", chunked = "POST /book HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    HttpParser p1, p2;
+    check(p1.parse(bad.data(), bad.size(), req, consumed) == HttpParser::Result::Error &&
+          p2.parse(chunked.data(), chunked.size(), req, consumed) == HttpParser::Result::Error,
+          "parser : malformed request line and chunked bodies are rejected");
+
+    auto lengthIs = [&](const string& value) {
+        string raw = "POST /book HTTP/1.1\r\nContent-Length:" + value + "\r\n\r\nhello";
+        HttpParser fresh;
+        return fresh.parse(raw.data(), raw.size(), req, consumed);
+    };
+    check(lengthIs(" 5abc") == HttpParser::Result::Error && lengthIs("") == HttpParser::Result::Error &&
+          lengthIs(" -5") == HttpParser::Result::Error && lengthIs(" 5 ") == HttpParser::Result::Complete,
+          "parser : Content-Length must be a number and nothing else");
+
+    auto form = parseForm("userId=Jane+Doe&movieId=m%2F101%26x&note=100%25");
+    check(form["userId"] == "Jane Doe" && form["movieId"] == "m/101&x" && form["note"] == "100%",
+          "form : '+' and percent-escapes are decoded");
+    bool rejected = false;
+    try { parseForm("userId=%G1"); } catch (const invalid_argument&) { rejected = true; }
+    check(rejected, "form : a bad percent-escape is rejected");
+
+    string json;
+    appendJsonEscaped(json, "a\"b\\c\n\x01");
+    check(json == "a\\\"b\\\\c\\n\\u0001", "JSON : quotes, backslashes and control characters are escaped");
+
+    auto pipelined = bodies(exchange(port, {"POST /book HTTP/1.1\r\nContent-Length: 22\r\n\r\nuserId=u2&mov",
+                                            "ieId=m202POST /book HTTP/1.1\r\nContent-Length: 9\r\nConnection: close\r\n\r\nuserId=u3"},
+                                     false));
+    check(pipelined.size() == 2 && pipelined[0].find("booking-m202-") != string::npos &&
+          pipelined[1].find("userId and movieId are required") != string::npos,
+          "pipelining : split requests are answered in order, then Connection: close ends it");
+
+    string two = "POST /book HTTP/1.1\r\nContent-Length: 23\r\n\r\nuserId=u4&movieId=a%22b"
+                 "POST /book HTTP/1.1\r\nContent-Length: 20\r\n\r\nuserId=u5&movieId=m7";
+    auto halfClosed = bodies(exchange(port, {two}, true));
+    check(halfClosed.size() == 2 && halfClosed[0].find("booking-a\\\"b-") != string::npos &&
+          halfClosed[1].find("booking-m7-") != string::npos,
+          "half-close : buffered pipelined requests are served before the connection closes");
+
+    class FailingRepository : public ITicketRepository {
+    public:
+        string bookTicket(const string& userId, const string& movieId) override {
+            if (movieId == "down") throw runtime_error("database unavailable");
+            return "booking-" + movieId;
+        }
+    } failing;
+    BookTicketServiceDIP failingService(&failing);
+    BookTicketControllerDIP failingController(&failingService);
+    HttpServer flaky(failingController, port + 1, 1);
+    flaky.start();
+    auto afterFailure = bodies(exchange(port + 1, {"POST /book HTTP/1.1\r\nContent-Length: 22\r\n\r\nuserId=u1&movieId=down"
+                                                  "POST /book HTTP/1.1\r\nContent-Length: 20\r\n\r\nuserId=u1&movieId=m1"},
+                                       true));
+    auto nextConnection = bodies(exchange(port + 1, {"POST /book HTTP/1.1\r\nContent-Length: 20\r\n\r\nuserId=u2&movieId=m2"}, true));
+    flaky.stop();
+    check(afterFailure.size() == 2 && afterFailure[0].find("internal error") != string::npos &&
+          afterFailure[1].find("booking-m1") != string::npos && nextConnection.size() == 1,
+          "a controller exception becomes a 500 and the reactor keeps serving");
+}
+
+
+int main(int argc, char** argv) {
+    InMemoryTicketRepository repo;
+    BookTicketServiceDIP service(&repo);
+    BookTicketControllerDIP controller(&service);
+    int reactors = max(1u, thread::hardware_concurrency());
+
+    if (argc >= 3 && string(argv[1]) == "serve") {
+        HttpServer server(controller, (uint16_t)stoi(argv[2]), reactors);
+        server.start();
+        cout << "Serving POST /book on port " << argv[2] << " with " << reactors << " reactor(s)\n";
+        while (true) this_thread::sleep_for(chrono::hours(1));
+    }
+
+    const uint16_t port = 18080;
+    HttpServer server(controller, port, reactors);
+    server.start();
+
+    checks(port);
+
+    cout << "--- load test on loopback, " << reactors << " reactor(s) ---\n";
+    loadTest(port, 2, 4, 1);
+    loadTest(port, 2, 32, 1);
+    loadTest(port, 2, 32, 8);
+
+    server.stop();
+    cout << "server answered " << server.requestsServed() << " booking requests\n";
+    return 0;
+}
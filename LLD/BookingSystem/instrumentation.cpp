@@ -0,0 +1,531 @@
+/*
+
+Hot-Path Instrumentation for Controller / Service / Repository
+
+DIP/example.cpp layers a request as
+
+    BookTicketControllerDIP -> BookTicketServiceDIP -> ITicketRepository
+
+but gives no idea where the time goes. We want, per layer :
+
+> how many calls / how many errors
+> latency distribution (p50, p99, p99.9), not just an average
+> a few sampled "spans" (which thread, when, how long) to look at individual requests
+
+...without slowing the hot path down when nobody is looking.
+
+How :
+
+> INSTRUMENT_SCOPE(layer) puts a ScopedTimer on the stack.
+    - compile time : build with -DBOOKING_INSTRUMENTATION=0 and the macro is empty.
+    - run time     : Instrumentation::setEnabled(false) -> the timer does one
+                     relaxed load + one well predicted branch and nothing else.
+> Every thread has its OWN histograms and counters. Recording is a plain add to
+  memory only that thread writes -> no locks, no shared cache lines.
+  When a thread exits its slot is handed to the next new thread, which keeps adding to
+  it : totals never go backwards, and memory follows the peak number of live threads.
+> Histograms are HDR-style (log buckets split into 32 linear sub-buckets) :
+  ~3% precision from nanoseconds to minutes in a fixed 1920-bucket array.
+> Every Nth call (per thread) is written as a span into a lock-free ring buffer.
+  Old spans are overwritten; readers skip slots that are being written, and a writer
+  that finds its slot still busy (lapped on a full ring) drops its sample.
+> snapshot() merges all threads on demand and exports text or JSON,
+  to any ostream or atomically to a file (write temp + rename).
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+#ifndef BOOKING_INSTRUMENTATION
+#define BOOKING_INSTRUMENTATION 1
+#endif
+
+using Clock = chrono::steady_clock;
+
+static inline uint64_t nowNanos() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+
+//////////////////////////////////////////
+// Layers
+//////////////////////////////////////////
+
+enum class Layer { Controller, Service, Repository };
+static constexpr int kLayers = 3;
+static const char* kLayerNames[kLayers] = {"controller", "service", "repository"};
+
+
+//////////////////////////////////////////
+// HDR-style histogram
+//////////////////////////////////////////
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;                                  // 32 sub-buckets
+    static constexpr int kLinear = 1 << (kSubBits + 1);                 // exact below 64ns
+    static constexpr int kBuckets = kLinear + (64 - kSubBits - 1) * (1 << kSubBits);
+
+    static int bucketOf(uint64_t v) {
+        if (v < (uint64_t)kLinear) return (int)v;
+        int msb = 63 - countl_zero(v);
+        int sub = (v >> (msb - kSubBits)) & ((1 << kSubBits) - 1);
+        return kLinear + (msb - kSubBits - 1) * (1 << kSubBits) + sub;
+    }
+
+    static uint64_t lowerBound(int bucket) {
+        if (bucket < kLinear) return bucket;
+        int msb = (bucket - kLinear) / (1 << kSubBits) + kSubBits + 1;
+        int sub = (bucket - kLinear) % (1 << kSubBits);
+        return (1ull << msb) | ((uint64_t)sub << (msb - kSubBits));
+    }
+
+    // Written by one thread, read by the snapshot thread -> relaxed atomics, no RMW.
+    array<atomic<uint64_t>, kBuckets> counts{};
+
+    void record(uint64_t v) {
+        auto& c = counts[bucketOf(v)];
+        c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+};
+
+struct MergedHistogram {
+    vector<uint64_t> counts = vector<uint64_t>(LatencyHistogram::kBuckets);
+    uint64_t total = 0;
+
+    void add(const LatencyHistogram& h) {
+        for (int b = 0; b < LatencyHistogram::kBuckets; b++) {
+            uint64_t c = h.counts[b].load(memory_order_relaxed);
+            counts[b] += c;
+            total += c;
+        }
+    }
+
+    uint64_t percentile(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(p * total)), seen = 0;
+        for (int b = 0; b < LatencyHistogram::kBuckets; b++) {
+            seen += counts[b];
+            if (seen >= rank) return LatencyHistogram::lowerBound(b);
+        }
+        return 0;
+    }
+};
+
+
+//////////////////////////////////////////
+// Sampled spans in a lock-free ring buffer
+//////////////////////////////////////////
+
+struct Span {
+    Layer layer;
+    uint32_t threadId;
+    uint64_t startNanos;
+    uint64_t durationNanos;
+    bool error;
+};
+
+class SpanRing {
+private:
+    struct Slot {
+        atomic<uint64_t> sequence{0};      // 2*i+1 while writing entry i, 2*i+2 when done
+        atomic<uint64_t> packedLayerThreadError{0};
+        atomic<uint64_t> start{0};
+        atomic<uint64_t> duration{0};
+    };
+
+    static constexpr size_t kCapacity = 4096;
+    array<Slot, kCapacity> slots;
+    alignas(64) atomic<uint64_t> head{0};
+
+public:
+    void push(const Span& s) {
+        uint64_t i = head.fetch_add(1, memory_order_relaxed);
+        Slot& slot = slots[i % kCapacity];
+        // Claim the slot. If a writer that lapped us (or that we lapped) is still in it,
+        // drop this span : it is only a sample, and two writers must never mix fields.
+        uint64_t current = slot.sequence.load(memory_order_relaxed);
+        if ((current & 1) || current > 2 * i ||
+            !slot.sequence.compare_exchange_strong(current, 2 * i + 1, memory_order_relaxed))
+            return;
+        atomic_thread_fence(memory_order_release);     // odd sequence is visible before any field
+        slot.packedLayerThreadError.store((uint64_t)s.layer << 40 | (uint64_t)s.threadId << 1 | s.error,
+                                          memory_order_relaxed);
+        slot.start.store(s.startNanos, memory_order_relaxed);
+        slot.duration.store(s.durationNanos, memory_order_relaxed);
+        slot.sequence.store(2 * i + 2, memory_order_release);
+    }
+
+    // Most recent spans, oldest first. Slots being overwritten are skipped.
+    vector<Span> recent(size_t max) const {
+        vector<Span> out;
+        uint64_t end = head.load(memory_order_acquire);
+        uint64_t begin = end > min(max, kCapacity) ? end - min(max, kCapacity) : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const Slot& slot = slots[i % kCapacity];
+            uint64_t before = slot.sequence.load(memory_order_acquire);
+            if (before != 2 * i + 2) continue;
+            uint64_t packed = slot.packedLayerThreadError.load(memory_order_relaxed);
+            Span s{(Layer)(packed >> 40), (uint32_t)(packed >> 1), slot.start.load(memory_order_relaxed),
+                   slot.duration.load(memory_order_relaxed), (bool)(packed & 1)};
+            atomic_thread_fence(memory_order_acquire);
+            if (slot.sequence.load(memory_order_relaxed) == before) out.push_back(s);
+        }
+        return out;
+    }
+};
+
+
+//////////////////////////////////////////
+// Registry of per-thread stats
+//////////////////////////////////////////
+
+class Instrumentation {
+public:
+    struct alignas(64) ThreadStats {
+        uint32_t threadId;                   // slot number : reused once its thread exits
+        atomic<bool> inUse{true};
+        array<LatencyHistogram, kLayers> latency;
+        array<atomic<uint64_t>, kLayers> calls{};
+        array<atomic<uint64_t>, kLayers> errors{};
+        uint32_t sampleCountdown = 0;
+
+        static void bump(atomic<uint64_t>& c) { c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed); }
+    };
+
+private:
+    static inline atomic<bool> enabled{true};
+    static inline atomic<uint32_t> sampleEvery{1024};
+    static inline mutex registryLock;
+    static inline vector<unique_ptr<ThreadStats>> registry;     // one slot per live thread, at peak
+    static inline SpanRing spans;
+
+    static inline thread_local ThreadStats* mine = nullptr;
+    static inline thread_local bool exiting = false;
+
+    struct ReleaseOnExit {
+        ~ReleaseOnExit() {
+            if (mine) mine->inUse.store(false, memory_order_release);   // counts stay in the slot
+            mine = nullptr;
+            exiting = true;
+        }
+    };
+
+    static ThreadStats* claim() {
+        lock_guard<mutex> guard(registryLock);
+        for (auto& t : registry) {
+            bool expected = false;
+            if (t->inUse.compare_exchange_strong(expected, true, memory_order_acquire)) return t.get();
+        }
+        registry.push_back(make_unique<ThreadStats>());
+        registry.back()->threadId = registry.size() - 1;
+        return registry.back().get();
+    }
+
+public:
+    static bool isEnabled() { return enabled.load(memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled.store(on, memory_order_relaxed); }
+    static void setSampleEvery(uint32_t n) { sampleEvery.store(max(1u, n)); }
+
+    // nullptr once this thread's slot was released (a timer in another thread_local destructor).
+    static ThreadStats* local() {
+        if (mine) [[likely]] return mine;
+        if (exiting) return nullptr;
+        static thread_local ReleaseOnExit guard;
+        (void)guard;
+        return mine = claim();
+    }
+
+    static size_t slots() {
+        lock_guard<mutex> guard(registryLock);
+        return registry.size();
+    }
+
+    static void record(Layer layer, uint64_t start, uint64_t duration, bool error) {
+        ThreadStats* slot = local();
+        if (!slot) [[unlikely]] return;
+        ThreadStats& t = *slot;
+        int l = (int)layer;
+        t.latency[l].record(duration);
+        ThreadStats::bump(t.calls[l]);
+        if (error) ThreadStats::bump(t.errors[l]);
+        if (t.sampleCountdown-- == 0) {
+            t.sampleCountdown = sampleEvery.load(memory_order_relaxed) - 1;
+            spans.push({layer, t.threadId, start, duration, error});
+        }
+    }
+
+    struct Snapshot {
+        array<MergedHistogram, kLayers> latency;
+        array<uint64_t, kLayers> calls{}, errors{};
+        vector<Span> spans;
+    };
+
+    static Snapshot snapshot(size_t maxSpans = 20) {
+        Snapshot s;
+        lock_guard<mutex> guard(registryLock);
+        for (auto& t : registry) {
+            for (int l = 0; l < kLayers; l++) {
+                s.latency[l].add(t->latency[l]);
+                s.calls[l] += t->calls[l].load(memory_order_relaxed);
+                s.errors[l] += t->errors[l].load(memory_order_relaxed);
+            }
+        }
+        s.spans = spans.recent(maxSpans);
+        return s;
+    }
+
+    static void exportText(ostream& out, const Snapshot& s) {
+        for (int l = 0; l < kLayers; l++) {
+            out << setw(11) << left << kLayerNames[l] << " calls " << setw(9) << s.calls[l]
+                << " errors " << setw(6) << s.errors[l]
+                << " p50 " << s.latency[l].percentile(0.50) << "ns"
+                << " p99 " << s.latency[l].percentile(0.99) << "ns"
+                << " p99.9 " << s.latency[l].percentile(0.999) << "ns\n";
+        }
+        for (auto& span : s.spans) {
+            out << "  span " << kLayerNames[(int)span.layer] << " thread " << span.threadId
+                << " took " << span.durationNanos << "ns" << (span.error ? " (error)" : "") << "\n";
+        }
+    }
+
+    static void exportJson(ostream& out, const Snapshot& s) {
+        out << "{\"layers\":{";
+        for (int l = 0; l < kLayers; l++) {
+            out << (l ? "," : "") << "\"" << kLayerNames[l] << "\":{\"calls\":" << s.calls[l]
+                << ",\"errors\":" << s.errors[l]
+                << ",\"p50_ns\":" << s.latency[l].percentile(0.50)
+                << ",\"p99_ns\":" << s.latency[l].percentile(0.99)
+                << ",\"p999_ns\":" << s.latency[l].percentile(0.999) << "}";
+        }
+        out << "},\"spans\":[";
+        for (size_t i = 0; i < s.spans.size(); i++) {
+            auto& span = s.spans[i];
+            out << (i ? "," : "") << "{\"layer\":\"" << kLayerNames[(int)span.layer]
+                << "\",\"thread\":" << span.threadId << ",\"start_ns\":" << span.startNanos
+                << ",\"duration_ns\":" << span.durationNanos << ",\"error\":" << (span.error ? "true" : "false") << "}";
+        }
+        out << "]}\n";
+    }
+
+    // Readers of the file never see a half written snapshot.
+    static void writeJsonFile(const string& path) {
+        string tmp = path + ".tmp";
+        {
+            ofstream out(tmp);
+            exportJson(out, snapshot());
+        }
+        filesystem::rename(tmp, path);
+    }
+};
+
+
+//////////////////////////////////////////
+// Scoped timer + macro
+//////////////////////////////////////////
+
+class ScopedTimer {
+private:
+    Layer layer;
+    uint64_t start = 0;
+    int exceptionsOnEntry = 0;
+    bool active;
+
+public:
+    explicit ScopedTimer(Layer layer) : layer(layer), active(Instrumentation::isEnabled()) {
+        if (active) [[unlikely]] {
+            start = nowNanos();
+            exceptionsOnEntry = uncaught_exceptions();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active) [[unlikely]] {
+            Instrumentation::record(layer, start, nowNanos() - start, uncaught_exceptions() > exceptionsOnEntry);
+        }
+    }
+};
+
+#if BOOKING_INSTRUMENTATION
+#define INSTRUMENT_CONCAT2(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT2(a, b)
+#define INSTRUMENT_SCOPE(layer) ScopedTimer INSTRUMENT_CONCAT(instrumentScope_, __LINE__)(layer)
+#else
+#define INSTRUMENT_SCOPE(layer) ((void)0)
+#endif
+
+
+//////////////////////////////////////////
+// DIP layers with instrumentation
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class TicketRepositoryDIP : public ITicketRepository {
+private:
+    long nextId = 1;
+
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        INSTRUMENT_SCOPE(Layer::Repository);
+        if (movieId == "sold-out") throw runtime_error("no seats left");
+        return "booking-id-" + to_string(nextId++);
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        INSTRUMENT_SCOPE(Layer::Service);
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+class BookTicketControllerDIP {
+    BookTicketServiceDIP* service;
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        INSTRUMENT_SCOPE(Layer::Controller);
+        string userId = reqBody.at("userId");
+        string movieId = reqBody.at("movieId");
+        try {
+            string bookingId = service->execute(userId, movieId);
+            return {{"success", "true"}, {"bookingId", bookingId}};
+        } catch (const runtime_error& e) {
+            return {{"success", "false"}, {"error", e.what()}};
+        }
+    }
+};
+
+
+//////////////////////////////////////////
+// Benchmark : cost of a disabled / enabled timer
+//////////////////////////////////////////
+
+__attribute__((noinline)) long plainWork(long x) { return x * 2654435761u >> 7; }
+
+__attribute__((noinline)) long instrumentedWork(long x) {
+    INSTRUMENT_SCOPE(Layer::Repository);
+    return x * 2654435761u >> 7;
+}
+
+template <typename Fn>
+double nsPerCall(int n, Fn fn) {
+    long sink = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < n; i++) sink += fn(i);
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count() / n;
+    if (sink == 42) cout << "";
+    return ns;
+}
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+// Writers push spans whose fields are all derived from one number; any span a reader gets
+// back with fields that disagree was torn.
+void spanRingStress() {
+    static SpanRing ring;
+    atomic<bool> stop{false};
+    atomic<uint64_t> seen{0}, torn{0};
+
+    vector<thread> readers;
+    for (int r = 0; r < 2; r++) {
+        readers.emplace_back([&] {
+            while (!stop.load(memory_order_relaxed)) {
+                for (const Span& s : ring.recent(4096)) {
+                    uint64_t k = s.startNanos;
+                    bool ok = s.durationNanos == k * 3 + 1 && s.threadId == (uint32_t)(k % 100003) &&
+                              s.layer == (Layer)(k % kLayers) && s.error == (k % 7 == 0);
+                    torn.fetch_add(!ok, memory_order_relaxed);
+                    seen.fetch_add(1, memory_order_relaxed);
+                }
+                this_thread::yield();
+            }
+        });
+    }
+    vector<thread> writers;
+    for (int w = 0; w < 4; w++) {
+        writers.emplace_back([&, w] {
+            for (uint64_t n = 0; n < 300000; n++) {
+                uint64_t k = n * 4 + w;
+                ring.push({(Layer)(k % kLayers), (uint32_t)(k % 100003), k, k * 3 + 1, k % 7 == 0});
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+    stop = true;
+    for (auto& r : readers) r.join();
+    check(seen > 0 && torn == 0, "span ring under 4 writers + 2 readers returns no torn spans (" +
+                                 to_string(seen.load()) + " read)");
+}
+
+// Short-lived threads one after another : each reuses the slot the previous one left.
+void threadChurn() {
+    uint64_t before = Instrumentation::snapshot(0).calls[(int)Layer::Service];
+    size_t slotsBefore = Instrumentation::slots();
+    for (int t = 0; t < 200; t++) {
+        thread([] { for (int i = 0; i < 10; i++) { INSTRUMENT_SCOPE(Layer::Service); } }).join();
+    }
+    uint64_t counted = Instrumentation::snapshot(0).calls[(int)Layer::Service] - before;
+    check(counted == 2000 && Instrumentation::slots() <= slotsBefore + 1,
+          "200 exited threads share one stats slot and none of their counts are lost");
+}
+
+int main() {
+    spanRingStress();
+    threadChurn();
+
+    TicketRepositoryDIP repo;
+    BookTicketServiceDIP service(&repo);
+    BookTicketControllerDIP controller(&service);
+
+    vector<thread> clients;
+    for (int t = 0; t < 4; t++) {
+        clients.emplace_back([&, t] {
+            for (int i = 0; i < 100000; i++) {
+                string movie = i % 997 == 0 ? "sold-out" : "m" + to_string(i % 50);
+                controller.handleRequest({{"userId", "u" + to_string(t)}, {"movieId", movie}});
+            }
+        });
+    }
+    for (auto& c : clients) c.join();
+
+    auto snap = Instrumentation::snapshot(5);
+    Instrumentation::exportText(cout, snap);
+    cout << "\n";
+    Instrumentation::exportJson(cout, Instrumentation::snapshot(2));
+    string path = (filesystem::temp_directory_path() / "booking_metrics.json").string();
+    Instrumentation::writeJsonFile(path);
+    cout << "snapshot written to " << path << "\n";
+
+    cout << "\n--- overhead per instrumented call ---\n";
+    const int N = 20000000;
+    double base = nsPerCall(N, plainWork);
+    Instrumentation::setEnabled(false);
+    double disabled = nsPerCall(N, instrumentedWork);
+    Instrumentation::setEnabled(true);
+    double enabled = nsPerCall(N, instrumentedWork);
+    cout << "no instrumentation  : " << fixed << setprecision(2) << base << " ns/call\n"
+         << "runtime disabled    : " << disabled << " ns/call (+" << disabled - base << ")\n"
+         << "enabled             : " << enabled << " ns/call (+" << enabled - base << ")\n"
+         << "(built with -DBOOKING_INSTRUMENTATION=0 the macro is empty, same as the first row)\n";
+
+    return 0;
+}
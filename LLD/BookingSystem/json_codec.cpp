@@ -0,0 +1,548 @@
+/*
+
+SIMD JSON Codec for Booking Requests / Responses
+
+BookTicketControllerDIP::handleRequest (DIP/example.cpp) takes and returns
+map<string, string>. Clients send JSON, so every request is :
+
+    bytes  ->  general JSON parser builds a DOM (maps, vectors, strings)  ->  copy into map
+           ->  handleRequest  ->  map  ->  string concatenation  ->  bytes
+
+At high request rates the parsing dominates CPU, and almost all of the DOM is thrown away.
+
+This codec only knows the booking schema :
+
+    {"userId":"u1","movieId":"m101","seatNumber":"H12","quantity":2, ...anything else...}
+
+Stage 1 : structural scan, 64 bytes at a time with SSE2
+    compare 16 bytes at once against  "  \  {  }  [  ]  :  ,  -> one bit per byte
+    > backslash runs of odd length escape the next character (bit tricks, no loop per byte)
+    > prefix-XOR of the real quote bits = "inside a string" mask
+    > structural characters outside strings + quotes -> list of positions
+
+Stage 2 : walk the positions with the schema in mind
+    > a known key writes its value DIRECTLY into BookingRequestFields (no DOM)
+    > unknown keys (objects, arrays, numbers ...) are skipped by position only
+
+Responses are written straight into one output buffer.
+
+Falls back to a scalar stage 1 when SSE2 is not available.
+
+*/
+
+#include<bits/stdc++.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Booking schema + controller
+//////////////////////////////////////////
+
+struct BookingRequestFields {
+    string userId;
+    string movieId;
+    string seatNumber;
+    int quantity = 1;
+
+    void clear() {
+        userId.clear();
+        movieId.clear();
+        seatNumber.clear();
+        quantity = 1;
+    }
+};
+
+struct BookingResponse {
+    bool success = false;
+    string bookingId;
+};
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class InMemoryTicketRepository : public ITicketRepository {
+private:
+    long nextId = 1;
+
+public:
+    string bookTicket(const string& userId, const string& movieId) override {
+        return "booking-" + to_string(nextId++);
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+class BookTicketControllerDIP {
+    BookTicketServiceDIP* service;
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    // original map-based entry point
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        string userId = reqBody.at("userId");
+        string movieId = reqBody.at("movieId");
+        string bookingId = service->execute(userId, movieId);
+
+        return {
+            {"success", "true"},
+            {"bookingId", bookingId}
+        };
+    }
+
+    // typed entry point used by the JSON codec
+    BookingResponse handleRequest(const BookingRequestFields& req) {
+        if (req.userId.empty() || req.movieId.empty()) throw invalid_argument("userId and movieId are required");
+        return {true, service->execute(req.userId, req.movieId)};
+    }
+};
+
+
+//////////////////////////////////////////
+// Stage 1 : structural index
+//////////////////////////////////////////
+
+namespace stage1 {
+
+struct Masks {
+    uint64_t quote = 0, backslash = 0, op = 0;
+};
+
+#ifdef __SSE2__
+inline uint64_t eq16(__m128i v, char c) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+inline Masks classify(const char* p) {
+    Masks m;
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        int shift = 16 * i;
+        m.quote |= eq16(v, '"') << shift;
+        m.backslash |= eq16(v, '\\') << shift;
+        uint64_t brackets = eq16(v, '{') | eq16(v, '}') | eq16(v, '[') | eq16(v, ']');
+        m.op |= (brackets | eq16(v, ':') | eq16(v, ',')) << shift;
+    }
+    return m;
+}
+#else
+inline Masks classify(const char* p) {
+    Masks m;
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = 1ull << i;
+        char c = p[i];
+        if (c == '"') m.quote |= bit;
+        else if (c == '\\') m.backslash |= bit;
+        else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') m.op |= bit;
+    }
+    return m;
+}
+#endif
+
+// Bits of characters escaped by an odd-length run of backslashes.
+inline uint64_t escapedChars(uint64_t bs, uint64_t& prevEndsOdd) {
+    const uint64_t evenBits = 0x5555555555555555ull, oddBits = ~evenBits;
+    uint64_t startEdges = bs & ~(bs << 1);
+    uint64_t evenStartMask = evenBits ^ prevEndsOdd;
+    uint64_t evenStarts = startEdges & evenStartMask;
+    uint64_t oddStarts = startEdges & ~evenStartMask;
+    uint64_t evenCarries = bs + evenStarts;
+    uint64_t oddCarries;
+    bool endsOdd = __builtin_add_overflow(bs, oddStarts, &oddCarries);
+    oddCarries |= prevEndsOdd;
+    prevEndsOdd = endsOdd ? 1 : 0;
+    uint64_t evenCarryEnds = evenCarries & ~bs;
+    uint64_t oddCarryEnds = oddCarries & ~bs;
+    return (evenCarryEnds & oddBits) | (oddCarryEnds & evenBits);
+}
+
+// bit i = XOR of bits 0..i  ->  1 between an opening and a closing quote
+inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Fills `index` with the positions of quotes and of {}[]:, outside strings.
+// Returns false if a string is left open.
+inline bool buildIndex(string_view json, vector<uint32_t>& index) {
+    index.clear();
+    uint64_t prevEndsOdd = 0, prevInString = 0;
+    char tail[64];
+    for (size_t base = 0; base < json.size(); base += 64) {
+        const char* p = json.data() + base;
+        if (json.size() - base < 64) {
+            memset(tail, ' ', 64);
+            memcpy(tail, p, json.size() - base);
+            p = tail;
+        }
+        Masks m = classify(p);
+        uint64_t quotes = m.quote & ~escapedChars(m.backslash, prevEndsOdd);
+        uint64_t inString = prefixXor(quotes) ^ prevInString;
+        prevInString = (uint64_t)((int64_t)inString >> 63);
+        uint64_t structural = (m.op & ~inString) | quotes;
+        for (; structural; structural &= structural - 1) {
+            index.push_back(base + countr_zero(structural));
+        }
+    }
+    return prevInString == 0;
+}
+
+} // namespace stage1
+
+
+//////////////////////////////////////////
+// Stage 2 : schema-directed decode
+//////////////////////////////////////////
+
+class BookingJsonCodec {
+private:
+    vector<uint32_t> index;          // reused between requests
+
+    static void appendUtf8(string& out, uint32_t cp) {
+        if (cp < 0x80) out += (char)cp;
+        else if (cp < 0x800) { out += (char)(0xC0 | cp >> 6); out += (char)(0x80 | (cp & 0x3F)); }
+        else if (cp < 0x10000) {
+            out += (char)(0xE0 | cp >> 12); out += (char)(0x80 | (cp >> 6 & 0x3F)); out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | cp >> 18); out += (char)(0x80 | (cp >> 12 & 0x3F));
+            out += (char)(0x80 | (cp >> 6 & 0x3F)); out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    static uint32_t hex4(string_view s, size_t i) {
+        if (i + 4 > s.size()) throw invalid_argument("bad json: short \\u escape");
+        uint32_t v = 0;
+        for (size_t k = i; k < i + 4; k++) {
+            char c = s[k];
+            v <<= 4;
+            if (c >= '0' && c <= '9') v |= c - '0';
+            else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+            else throw invalid_argument("bad json: bad \\u escape");
+        }
+        return v;
+    }
+
+    // Raw string contents (between the quotes) -> out. Fast path when there is no escape.
+    static void decodeString(string_view raw, string& out) {
+        size_t slash = raw.find('\\');
+        if (slash == string_view::npos) {
+            out.assign(raw);
+            return;
+        }
+        out.assign(raw.substr(0, slash));
+        for (size_t i = slash; i < raw.size(); i++) {
+            char c = raw[i];
+            if (c != '\\') { out += c; continue; }
+            if (++i >= raw.size()) throw invalid_argument("bad json: dangling escape");
+            switch (raw[i]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = hex4(raw, i + 1);
+                    i += 4;
+                    if (cp >= 0xD800 && cp < 0xDC00 && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                        uint32_t low = hex4(raw, i + 3);
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            i += 6;
+                        }
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default: throw invalid_argument("bad json: unknown escape");
+            }
+        }
+    }
+
+    static string_view trim(string_view s) {
+        while (!s.empty() && isspace((unsigned char)s.front())) s.remove_prefix(1);
+        while (!s.empty() && isspace((unsigned char)s.back())) s.remove_suffix(1);
+        return s;
+    }
+
+public:
+    // Parses a booking request straight into `out`. Throws invalid_argument on bad input.
+    void decode(string_view json, BookingRequestFields& out) {
+        out.clear();
+        if (!stage1::buildIndex(json, index)) throw invalid_argument("bad json: unterminated string");
+        size_t n = index.size(), i = 0;
+        auto at = [&](size_t k) -> char {
+            if (k >= n) throw invalid_argument("bad json: unexpected end");
+            return json[index[k]];
+        };
+
+        if (at(i++) != '{') throw invalid_argument("bad json: expected object");
+        if (at(i) == '}') return;
+
+        string key;
+        while (true) {
+            if (at(i) != '"' || at(i + 1) != '"') throw invalid_argument("bad json: expected key");
+            string_view rawKey = json.substr(index[i] + 1, index[i + 1] - index[i] - 1);
+            i += 2;
+            if (at(i++) != ':') throw invalid_argument("bad json: expected ':'");
+
+            string* target = nullptr;
+            if (rawKey == "userId") target = &out.userId;
+            else if (rawKey == "movieId") target = &out.movieId;
+            else if (rawKey == "seatNumber") target = &out.seatNumber;
+
+            char c = at(i);
+            if (c == '"') {
+                string_view raw = json.substr(index[i] + 1, index[i + 1] - index[i] - 1);
+                if (target) decodeString(raw, *target);
+                i += 2;
+            } else if (c == '{' || c == '[') {
+                // skip nested value by depth; quotes are always in pairs
+                int depth = 0;
+                do {
+                    char d = at(i++);
+                    if (d == '{' || d == '[') depth++;
+                    else if (d == '}' || d == ']') depth--;
+                } while (depth > 0);
+            } else {
+                // number / true / false / null : the text up to the next ',' or '}'
+                string_view scalar = trim(json.substr(index[i - 1] + 1, index[i] - index[i - 1] - 1));
+                if (scalar.empty()) throw invalid_argument("bad json: missing value");
+                if (rawKey == "quantity") {
+                    auto [p, ec] = from_chars(scalar.data(), scalar.data() + scalar.size(), out.quantity);
+                    if (ec != errc() || p != scalar.data() + scalar.size()) throw invalid_argument("bad json: quantity");
+                } else if (target) {
+                    throw invalid_argument("bad json: " + string(rawKey) + " must be a string");
+                }
+            }
+
+            char sep = at(i++);
+            if (sep == '}') break;
+            if (sep != ',') throw invalid_argument("bad json: expected ',' or '}'");
+        }
+        if (i != n) throw invalid_argument("bad json: trailing characters");
+    }
+
+    static void appendEscaped(string& out, string_view s) {
+        size_t start = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = s[i];
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(s.substr(start, i - start));
+            char buf[8];
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf;
+            }
+            start = i + 1;
+        }
+        out.append(s.substr(start));
+    }
+
+    // Appends the response JSON to out (no temporary strings).
+    static void encode(const BookingResponse& r, string& out) {
+        out += r.success ? "{\"success\":true,\"bookingId\":\"" : "{\"success\":false,\"bookingId\":\"";
+        appendEscaped(out, r.bookingId);
+        out += "\"}";
+    }
+};
+
+
+//////////////////////////////////////////
+// Naive baseline : general DOM parser
+//////////////////////////////////////////
+
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+    bool boolean = false;
+    double number = 0;
+    string str;
+    vector<JsonValue> array;
+    map<string, JsonValue> object;
+};
+
+class NaiveJsonParser {
+private:
+    string_view s;
+    size_t pos = 0;
+
+    void ws() { while (pos < s.size() && isspace((unsigned char)s[pos])) pos++; }
+
+    char peek() {
+        ws();
+        if (pos >= s.size()) throw invalid_argument("unexpected end");
+        return s[pos];
+    }
+
+    string parseString() {
+        string out;
+        pos++;                                   // opening quote
+        while (pos < s.size() && s[pos] != '"') {
+            if (s[pos] == '\\') {
+                pos++;
+                char e = s[pos];
+                if (e == 'n') out += '\n';
+                else if (e == 't') out += '\t';
+                else if (e == 'u') { out += '?'; pos += 4; }
+                else out += e;
+            } else {
+                out += s[pos];
+            }
+            pos++;
+        }
+        pos++;                                   // closing quote
+        return out;
+    }
+
+    JsonValue parseValue() {
+        JsonValue v;
+        char c = peek();
+        if (c == '{') {
+            v.type = JsonValue::Object;
+            pos++;
+            if (peek() == '}') { pos++; return v; }
+            while (true) {
+                string key = (peek(), parseString());
+                peek(); pos++;                   // ':'
+                v.object[key] = parseValue();
+                char sep = peek(); pos++;
+                if (sep == '}') break;
+            }
+        } else if (c == '[') {
+            v.type = JsonValue::Array;
+            pos++;
+            if (peek() == ']') { pos++; return v; }
+            while (true) {
+                v.array.push_back(parseValue());
+                char sep = peek(); pos++;
+                if (sep == ']') break;
+            }
+        } else if (c == '"') {
+            v.type = JsonValue::String;
+            v.str = parseString();
+        } else if (s.substr(pos, 4) == "true") { v.type = JsonValue::Bool; v.boolean = true; pos += 4; }
+        else if (s.substr(pos, 5) == "false") { v.type = JsonValue::Bool; pos += 5; }
+        else if (s.substr(pos, 4) == "null") { pos += 4; }
+        else {
+            size_t end = pos;
+            while (end < s.size() && (isdigit((unsigned char)s[end]) || strchr("+-.eE", s[end]))) end++;
+            v.type = JsonValue::Number;
+            v.number = stod(string(s.substr(pos, end - pos)));
+            pos = end;
+        }
+        return v;
+    }
+
+public:
+    JsonValue parse(string_view json) {
+        s = json;
+        pos = 0;
+        return parseValue();
+    }
+};
+
+// What a typical handler does today : DOM -> map<string,string> -> handleRequest -> concat.
+string naiveHandle(BookTicketControllerDIP& controller, string_view json) {
+    JsonValue doc = NaiveJsonParser().parse(json);
+    map<string, string> req;
+    for (auto& [k, v] : doc.object) if (v.type == JsonValue::String) req[k] = v.str;
+    auto resp = controller.handleRequest(req);
+    return "{\"success\":" + resp["success"] + ",\"bookingId\":\"" + resp["bookingId"] + "\"}";
+}
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+int main() {
+    InMemoryTicketRepository repo;
+    BookTicketServiceDIP service(&repo);
+    BookTicketControllerDIP controller(&service);
+    BookingJsonCodec codec;
+    BookingRequestFields fields;
+    string out;
+
+    string small = R"({"userId":"u2","movieId":"m202"})";
+    string realistic = R"({
+        "userId": "u-8f3a2c91", "movieId": "m101", "seatNumber": "H12", "quantity": 2,
+        "client": {"app": "ios", "version": "5.2.1", "locale": "en-IN", "features": ["dark", "upi"]},
+        "promoCodes": ["DIWALI", "FIRST50"],
+        "note": "near the aisle \"please\" \\ thanks ₹",
+        "requestedAt": "2024-11-02T18:30:00+05:30", "retry": false, "session": null
+    })";
+
+    codec.decode(realistic, fields);
+    check(fields.userId == "u-8f3a2c91" && fields.movieId == "m101" && fields.seatNumber == "H12"
+          && fields.quantity == 2, "realistic payload decodes into the booking fields");
+
+    codec.decode(R"({"note":"a \\\" b } { ,", "userId":"u\"1\\", "movieId":"m1"})", fields);
+    check(fields.userId == "u\"1\\" && fields.movieId == "m1", "escaped quotes and backslashes are handled");
+
+    bool rejected = false;
+    try { codec.decode(R"({"userId":"u1","movieId":)", fields); } catch (const invalid_argument&) { rejected = true; }
+    check(rejected, "truncated JSON is rejected");
+
+    codec.decode(small, fields);
+    out.clear();
+    BookingJsonCodec::encode(controller.handleRequest(fields), out);
+    cout << "response : " << out << "\n";
+
+    cout << "\n--- decode + handle + encode ---\n";
+    for (auto& [label, payload] : vector<pair<string, string>>{{"small", small}, {"realistic", realistic}}) {
+        const int N = 500000;
+        size_t sink = 0;
+
+        auto start = Clock::now();
+        for (int i = 0; i < N; i++) {
+            codec.decode(payload, fields);
+            out.clear();
+            BookingJsonCodec::encode(controller.handleRequest(fields), out);
+            sink += out.size();
+        }
+        double fast = chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        for (int i = 0; i < N; i++) sink += naiveHandle(controller, payload).size();
+        double naive = chrono::duration<double>(Clock::now() - start).count();
+
+        cout << setw(9) << left << label << " (" << payload.size() << " bytes) : codec "
+             << (long)(N / fast) << " req/s (" << (long)(N * payload.size() / fast / 1e6) << " MB/s), naive "
+             << (long)(N / naive) << " req/s (" << (long)(N * payload.size() / naive / 1e6) << " MB/s)"
+             << "  [" << sink % 7 << "]\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,611 @@
+/*
+
+Deterministic Workload Generator + Load Test Harness
+
+Problem :
+    The only way to exercise Ticketbooking (SOLID/SRP) or BookTicketControllerDIP
+    (SOLID/DIP) is the toy main() of each example : one request, no load, no numbers.
+
+Solution :
+
+    WorkloadSpec (seed, rates, bursts ...)
+        -> WorkloadGenerator : the same seed always gives the same request stream
+               > show popularity is Zipfian (a few blockbusters, a long tail)
+               > flash sales : the arrival rate jumps for a while, mostly for one show
+               > some payments fail, some bookings are cancelled later
+        -> Trace (can be saved to a file and replayed byte for byte)
+        -> LoadDriver : OPEN loop. Every request has an intended start time and is sent
+           at that time whether or not earlier ones have finished, like real users.
+           A Cancel waits for the outcome of its Book and only undoes it if that
+           booking succeeded and was not cancelled yet; otherwise it is a no-op.
+        -> Report : throughput + latency percentiles
+
+Coordinated omission :
+    A closed-loop tester waits for a slow response before sending the next request, so
+    while the system is stuck it simply stops measuring. Here latency is counted from the
+    INTENDED start time, so time spent waiting behind a stall is included.
+    Both numbers are printed to show the difference.
+
+Determinism : no std:: distributions (their output differs between standard libraries).
+All randomness is SplitMix64 + our own conversions.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Deterministic randomness
+//////////////////////////////////////////
+
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }                  // [0, 1)
+    double exponential(double rate) { return -log1p(-uniform()) / rate; }
+    bool chance(double p) { return uniform() < p; }
+};
+
+class ZipfSampler {
+private:
+    vector<double> cdf;
+
+public:
+    ZipfSampler(int n, double s) : cdf(n) {
+        double sum = 0;
+        for (int k = 1; k <= n; k++) cdf[k - 1] = (sum += 1.0 / pow(k, s));
+        for (auto& c : cdf) c /= sum;
+    }
+
+    int sample(SplitMix64& rng) const {          // rank 0 = most popular
+        return min<int>(cdf.size() - 1, lower_bound(cdf.begin(), cdf.end(), rng.uniform()) - cdf.begin());
+    }
+};
+
+
+//////////////////////////////////////////
+// Workload
+//////////////////////////////////////////
+
+struct FlashSale {
+    double atSec, durationSec;
+    double rateMultiplier;
+    int showRank;                 // which show the extra traffic is for
+    double focus;                 // share of requests in the burst that go to that show
+};
+
+struct WorkloadSpec {
+    uint64_t seed = 1;
+    double durationSec = 3;
+    double baseRate = 5000;       // requests per second
+    int shows = 500;
+    double zipfS = 1.1;
+    int users = 100000;
+    double paymentFailureRate = 0.02;
+    double cancelRate = 0.05;
+    vector<FlashSale> flashSales;
+};
+
+enum class Kind : uint8_t { Book, Cancel };
+
+struct Request {
+    int64_t atNanos;              // intended start, from the beginning of the run
+    Kind kind;
+    int user;
+    int show;
+    bool paymentFails;
+    int64_t cancels;              // Cancel : index of the Book request it undoes
+};
+
+class WorkloadGenerator {
+private:
+    WorkloadSpec spec;
+
+    double rateAt(double t) const {
+        double rate = spec.baseRate;
+        for (auto& f : spec.flashSales) {
+            if (t >= f.atSec && t < f.atSec + f.durationSec) rate = max(rate, spec.baseRate * f.rateMultiplier);
+        }
+        return rate;
+    }
+
+    const FlashSale* saleAt(double t) const {
+        for (auto& f : spec.flashSales) {
+            if (t >= f.atSec && t < f.atSec + f.durationSec) return &f;
+        }
+        return nullptr;
+    }
+
+public:
+    explicit WorkloadGenerator(WorkloadSpec spec) : spec(move(spec)) {}
+
+    // Non-homogeneous Poisson arrivals by thinning : draw at the peak rate, keep with rate(t)/peak.
+    vector<Request> generate() const {
+        SplitMix64 rng(spec.seed);
+        ZipfSampler popularity(spec.shows, spec.zipfS);
+        double peak = spec.baseRate;
+        for (auto& f : spec.flashSales) peak = max(peak, spec.baseRate * f.rateMultiplier);
+
+        vector<Request> out;
+        vector<int64_t> booked;
+        for (double t = rng.exponential(peak); t < spec.durationSec; t += rng.exponential(peak)) {
+            if (!rng.chance(rateAt(t) / peak)) continue;
+            int64_t at = (int64_t)(t * 1e9);
+            if (!booked.empty() && rng.chance(spec.cancelRate)) {
+                size_t pick = rng.next() % booked.size();
+                int64_t target = booked[pick];
+                booked[pick] = booked.back();              // each booking is cancelled at most once
+                booked.pop_back();
+                out.push_back({at, Kind::Cancel, out[target].user, out[target].show, false, target});
+                continue;
+            }
+            const FlashSale* sale = saleAt(t);
+            int show = sale && rng.chance(sale->focus) ? sale->showRank : popularity.sample(rng);
+            int user = rng.next() % spec.users;
+            bool fails = rng.chance(spec.paymentFailureRate);
+            booked.push_back(out.size());
+            out.push_back({at, Kind::Book, user, show, fails, -1});
+        }
+        return out;
+    }
+};
+
+// Trace file : one request per line.
+void saveTrace(const vector<Request>& trace, const string& path) {
+    ofstream out(path);
+    for (auto& r : trace) {
+        out << r.atNanos << ',' << (r.kind == Kind::Book ? 'B' : 'C') << ',' << r.user << ',' << r.show << ','
+            << r.paymentFails << ',' << r.cancels << '\n';
+    }
+    if (!out) throw runtime_error("cannot write trace " + path);
+}
+
+// A replayed file is not trusted : the driver indexes the inventory by show and makes a
+// Cancel wait for its Book, so a bad show or a Cancel pointing anywhere but back at an
+// earlier Book would crash or hang the run. Such lines are rejected here.
+vector<Request> loadTrace(const string& path, int shows) {
+    ifstream in(path);
+    if (!in) throw runtime_error("cannot open trace " + path);
+    vector<Request> trace;
+    string line;
+    while (getline(in, line)) {
+        Request r{};
+        char kind;
+        int fails, used = 0;
+        if (sscanf(line.c_str(), "%" SCNd64 ",%c,%d,%d,%d,%" SCNd64 "%n", &r.atNanos, &kind, &r.user, &r.show, &fails,
+                   &r.cancels, &used) != 6 || used != (int)line.size()) {
+            throw runtime_error("bad trace line : " + line);
+        }
+        if (r.atNanos < 0 || r.user < 0 || r.show < 0 || r.show >= shows || (fails != 0 && fails != 1)) {
+            throw runtime_error("trace line out of range : " + line);
+        }
+        if (kind == 'B') {
+            if (r.cancels != -1) throw runtime_error("a booking cannot cancel anything : " + line);
+            r.kind = Kind::Book;
+        } else if (kind == 'C') {
+            if (r.cancels < 0 || r.cancels >= (int64_t)trace.size() || trace[r.cancels].kind != Kind::Book ||
+                trace[r.cancels].show != r.show) {
+                throw runtime_error("a cancel must point at an earlier booking of the same show : " + line);
+            }
+            r.kind = Kind::Cancel;
+        } else {
+            throw runtime_error("unknown request kind : " + line);
+        }
+        r.paymentFails = fails;
+        trace.push_back(r);
+    }
+    return trace;
+}
+
+uint64_t fingerprint(const vector<Request>& trace) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+    for (auto& r : trace) { mix(r.atNanos); mix((uint64_t)r.kind); mix(r.user); mix(r.show); mix(r.paymentFails); mix(r.cancels); }
+    return h;
+}
+
+
+//////////////////////////////////////////
+// System under test : the SRP and DIP stacks
+//////////////////////////////////////////
+
+// Fault injection : the payment service reads the request being driven on this thread.
+thread_local const Request* currentRequest = nullptr;
+
+static void work(chrono::nanoseconds cost) {
+    auto until = Clock::now() + cost;
+    while (Clock::now() < until) {}
+}
+
+class Inventory {
+private:
+    mutex lock;
+    vector<int> sold;
+    int capacity;
+    chrono::nanoseconds writeCost;
+
+public:
+    Inventory(int shows, int capacity, chrono::nanoseconds writeCost) : sold(shows, 0), capacity(capacity), writeCost(writeCost) {}
+
+    bool reserve(int show) {
+        lock_guard<mutex> guard(lock);
+        work(writeCost);
+        if (sold[show] >= capacity) return false;
+        sold[show]++;
+        return true;
+    }
+
+    void release(int show) {
+        lock_guard<mutex> guard(lock);
+        if (sold[show] > 0) sold[show]--;
+    }
+};
+
+// --- SRP stack (SOLID/SRP/theory.cpp) ---
+
+class SeatChecker {
+    Inventory& inventory;
+public:
+    SeatChecker(Inventory& inventory) : inventory(inventory) {}
+    bool isSeatAvailable(int movieId, string seatNumber) { return inventory.reserve(movieId); }
+};
+
+class PriceCalculator {
+public:
+    int getPrice(int movieId, string seatNumber) { return 100 + movieId % 50; }
+};
+
+class PaymentService {
+public:
+    bool processPayment(int userId, int amount) {
+        work(chrono::microseconds(10));                         // gateway round trip
+        return !(currentRequest && currentRequest->paymentFails);
+    }
+};
+
+class NotificationService {
+public:
+    void sendConfirmation(int userId, int movieId) {}
+};
+
+class Ticketbooking {
+private:
+    SeatChecker& seatchecker;
+    PriceCalculator& pricecalculator;
+    PaymentService& paymentservice;
+    NotificationService& notificationservice;
+    Inventory& inventory;
+
+public:
+    Ticketbooking(SeatChecker& seatchecker, PriceCalculator& pricecalculator, PaymentService& paymentservice,
+                  NotificationService& notificationservice, Inventory& inventory)
+        : seatchecker(seatchecker), pricecalculator(pricecalculator), paymentservice(paymentservice),
+          notificationservice(notificationservice), inventory(inventory) {}
+
+    // Returns "ok", "sold_out" or "payment_failed" instead of printing.
+    string bookTicket(int userId, int movieId, const string& seatNumber) {
+        if (!seatchecker.isSeatAvailable(movieId, seatNumber)) return "sold_out";
+        int price = pricecalculator.getPrice(movieId, seatNumber);
+        if (!paymentservice.processPayment(userId, price)) {
+            inventory.release(movieId);
+            return "payment_failed";
+        }
+        notificationservice.sendConfirmation(userId, movieId);
+        return "ok";
+    }
+};
+
+// --- DIP stack (SOLID/DIP/example.cpp) ---
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class InventoryRepository : public ITicketRepository {
+    Inventory& inventory;
+    PaymentService& payments;
+public:
+    InventoryRepository(Inventory& inventory, PaymentService& payments) : inventory(inventory), payments(payments) {}
+
+    string bookTicket(const string& userId, const string& movieId) override {
+        int show = stoi(movieId.substr(1));
+        if (!inventory.reserve(show)) throw runtime_error("sold_out");
+        if (!payments.processPayment(stoi(userId.substr(1)), 100)) {
+            inventory.release(show);
+            throw runtime_error("payment_failed");
+        }
+        return movieId + "-" + userId;
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+class BookTicketControllerDIP {
+    BookTicketServiceDIP* service;
+public:
+    BookTicketControllerDIP(BookTicketServiceDIP* srv) : service(srv) {}
+
+    map<string, string> handleRequest(const map<string, string>& reqBody) {
+        try {
+            string bookingId = service->execute(reqBody.at("userId"), reqBody.at("movieId"));
+            return {{"success", "true"}, {"bookingId", bookingId}};
+        } catch (const runtime_error& e) {
+            return {{"success", "false"}, {"error", e.what()}};
+        }
+    }
+};
+
+// What the driver talks to.
+class LoadTarget {
+public:
+    virtual string book(const Request& r) = 0;             // returns an outcome label
+    virtual void cancel(const Request& r) = 0;
+    virtual ~LoadTarget() = default;
+};
+
+class TicketbookingTarget : public LoadTarget {
+    Inventory inventory;
+    SeatChecker seats{inventory};
+    PriceCalculator prices;
+    PaymentService payments;
+    NotificationService notifications;
+    Ticketbooking booking{seats, prices, payments, notifications, inventory};
+public:
+    TicketbookingTarget(int shows, int capacity, chrono::nanoseconds writeCost) : inventory(shows, capacity, writeCost) {}
+    string book(const Request& r) override { return booking.bookTicket(r.user, r.show, "A1"); }
+    void cancel(const Request& r) override { inventory.release(r.show); }
+};
+
+class ControllerTarget : public LoadTarget {
+    Inventory inventory;
+    PaymentService payments;
+    InventoryRepository repo{inventory, payments};
+    BookTicketServiceDIP service{&repo};
+    BookTicketControllerDIP controller{&service};
+public:
+    ControllerTarget(int shows, int capacity, chrono::nanoseconds writeCost) : inventory(shows, capacity, writeCost) {}
+    string book(const Request& r) override {
+        auto response = controller.handleRequest({{"userId", "u" + to_string(r.user)}, {"movieId", "m" + to_string(r.show)}});
+        return response["success"] == "true" ? "ok" : response["error"];
+    }
+    void cancel(const Request& r) override { inventory.release(r.show); }
+};
+
+
+//////////////////////////////////////////
+// Open-loop driver + report
+//////////////////////////////////////////
+
+struct LoadReport {
+    double seconds = 0;
+    map<string, long> outcomes;
+    vector<int64_t> correctedNanos;     // completion - intended start
+    vector<int64_t> serviceNanos;       // completion - actual start (what a closed loop would see)
+
+    static int64_t pct(vector<int64_t>& v, double p) {
+        if (v.empty()) return 0;
+        size_t k = min(v.size() - 1, (size_t)(p * v.size()));
+        nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+
+    void print(const string& label) {
+        long total = correctedNanos.size();
+        cout << label << " : " << total << " requests in " << fixed << setprecision(2) << seconds << "s = "
+             << (long)(total / seconds) << " req/s  [";
+        for (auto& [k, v] : outcomes) cout << " " << k << "=" << v;
+        cout << " ]\n";
+        for (auto* v : {&correctedNanos, &serviceNanos}) {
+            cout << (v == &correctedNanos ? "    corrected (from intended start) " : "    uncorrected (from actual start) ");
+            for (auto [name, p] : {pair{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p99.9", 0.999}}) {
+                cout << " " << name << " " << setprecision(0) << pct(*v, p) / 1e3 << "us";
+            }
+            cout << "  max " << *max_element(v->begin(), v->end()) / 1e3 << "us\n";
+        }
+    }
+};
+
+// Book outcome as seen by later Cancels.
+enum BookState : uint8_t { Pending, Booked, NotBooked, Cancelled };
+
+LoadReport drive(LoadTarget& target, const vector<Request>& trace, int workers) {
+    LoadReport report;
+    vector<int64_t> corrected(trace.size()), service(trace.size());
+    vector<string> outcome(trace.size());
+    unique_ptr<atomic<uint8_t>[]> state(new atomic<uint8_t>[trace.size()]);
+    for (size_t i = 0; i < trace.size(); i++) state[i].store(Pending, memory_order_relaxed);
+    atomic<size_t> next{0};
+    auto start = Clock::now();
+
+    vector<thread> pool;
+    for (int w = 0; w < workers; w++) {
+        pool.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1)) < trace.size();) {
+                const Request& r = trace[i];
+                auto intended = start + chrono::nanoseconds(r.atNanos);
+                if (Clock::now() < intended) this_thread::sleep_until(intended);
+                auto began = Clock::now();
+                currentRequest = &r;
+                if (r.kind == Kind::Book) {
+                    outcome[i] = target.book(r);
+                    state[i].store(outcome[i] == "ok" ? Booked : NotBooked, memory_order_release);
+                    state[i].notify_all();
+                } else {
+                    // The Book was handed out earlier, so some worker is finishing it.
+                    atomic<uint8_t>& booking = state[r.cancels];
+                    booking.wait(Pending, memory_order_acquire);
+                    uint8_t expected = Booked;
+                    if (booking.compare_exchange_strong(expected, Cancelled, memory_order_acq_rel)) {
+                        target.cancel(r);
+                        outcome[i] = "cancelled";
+                    } else {
+                        outcome[i] = "cancel_noop";
+                    }
+                }
+                currentRequest = nullptr;
+                auto done = Clock::now();
+                corrected[i] = (done - intended).count();
+                service[i] = (done - began).count();
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    report.seconds = chrono::duration<double>(Clock::now() - start).count();
+    for (auto& o : outcome) report.outcomes[o]++;
+    report.correctedNanos = move(corrected);
+    report.serviceNanos = move(service);
+    return report;
+}
+
+
+//////////////////////////////////////////
+// Checks + demo
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+WorkloadSpec flashSaleSpec() {
+    WorkloadSpec spec;
+    spec.seed = 2024;
+    spec.durationSec = 3;
+    spec.baseRate = 4000;
+    spec.flashSales = {{1.0, 0.5, 6.0, 0, 0.8}};        // 1s in : 6x traffic for 0.5s, 80% of it for the top show
+    return spec;
+}
+
+// Counts what reaches it; optionally stalls on one request.
+class ProbeTarget : public LoadTarget {
+public:
+    atomic<long> booked{0}, cancelled{0};
+    int64_t stallAt;
+    chrono::milliseconds stall;
+
+    explicit ProbeTarget(int64_t stallAt = -1, chrono::milliseconds stall = {}) : stallAt(stallAt), stall(stall) {}
+
+    string book(const Request& r) override {
+        if (r.atNanos == stallAt) this_thread::sleep_for(stall);
+        if (r.paymentFails) return "payment_failed";
+        booked++;
+        return "ok";
+    }
+    void cancel(const Request& r) override { cancelled++; }
+};
+
+void checks(const string& dir) {
+    WorkloadSpec spec = flashSaleSpec();
+    auto a = WorkloadGenerator(spec).generate();
+    auto b = WorkloadGenerator(spec).generate();
+    spec.seed++;
+    auto c = WorkloadGenerator(spec).generate();
+    check(fingerprint(a) == fingerprint(b) && fingerprint(a) != fingerprint(c), "same seed, same workload; other seed, other workload");
+
+    saveTrace(a, dir + "/trace.csv");
+    check(fingerprint(loadTrace(dir + "/trace.csv", spec.shows)) == fingerprint(a), "a saved trace replays exactly");
+
+    auto rejected = [&](const string& lines) {
+        ofstream(dir + "/bad.csv") << lines;
+        try { loadTrace(dir + "/bad.csv", spec.shows); } catch (const runtime_error&) { return true; }
+        return false;
+    };
+    check(rejected("0,X,1,1,0,-1\n") && rejected("0,B,1,500,0,-1\n") && rejected("0,B,1,-1,0,-1\n") &&
+          rejected("0,B,1,1,0,-1junk\n") && rejected("0,B,1,1,2,-1\n") && rejected("0,B,1,1,0,0\n"),
+          "unknown kinds, shows outside the inventory and malformed fields are rejected");
+    check(rejected("0,C,1,1,0,0\n") && rejected("0,B,1,1,0,-1\n1,C,1,1,0,1\n") &&
+          rejected("0,B,1,1,0,-1\n1,C,1,1,0,5\n") && rejected("0,B,1,1,0,-1\n1,C,1,1,0,0\n2,C,1,1,0,1\n") &&
+          rejected("0,B,1,1,0,-1\n1,C,1,2,0,0\n") && !rejected("0,B,1,1,0,-1\n1,C,1,1,0,0\n"),
+          "a cancel must point back at an earlier booking of the same show");
+
+    long inBurst = 0, topShowInBurst = 0, before = 0, cancels = 0, fails = 0, books = 0;
+    for (auto& r : a) {
+        double t = r.atNanos / 1e9;
+        if (r.kind == Kind::Cancel) { cancels++; continue; }
+        books++;
+        fails += r.paymentFails;
+        if (t >= 1.0 && t < 1.5) { inBurst++; topShowInBurst += r.show == 0; }
+        if (t >= 0.5 && t < 1.0) before++;
+    }
+    check(inBurst > 4 * before, "flash sale multiplies the arrival rate (" + to_string(before) + " -> " + to_string(inBurst) + " per 0.5s)");
+    check(topShowInBurst > inBurst * 0.7, "flash-sale traffic is focused on one show");
+    check(abs((double)cancels / a.size() - spec.cancelRate) < 0.01 && abs((double)fails / books - spec.paymentFailureRate) < 0.01,
+          "cancellation and payment-failure rates follow the spec");
+
+    set<int64_t> cancelTargets;
+    bool once = true;
+    for (auto& r : a) if (r.kind == Kind::Cancel) once &= cancelTargets.insert(r.cancels).second;
+    check(once, "the generator never cancels the same booking twice");
+
+    // 0 : failed booking, 1 : good booking; then cancel 0, cancel 1 twice.
+    vector<Request> cancelTrace = {{0, Kind::Book, 1, 1, true, -1}, {1, Kind::Book, 2, 1, false, -1},
+                                   {2, Kind::Cancel, 1, 1, false, 0}, {3, Kind::Cancel, 2, 1, false, 1},
+                                   {4, Kind::Cancel, 2, 1, false, 1}};
+    ProbeTarget probe;
+    auto outcomes = drive(probe, cancelTrace, 3).outcomes;
+    check(probe.cancelled == 1 && outcomes["cancelled"] == 1 && outcomes["cancel_noop"] == 2,
+          "a cancel only undoes a booking that succeeded and was not cancelled yet");
+
+    // Coordinated omission : one 100ms stall in a steady 2000 req/s stream. Requests queued
+    // behind it only show up when latency is measured from their intended start.
+    WorkloadSpec steady;
+    steady.seed = 9;
+    steady.durationSec = 1;
+    steady.baseRate = 2000;
+    steady.cancelRate = 0;
+    steady.paymentFailureRate = 0;
+    auto stream = WorkloadGenerator(steady).generate();
+    ProbeTarget stalling(stream[stream.size() / 2].atNanos, chrono::milliseconds(100));
+    LoadReport stalled = drive(stalling, stream, 1);
+    int64_t correctedP99 = LoadReport::pct(stalled.correctedNanos, 0.99), serviceP99 = LoadReport::pct(stalled.serviceNanos, 0.99);
+    check(correctedP99 > 20000000 && serviceP99 < 10000000,
+          "coordinated omission : a 100ms stall shows in corrected p99 (" + to_string(correctedP99 / 1000000) +
+          "ms) but not in uncorrected p99 (" + to_string(serviceP99 / 1000) + "us)");
+}
+
+
+int main() {
+    string dir = "/tmp/load_harness_demo";
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+
+    checks(dir);
+
+    auto trace = loadTrace(dir + "/trace.csv", flashSaleSpec().shows);
+    cout << "\n--- " << trace.size() << " requests, 4000 req/s with a 6x flash sale at t=1s, 4 workers ---\n";
+    {
+        TicketbookingTarget target(500, 2000, chrono::microseconds(30));
+        drive(target, trace, 4).print("Ticketbooking (SRP stack)");
+    }
+    {
+        ControllerTarget target(500, 2000, chrono::microseconds(30));
+        drive(target, trace, 4).print("BookTicketControllerDIP  ");
+    }
+
+    filesystem::remove_all(dir);
+    return 0;
+}
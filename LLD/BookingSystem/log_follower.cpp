@@ -0,0 +1,493 @@
+/*
+
+Log-Shipping Read Followers
+
+Problem :
+    Availability queries and reports hit the same ITicketRepository as bookings
+    (DIP/example.cpp). Every read takes the lock the writers need, so a reporting
+    burst slows down selling tickets.
+
+Solution : the primary writes an append-only booking log; followers tail it.
+
+    bookTicket  ->  Primary : update state + append record (lsn, show, seat, user, time)
+                                   |
+                                   | shared log file (page cache, no network)
+                                   v
+                 Follower 1 .. N : read new records -> apply a whole batch under one lock
+                                   -> serve availability / booking lookups (read only)
+
+> Batched apply : a follower takes its write lock once per batch of records,
+  not once per record, so its readers are barely disturbed.
+> Each record has a CRC. A record the primary is still writing fails the CRC and
+  is simply picked up on the next poll.
+> Published head : after each append the primary stores (last lsn, commit time) in a
+  small shared file next to the log (<log>.head, mmap'd, seqlock). Followers read it
+  at the start of every poll, so lag is measured against what the primary has
+  really committed, not against what the follower happened to read.
+> Lag metric : records behind the primary, and how stale the follower's view can be :
+  the age of the oldest committed record not applied yet, or - when caught up - the
+  time since the poll that saw it caught up. A follower that stopped polling keeps
+  getting staler instead of looking fresh.
+> Bounded staleness : a read can say "at most X ms behind". If the follower is
+  further behind it waits up to X for catch-up, then throws so the caller can go
+  to the primary. Read-your-writes : pass the lsn returned by the booking.
+
+*/
+
+#include<bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+using namespace std;
+namespace fs = std::filesystem;
+
+using Clock = chrono::steady_clock;
+
+static int64_t nowNanos() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+
+//////////////////////////////////////////
+// Log format
+//////////////////////////////////////////
+
+struct LogRecord {
+    uint64_t lsn;
+    int64_t commitNanos;
+    uint32_t seat;
+    uint32_t crc;            // over everything except this field
+    char movieId[24];
+    char userId[16];
+};
+static_assert(sizeof(LogRecord) == 64);
+
+static uint32_t crc32(const char* data, size_t n) {
+    static const auto table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) c = table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+static uint32_t recordCrc(const LogRecord& r) {
+    LogRecord copy = r;
+    copy.crc = 0;
+    return crc32(reinterpret_cast<const char*>(&copy), sizeof(copy));
+}
+
+// <log>.head : the primary's last committed record, shared with followers through mmap.
+struct PublishedHead {
+    atomic<uint64_t> sequence;       // odd while the primary is updating it
+    atomic<uint64_t> lsn;
+    atomic<int64_t> commitNanos;
+};
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<int64_t>::is_always_lock_free);
+
+static fs::path headPath(const fs::path& logPath) { return logPath.string() + ".head"; }
+
+static PublishedHead* mapHead(const fs::path& logPath, bool create) {
+    fs::path path = headPath(logPath);
+    int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+    if (fd < 0) throw runtime_error("cannot open " + path.string());
+    if (create && ftruncate(fd, sizeof(PublishedHead)) != 0) {
+        ::close(fd);
+        throw runtime_error("cannot size " + path.string());
+    }
+    void* p = mmap(nullptr, sizeof(PublishedHead), create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) throw runtime_error("cannot map " + path.string());
+    return static_cast<PublishedHead*>(p);
+}
+
+// Ids must fit whole : a truncated id would make the follower serve keys and owners that
+// differ from the primary's.
+template<size_t N>
+static void copyField(char (&dst)[N], const string& src) {
+    if (src.size() >= N || src.find('\0') != string::npos) {
+        throw invalid_argument("id '" + src.substr(0, 32) + "' must be under " + to_string(N) + " bytes with no NUL");
+    }
+    memset(dst, 0, N);
+    memcpy(dst, src.data(), src.size());
+}
+
+
+//////////////////////////////////////////
+// Primary
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class PrimaryTicketRepository : public ITicketRepository {
+private:
+    int capacityPerShow;
+    chrono::microseconds writeLatency;
+    int logFd;
+    PublishedHead* head;
+    shared_mutex lock;
+    unordered_map<string, int> soldPerShow;
+    unordered_map<string, string> bookings;      // bookingId -> userId
+    atomic<uint64_t> lastLsn{0};
+
+public:
+    PrimaryTicketRepository(const fs::path& logPath, int capacityPerShow, chrono::microseconds writeLatency = {})
+        : capacityPerShow(capacityPerShow), writeLatency(writeLatency) {
+        logFd = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (logFd < 0) throw runtime_error("cannot open " + logPath.string());
+        head = mapHead(logPath, true);
+    }
+
+    ~PrimaryTicketRepository() {
+        munmap(head, sizeof(PublishedHead));
+        ::close(logFd);
+    }
+
+    string bookTicket(const string& userId, const string& movieId) override {
+        LogRecord r{0, 0, 0, 0, {}, {}};
+        copyField(r.movieId, movieId);                         // validated before any state changes
+        copyField(r.userId, userId);
+        unique_lock<shared_mutex> guard(lock);
+        int& sold = soldPerShow[movieId];
+        if (sold >= capacityPerShow) throw runtime_error("show " + movieId + " is sold out");
+        this_thread::sleep_for(writeLatency);                  // persisting the booking
+        int seat = ++sold;
+        string id = movieId + "-" + to_string(seat);
+        bookings[id] = userId;
+
+        r.lsn = lastLsn.load() + 1;
+        r.commitNanos = nowNanos();
+        r.seat = seat;
+        r.crc = recordCrc(r);
+        if (::write(logFd, &r, sizeof(r)) != (ssize_t)sizeof(r)) throw runtime_error("booking log write failed");
+        lastLsn.store(r.lsn, memory_order_release);
+
+        uint64_t seq = head->sequence.load(memory_order_relaxed);
+        head->sequence.store(seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        head->lsn.store(r.lsn, memory_order_relaxed);
+        head->commitNanos.store(r.commitNanos, memory_order_relaxed);
+        head->sequence.store(seq + 2, memory_order_release);
+        return id;
+    }
+
+    uint64_t lsn() const { return lastLsn.load(memory_order_acquire); }
+
+    int seatsSold(const string& movieId) {
+        shared_lock<shared_mutex> guard(lock);
+        auto it = soldPerShow.find(movieId);
+        return it == soldPerShow.end() ? 0 : it->second;
+    }
+};
+
+
+//////////////////////////////////////////
+// Follower
+//////////////////////////////////////////
+
+class StaleReadError : public runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+class TicketFollower {
+private:
+    fs::path logPath;
+    size_t maxBatch;
+
+    shared_mutex lock;
+    unordered_map<string, int> soldPerShow;
+    unordered_map<string, string> bookings;
+
+    atomic<uint64_t> appliedLsn{0};
+    atomic<int64_t> oldestPendingNanos{0};      // commit time of the first committed record not applied, 0 if caught up
+    atomic<int64_t> lastPollNanos{0};           // when the last poll read the primary's head
+    atomic<uint64_t> batches{0};
+    atomic<bool> paused{false};
+    mutex progressLock;
+    condition_variable progress;
+
+    atomic<bool> stopping{false};
+    thread applier;
+
+    static pair<uint64_t, int64_t> readHead(const PublishedHead* head) {
+        while (true) {
+            uint64_t before = head->sequence.load(memory_order_acquire);
+            uint64_t lsn = head->lsn.load(memory_order_relaxed);
+            int64_t commit = head->commitNanos.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (!(before & 1) && head->sequence.load(memory_order_relaxed) == before) return {lsn, commit};
+        }
+    }
+
+    // After a poll : caught up with the head it read, or stale since the first record it is missing.
+    // Records up to the head are fully written, so the missing one can be read back.
+    void publishLag(int fd, uint64_t offset, uint64_t headLsn, int64_t pollNanos) {
+        int64_t pending = 0;
+        if (appliedLsn.load(memory_order_relaxed) < headLsn) {
+            LogRecord next;
+            pending = pread(fd, &next, sizeof(next), offset) == (ssize_t)sizeof(next) ? next.commitNanos : pollNanos;
+        }
+        oldestPendingNanos.store(pending, memory_order_relaxed);
+        lastPollNanos.store(pollNanos, memory_order_release);
+    }
+
+    void run() {
+        int fd = ::open(logPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw runtime_error("cannot open " + logPath.string());
+        PublishedHead* head = mapHead(logPath, false);
+        vector<LogRecord> chunk(maxBatch);
+        uint64_t offset = 0;
+        while (!stopping.load(memory_order_relaxed)) {
+            if (paused.load(memory_order_relaxed)) {
+                this_thread::sleep_for(chrono::microseconds(100));
+                continue;
+            }
+            int64_t pollNanos = nowNanos();
+            uint64_t headLsn = readHead(head).first;
+            ssize_t n = pread(fd, chunk.data(), chunk.size() * sizeof(LogRecord), offset);
+            size_t complete = n > 0 ? n / sizeof(LogRecord) : 0;
+            size_t valid = 0;
+            while (valid < complete && recordCrc(chunk[valid]) == chunk[valid].crc) valid++;   // rest still being written
+
+            if (valid == 0) {
+                publishLag(fd, offset, headLsn, pollNanos);
+                {
+                    lock_guard<mutex> guard(progressLock);
+                }
+                progress.notify_all();
+                this_thread::sleep_for(chrono::microseconds(100));
+                continue;
+            }
+            {
+                unique_lock<shared_mutex> guard(lock);        // one lock for the whole batch
+                for (size_t i = 0; i < valid; i++) {
+                    const LogRecord& r = chunk[i];
+                    string movie(r.movieId);
+                    soldPerShow[movie] = r.seat;
+                    bookings[movie + "-" + to_string(r.seat)] = r.userId;
+                }
+            }
+            offset += valid * sizeof(LogRecord);
+            appliedLsn.store(chunk[valid - 1].lsn, memory_order_release);
+            publishLag(fd, offset, headLsn, pollNanos);
+            batches.fetch_add(1, memory_order_relaxed);
+            {
+                lock_guard<mutex> guard(progressLock);
+            }
+            progress.notify_all();
+        }
+        munmap(head, sizeof(PublishedHead));
+        ::close(fd);
+    }
+
+    // How stale reads are right now, in nanoseconds. Unknown until the first poll.
+    optional<int64_t> stalenessNanos() const {
+        int64_t pending = oldestPendingNanos.load(memory_order_relaxed);
+        int64_t polled = lastPollNanos.load(memory_order_acquire);
+        if (polled == 0) return nullopt;
+        return nowNanos() - (pending != 0 ? pending : polled);
+    }
+
+    // Waits until the follower is within maxLag of the primary (and has minLsn), or throws.
+    void awaitFresh(chrono::microseconds maxLag, uint64_t minLsn) {
+        auto fresh = [&] {
+            auto stale = stalenessNanos();
+            bool timely = stale && *stale <= maxLag.count() * 1000;
+            return timely && appliedLsn.load(memory_order_acquire) >= minLsn;
+        };
+        if (fresh()) return;
+        unique_lock<mutex> guard(progressLock);
+        if (!progress.wait_for(guard, maxLag, fresh)) throw StaleReadError("follower is behind the primary");
+    }
+
+public:
+    TicketFollower(fs::path logPath, size_t maxBatch = 1024)
+        : logPath(move(logPath)), maxBatch(maxBatch), applier([this] { run(); }) {}
+
+    ~TicketFollower() {
+        stopping = true;
+        applier.join();
+    }
+
+    // Stop / restart applying the log (maintenance, or to simulate a stalled follower).
+    void pause() { paused = true; }
+    void resume() { paused = false; }
+
+    int seatsSold(const string& movieId, chrono::microseconds maxLag, uint64_t minLsn = 0) {
+        awaitFresh(maxLag, minLsn);
+        shared_lock<shared_mutex> guard(lock);
+        auto it = soldPerShow.find(movieId);
+        return it == soldPerShow.end() ? 0 : it->second;
+    }
+
+    optional<string> bookingOwner(const string& bookingId, chrono::microseconds maxLag, uint64_t minLsn = 0) {
+        awaitFresh(maxLag, minLsn);
+        shared_lock<shared_mutex> guard(lock);
+        auto it = bookings.find(bookingId);
+        return it == bookings.end() ? nullopt : optional(it->second);
+    }
+
+    // Replication lag metrics.
+    uint64_t lagRecords(uint64_t primaryLsnNow) const { return primaryLsnNow - appliedLsn.load(); }
+    // nullopt until the follower has polled the primary once.
+    optional<int64_t> lagMicros() const {
+        auto stale = stalenessNanos();
+        return stale ? optional(*stale / 1000) : nullopt;
+    }
+    uint64_t applied() const { return appliedLsn.load(); }
+    uint64_t batchCount() const { return batches.load(); }
+};
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+static bool waitUntil(const function<bool()>& done) {
+    for (int i = 0; i < 2000 && !done(); i++) this_thread::sleep_for(chrono::milliseconds(1));
+    return done();
+}
+
+void checks(const fs::path& dir) {
+    fs::path log = dir / "check.log";
+    PrimaryTicketRepository primary(log, 1000);
+    TicketFollower follower(log);
+
+    for (int i = 0; i < 500; i++) primary.bookTicket("u" + to_string(i), "m" + to_string(i % 7));
+    check(waitUntil([&] { return follower.applied() == primary.lsn(); }), "follower catches up with the primary");
+
+    bool same = true;
+    for (int m = 0; m < 7; m++) same &= follower.seatsSold("m" + to_string(m), 100ms) == primary.seatsSold("m" + to_string(m));
+    check(same, "follower availability matches the primary");
+    check(follower.batchCount() < 500, "records are applied in batches (" + to_string(follower.batchCount()) + " batches for 500 records)");
+
+    string id = primary.bookTicket("alice", "m3");
+    auto owner = follower.bookingOwner(id, 100ms, primary.lsn());
+    check(owner && *owner == "alice", "read-your-writes : lookup with the booking's lsn sees it");
+    check(follower.lagRecords(primary.lsn()) == 0, "lag metric is 0 when caught up");
+
+    // A follower that stops polling must not keep looking fresh, even with nothing new to apply.
+    follower.pause();
+    this_thread::sleep_for(20ms);
+    bool stalledRefused = false;
+    try { follower.seatsSold("m3", 5ms); } catch (const StaleReadError&) { stalledRefused = true; }
+    check(stalledRefused && follower.lagMicros().value_or(0) >= 20000, "a paused follower is stale : reads past the bound are refused");
+    primary.bookTicket("bob", "m4");
+    follower.resume();
+    check(follower.seatsSold("m4", 100ms, primary.lsn()) == primary.seatsSold("m4"), "a resumed follower serves fresh reads again");
+
+    // a follower that cannot keep up refuses reads past the staleness bound
+    fs::path torn = dir / "torn.log";
+    PrimaryTicketRepository other(torn, 10);
+    other.bookTicket("u1", "m1");
+    {
+        int fd = ::open(torn.c_str(), O_WRONLY | O_APPEND);
+        LogRecord half{2, nowNanos(), 2, 0, {}, {}};
+        if (::write(fd, &half, 40) != 40) throw runtime_error("write failed");  // primary died mid-record
+        ::close(fd);
+    }
+    TicketFollower stuck(torn);
+    waitUntil([&] { return stuck.applied() == 1; });
+    bool refused = false;
+    try { stuck.seatsSold("m1", 5ms, 2); } catch (const StaleReadError&) { refused = true; }
+    check(stuck.applied() == 1 && refused, "half-written record is not applied; a read needing it is refused after the bound");
+
+    int rejected = 0;
+    uint64_t lsnBefore = primary.lsn();
+    for (auto [user, movie] : {pair<string, string>{"u1", string(24, 'm')}, {string(16, 'u'), "m1"}, {"u1", string("m1\0x", 4)}}) {
+        try { primary.bookTicket(user, movie); } catch (const invalid_argument&) { rejected++; }
+    }
+    check(rejected == 3 && primary.lsn() == lsnBefore, "ids that do not fit a log record are rejected, not truncated");
+}
+
+struct ReadStats { double readsPerSec, writesPerSec, p99us; int64_t maxLagUs; };
+
+ReadStats runLoad(const fs::path& dir, int followers, int readers, double seconds) {
+    fs::path log = dir / ("bench" + to_string(followers) + ".log");
+    PrimaryTicketRepository primary(log, INT_MAX, chrono::microseconds(20));
+    vector<unique_ptr<TicketFollower>> replicas;
+    for (int i = 0; i < followers; i++) replicas.push_back(make_unique<TicketFollower>(log));
+
+    atomic<bool> stop{false};
+    atomic<long> writes{0};
+    atomic<int64_t> maxLag{0};
+    thread writer([&] {
+        mt19937 rng(1);
+        while (!stop) { primary.bookTicket("u", "m" + to_string(rng() % 200)); writes++; }
+    });
+    thread monitor([&] {
+        while (!stop) {
+            for (auto& f : replicas) {
+                if (auto lag = f->lagMicros()) maxLag = max(maxLag.load(), *lag);    // skip one that has not polled yet
+            }
+            this_thread::sleep_for(1ms);
+        }
+    });
+
+    vector<long> counts(readers);
+    vector<vector<double>> latencies(readers);
+    vector<thread> clients;
+    for (int r = 0; r < readers; r++) {
+        clients.emplace_back([&, r] {
+            mt19937 rng(r + 10);
+            while (!stop) {
+                string show = "m" + to_string(rng() % 200);
+                auto t0 = Clock::now();
+                if (followers == 0) primary.seatsSold(show);
+                else {
+                    try { replicas[r % followers]->seatsSold(show, 50ms); }
+                    catch (const StaleReadError&) { primary.seatsSold(show); }      // too far behind : go to the primary
+                }
+                if ((counts[r]++ & 63) == 0) latencies[r].push_back(chrono::duration<double, micro>(Clock::now() - t0).count());
+            }
+        });
+    }
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& c : clients) c.join();
+    writer.join();
+    monitor.join();
+
+    vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    long total = accumulate(counts.begin(), counts.end(), 0L);
+    return {total / seconds, writes / seconds, all.empty() ? 0 : all[all.size() * 99 / 100], maxLag.load()};
+}
+
+
+int main() {
+    fs::path dir = "/tmp/log_follower_demo";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    checks(dir);
+
+    cout << "\n--- read scaling : 1 writer (20us per booking), 4 reader threads, "
+         << thread::hardware_concurrency() << " core(s) ---\n";
+    for (int followers = 0; followers <= 4; followers++) {
+        ReadStats s = runLoad(dir, followers, 4, 1.0);
+        cout << (followers == 0 ? string("primary only") : to_string(followers) + " follower(s)")
+             << " : " << (long)s.readsPerSec << " reads/sec, p99 " << fixed << setprecision(1) << s.p99us << "us, "
+             << (long)s.writesPerSec << " bookings/sec, max lag " << s.maxLagUs << "us\n";
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,292 @@
+/*
+
+Precompiled Notification Message Templates
+
+In LSP/examples.cpp the message "Your ticket is booked!" is a full std::string.
+A personalised message is usually built like this on every send :
+
+    string msg = "Hi " + name + ", your ticket for " + movie + " (seat " + seat + ") is booked!";
+
+Every '+' creates a new temporary string -> several allocations + copies per message.
+
+Idea : parse the template ONCE into a list of operations
+
+    "Hi {name}, your ticket for {movie} (seat {seat}) is booked!"
+
+        LITERAL "Hi "
+        SLOT    name
+        LITERAL ", your ticket for "
+        SLOT    movie
+        LITERAL " (seat "
+        SLOT    seat
+        LITERAL ") is booked!"
+
+Rendering then just walks the list :
+
+> renderTo(buffer)  : appends into a per-thread buffer that is reused, so after the
+                      first few messages it never allocates again.
+> renderIov(iov)    : does not copy at all, it hands out {pointer, length} pairs
+                      (iovec) that writev()/sendmsg() can send directly.
+
+Placeholders are written as {name}. "{{" and "}}" produce literal braces.
+Every render call takes exactly slotCount() arguments, anything else throws.
+
+*/
+
+#include<bits/stdc++.h>
+#include <sys/uio.h>
+#include <unistd.h>
+using namespace std;
+
+
+//////////////////////////////////////////
+// Compiled template
+//////////////////////////////////////////
+
+class MessageTemplate {
+private:
+    struct Op {
+        bool isSlot;
+        uint32_t offset;   // literal : position in text,  slot : argument index
+        uint32_t length;
+    };
+
+    string text;               // literal bytes (braces already unescaped)
+    vector<Op> ops;
+    vector<string> slotNames;
+    size_t literalBytes = 0;
+
+    void addLiteral(const string& piece) {
+        if (piece.empty()) return;
+        if (!ops.empty() && !ops.back().isSlot) {
+            ops.back().length += piece.size();     // merge neighbouring literals
+        } else {
+            ops.push_back({false, (uint32_t)text.size(), (uint32_t)piece.size()});
+        }
+        text += piece;
+        literalBytes += piece.size();
+    }
+
+    // Checked once per call, so the loops below can index args freely.
+    void checkArity(span<const string_view> args) const {
+        if (args.size() != slotNames.size()) {
+            throw invalid_argument("template has " + to_string(slotNames.size()) + " placeholders, got " +
+                                   to_string(args.size()) + " arguments");
+        }
+    }
+
+public:
+    explicit MessageTemplate(const string& source) {
+        string pending;
+        for (size_t i = 0; i < source.size(); i++) {
+            char c = source[i];
+            if ((c == '{' || c == '}') && i + 1 < source.size() && source[i + 1] == c) {
+                pending += c;
+                i++;
+            } else if (c == '{') {
+                size_t close = source.find('}', i);
+                if (close == string::npos) throw invalid_argument("unclosed '{' in template");
+                string name = source.substr(i + 1, close - i - 1);
+                if (name.empty()) throw invalid_argument("empty placeholder in template");
+                addLiteral(pending);
+                pending.clear();
+
+                auto it = find(slotNames.begin(), slotNames.end(), name);
+                uint32_t index = it - slotNames.begin();
+                if (it == slotNames.end()) slotNames.push_back(name);
+                ops.push_back({true, index, 0});
+                i = close;
+            } else if (c == '}') {
+                throw invalid_argument("unmatched '}' in template");
+            } else {
+                pending += c;
+            }
+        }
+        addLiteral(pending);
+    }
+
+    // Position of a placeholder in the argument list passed to render.
+    size_t slot(const string& name) const {
+        auto it = find(slotNames.begin(), slotNames.end(), name);
+        if (it == slotNames.end()) throw invalid_argument("unknown placeholder " + name);
+        return it - slotNames.begin();
+    }
+
+    size_t slotCount() const { return slotNames.size(); }
+
+    // Appends the rendered message to out. args[i] is the value of slot i.
+    void renderTo(string& out, span<const string_view> args) const {
+        checkArity(args);
+        size_t size = literalBytes;
+        for (const Op& op : ops) if (op.isSlot) size += args[op.offset].size();
+        out.reserve(out.size() + size);
+        for (const Op& op : ops) {
+            if (op.isSlot) out.append(args[op.offset]);
+            else out.append(text.data() + op.offset, op.length);
+        }
+    }
+
+    // Renders into a buffer owned by the calling thread. The view stays valid
+    // until the same thread renders again.
+    string_view render(span<const string_view> args) const {
+        thread_local string buffer;
+        buffer.clear();
+        renderTo(buffer, args);
+        return buffer;
+    }
+
+    // Zero copy : fills iov with pointers into the template and into args.
+    // args must outlive the iovecs.
+    void renderIov(vector<iovec>& iov, span<const string_view> args) const {
+        checkArity(args);
+        iov.clear();
+        for (const Op& op : ops) {
+            if (op.isSlot) {
+                string_view v = args[op.offset];
+                if (!v.empty()) iov.push_back({const_cast<char*>(v.data()), v.size()});
+            } else {
+                iov.push_back({const_cast<char*>(text.data() + op.offset), op.length});
+            }
+        }
+    }
+};
+
+
+//////////////////////////////////////////
+// Notification service using templates
+//////////////////////////////////////////
+
+class NotificationService {
+public:
+    virtual void send(string_view userId, string_view message) = 0;
+    virtual ~NotificationService() = default;
+};
+
+class EmailService : public NotificationService {
+public:
+    void send(string_view userId, string_view message) override {
+        cout << "Email to " << userId << " : " << message << "\n";
+    }
+};
+
+void notifyBooked(NotificationService* service, const MessageTemplate& booked,
+                  string_view userId, string_view name, string_view movie, string_view seat) {
+    string_view args[] = {name, movie, seat};
+    service->send(userId, booked.render(args));
+}
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    MessageTemplate booked("Hi {name}, your ticket for {movie} (seat {seat}) is booked!");
+    string_view args[] = {"Asha", "Interstellar", "A1"};
+    check(booked.slotCount() == 3 && booked.render(args) == "Hi Asha, your ticket for Interstellar (seat A1) is booked!",
+          "render fills every placeholder in order");
+
+    MessageTemplate escaped("{{{who}}} paid {amt}, {who}");
+    string_view pair[] = {"Ravi", "500"};
+    check(escaped.slotCount() == 2 && escaped.render(pair) == "{Ravi} paid 500, Ravi",
+          "escaped braces are literal and a repeated placeholder reuses its argument");
+
+    vector<iovec> iov;
+    booked.renderIov(iov, args);
+    string joined;
+    for (auto& v : iov) joined.append((const char*)v.iov_base, v.iov_len);
+    check(joined == booked.render(args), "iovec rendering gives the same bytes as render");
+
+    auto rejects = [&](span<const string_view> given) {
+        int thrown = 0;
+        string out = "kept";
+        try { booked.renderTo(out, given); } catch (const invalid_argument&) { thrown++; }
+        try { booked.renderIov(iov, given); } catch (const invalid_argument&) { thrown++; }
+        return thrown == 2 && out == "kept";
+    };
+    string_view tooFew[] = {"Asha", "Interstellar"};
+    string_view tooMany[] = {"Asha", "Interstellar", "A1", "extra"};
+    check(rejects(tooFew) && rejects(tooMany) && rejects({}), "a wrong argument count is rejected before anything is read");
+
+    int bad = 0;
+    for (string source : {"Hi {name", "Hi {}", "Hi }"}) {
+        try { MessageTemplate t(source); } catch (const invalid_argument&) { bad++; }
+    }
+    check(bad == 3, "malformed templates are rejected when compiled");
+}
+
+
+//////////////////////////////////////////
+// Benchmark : renders/sec
+//////////////////////////////////////////
+
+template <typename Fn>
+void bench(const string& label, int iterations, Fn fn) {
+    size_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn(i);
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << setw(22) << left << label << (long)(iterations / sec) << " renders/sec"
+         << "  (" << sink % 10 << ")\n";
+}
+
+int main() {
+    checks();
+
+    MessageTemplate booked("Hi {name}, your ticket for {movie} (seat {seat}) is booked!");
+
+    EmailService email;
+    notifyBooked(&email, booked, "u123", "Asha", "Interstellar", "A1");
+
+    // zero-copy path straight to stdout
+    cout.flush();
+    vector<iovec> iov;
+    string_view args[] = {"Ravi", "Dune", "C7"};
+    booked.renderIov(iov, args);
+    iov.push_back({const_cast<char*>("\n"), 1});
+    if (writev(STDOUT_FILENO, iov.data(), iov.size()) < 0) perror("writev");
+
+    cout << "\n--- renders/sec ---\n";
+    vector<string> names = {"Asha", "Ravi", "Meera", "Kabir Singh Rathore"};
+    vector<string> movies = {"Interstellar", "Dune: Part Two", "Oppenheimer", "Up"};
+    vector<string> seats = {"A1", "B12", "C7", "K21"};
+    const int N = 2000000;
+    size_t nameSlot = booked.slot("name"), movieSlot = booked.slot("movie"), seatSlot = booked.slot("seat");
+
+    bench("string concatenation", N, [&](int i) {
+        string msg = "Hi " + names[i & 3] + ", your ticket for " + movies[(i >> 2) & 3] +
+                     " (seat " + seats[(i >> 4) & 3] + ") is booked!";
+        return msg.size();
+    });
+
+    bench("ostringstream", N, [&](int i) {
+        ostringstream out;
+        out << "Hi " << names[i & 3] << ", your ticket for " << movies[(i >> 2) & 3]
+            << " (seat " << seats[(i >> 4) & 3] << ") is booked!";
+        return out.str().size();
+    });
+
+    vector<string_view> slots(booked.slotCount());
+    bench("template render", N, [&](int i) {
+        slots[nameSlot] = names[i & 3];
+        slots[movieSlot] = movies[(i >> 2) & 3];
+        slots[seatSlot] = seats[(i >> 4) & 3];
+        return booked.render(slots).size();
+    });
+
+    vector<iovec> out;
+    bench("template iovec", N, [&](int i) {
+        slots[nameSlot] = names[i & 3];
+        slots[movieSlot] = movies[(i >> 2) & 3];
+        slots[seatSlot] = seats[(i >> 4) & 3];
+        booked.renderIov(out, slots);
+        return out.size();
+    });
+
+    return 0;
+}
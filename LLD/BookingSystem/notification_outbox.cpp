@@ -0,0 +1,712 @@
+/*
+
+Durable Notification Outbox
+
+Problem :
+    In OCP/examples.cpp and LSP/examples.cpp a booking calls Notifier::notify directly.
+    If the provider is down, notify either throws (like DummyNotification did) and the
+    booking flow has to deal with it, or the message is silently lost.
+
+Solution : Transactional Outbox pattern
+
+    booking path  ->  append record to local log  (fast, never talks to the provider)
+    delivery workers  ->  read the log  ->  Notifier::notify
+                          failed  -> append a retry record with a backoff time
+                          failed too many times -> dead-letter log
+
+> The log is split into segment files (seg-000001.log, seg-000002.log ...).
+  Old segments are deleted once every record in them is finished.
+> Each record carries a CRC, so a half written record after a crash is detected
+  and the torn tail is cut off at startup.
+> A small "cursor" file remembers up to where everything is finished.
+  It is replaced with write-temp + rename, so it is always either old or new.
+> Retry delay = random(0, base * 2^attempt) capped at max ("full jitter"),
+  so thousands of failed messages do not all retry at the same instant.
+
+Delivery is at-least-once : a crash after notify() but before the cursor moves
+sends the message again. Providers usually dedupe on the record id.
+
+*/
+
+#include<bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+using namespace std;
+namespace fs = std::filesystem;
+
+using Clock = chrono::steady_clock;
+
+static int64_t wallMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+}
+
+
+//////////////////////////////////////////
+// Notifier (same as OCP/examples.cpp)
+//////////////////////////////////////////
+
+class Notifier {
+public:
+    virtual void notify(const string& userId, const string& message) = 0;
+    virtual ~Notifier() = default;
+};
+
+
+//////////////////////////////////////////
+// Record + on-disk format
+//////////////////////////////////////////
+
+// [len u32][crc u32][id u64][attempts u32][nextAttemptMs i64][userLen u32][user][message]
+//  len and crc cover everything after the crc field.
+struct OutboxRecord {
+    uint64_t id = 0;
+    uint32_t attempts = 0;
+    int64_t nextAttemptMs = 0;
+    string userId;
+    string message;
+};
+
+static uint32_t crc32(const char* data, size_t n) {
+    static const auto table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) c = table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+static void putRaw(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static T getRaw(const char*& p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+static string encode(const OutboxRecord& r) {
+    string body;
+    putRaw(body, r.id);
+    putRaw(body, r.attempts);
+    putRaw(body, r.nextAttemptMs);
+    putRaw<uint32_t>(body, r.userId.size());
+    body += r.userId;
+    body += r.message;
+
+    string out;
+    putRaw<uint32_t>(out, body.size());
+    putRaw<uint32_t>(out, crc32(body.data(), body.size()));
+    return out + body;
+}
+
+static OutboxRecord decode(const string& body) {
+    const char* p = body.data();
+    OutboxRecord r;
+    r.id = getRaw<uint64_t>(p);
+    r.attempts = getRaw<uint32_t>(p);
+    r.nextAttemptMs = getRaw<int64_t>(p);
+    uint32_t userLen = getRaw<uint32_t>(p);
+    r.userId.assign(p, userLen);
+    p += userLen;
+    r.message.assign(p, body.data() + body.size() - p);
+    return r;
+}
+
+
+//////////////////////////////////////////
+// Segmented append-only log
+//////////////////////////////////////////
+
+// Position of a record : high bits = segment number, low 40 bits = byte offset.
+using LogPosition = uint64_t;
+static constexpr int kOffsetBits = 40;
+
+static LogPosition makePosition(uint64_t segment, uint64_t offset) {
+    return (segment << kOffsetBits) | offset;
+}
+
+class SegmentedLog {
+private:
+    struct Segment {
+        uint64_t number;
+        int fd;
+        uint64_t size;
+    };
+
+    fs::path dir;
+    uint64_t segmentBytes;
+    bool syncEveryAppend;
+    mutable mutex lock;
+    deque<Segment> segments;
+
+    fs::path segmentPath(uint64_t number) const {
+        char name[32];
+        snprintf(name, sizeof(name), "seg-%06llu.log", (unsigned long long)number);
+        return dir / name;
+    }
+
+    void openSegment(uint64_t number) {
+        int fd = ::open(segmentPath(number).c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) throw runtime_error("cannot open segment " + segmentPath(number).string());
+        segments.push_back({number, fd, (uint64_t)lseek(fd, 0, SEEK_END)});
+    }
+
+    // Reads one record at offset. Returns false at end of data or on a torn/corrupt record.
+    static bool readAt(int fd, uint64_t fileSize, uint64_t offset, string& body) {
+        if (offset + 8 > fileSize) return false;
+        uint32_t header[2];
+        if (pread(fd, header, 8, offset) != 8) return false;
+        if (offset + 8 + header[0] > fileSize) return false;
+        body.resize(header[0]);
+        if (pread(fd, body.data(), header[0], offset + 8) != (ssize_t)header[0]) return false;
+        return crc32(body.data(), body.size()) == header[1];
+    }
+
+    // Crash recovery : everything after the first bad record of the last segment
+    // was never acknowledged to anyone, so it is cut off.
+    void truncateTornTail() {
+        Segment& last = segments.back();
+        uint64_t offset = 0;
+        string body;
+        while (readAt(last.fd, last.size, offset, body)) offset += 8 + body.size();
+        if (offset != last.size) {
+            if (ftruncate(last.fd, offset) != 0) throw runtime_error("cannot truncate torn tail");
+            last.size = offset;
+        }
+    }
+
+public:
+    SegmentedLog(fs::path dir, uint64_t segmentBytes = 4 << 20, bool syncEveryAppend = false)
+        : dir(move(dir)), segmentBytes(segmentBytes), syncEveryAppend(syncEveryAppend) {
+        fs::create_directories(this->dir);
+        vector<uint64_t> numbers;
+        for (auto& entry : fs::directory_iterator(this->dir)) {
+            string name = entry.path().filename().string();
+            if (name.rfind("seg-", 0) == 0) numbers.push_back(stoull(name.substr(4, 6)));
+        }
+        sort(numbers.begin(), numbers.end());
+        for (uint64_t n : numbers) openSegment(n);
+        if (segments.empty()) openSegment(1);
+        truncateTornTail();
+    }
+
+    ~SegmentedLog() {
+        for (auto& s : segments) ::close(s.fd);
+    }
+
+    LogPosition append(const OutboxRecord& record) {
+        string bytes = encode(record);
+        lock_guard<mutex> guard(lock);
+        if (segments.back().size >= segmentBytes) openSegment(segments.back().number + 1);
+        Segment& seg = segments.back();
+        if (::write(seg.fd, bytes.data(), bytes.size()) != (ssize_t)bytes.size()) {
+            // cut off whatever part did land, so the next record starts where seg.size says
+            if (ftruncate(seg.fd, seg.size) != 0 || lseek(seg.fd, seg.size, SEEK_SET) < 0) {
+                throw runtime_error("outbox append failed and the partial record could not be removed");
+            }
+            throw runtime_error("outbox append failed");
+        }
+        if (syncEveryAppend) fdatasync(seg.fd);
+        LogPosition pos = makePosition(seg.number, seg.size);
+        seg.size += bytes.size();
+        return pos;
+    }
+
+    // Reads the record at pos. On success fills record, sets next to the following position.
+    bool read(LogPosition pos, OutboxRecord& record, LogPosition& next) const {
+        lock_guard<mutex> guard(lock);
+        uint64_t number = pos >> kOffsetBits;
+        uint64_t offset = pos & ((1ull << kOffsetBits) - 1);
+        for (size_t i = 0; i < segments.size(); i++) {
+            const Segment& seg = segments[i];
+            if (seg.number < number) continue;
+            if (seg.number > number) offset = 0;   // moved on to a newer segment
+            string body;
+            if (readAt(seg.fd, seg.size, offset, body)) {
+                record = decode(body);
+                next = makePosition(seg.number, offset + 8 + body.size());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    LogPosition begin() const {
+        lock_guard<mutex> guard(lock);
+        return makePosition(segments.front().number, 0);
+    }
+
+    // Deletes segments that lie completely before pos.
+    void dropBefore(LogPosition pos) {
+        lock_guard<mutex> guard(lock);
+        uint64_t number = pos >> kOffsetBits;
+        while (segments.size() > 1 && segments.front().number < number) {
+            ::close(segments.front().fd);
+            fs::remove(segmentPath(segments.front().number));
+            segments.pop_front();
+        }
+    }
+
+    void sync() {
+        lock_guard<mutex> guard(lock);
+        for (auto& s : segments) fdatasync(s.fd);
+    }
+
+    size_t segmentCount() const {
+        lock_guard<mutex> guard(lock);
+        return segments.size();
+    }
+};
+
+
+//////////////////////////////////////////
+// Outbox : producer side + delivery workers
+//////////////////////////////////////////
+
+struct RetryPolicy {
+    int maxAttempts = 5;
+    int64_t baseMs = 50;
+    int64_t capMs = 60000;
+
+    int64_t backoffMs(uint32_t attempt, mt19937_64& rng) const {
+        int64_t ceiling = min(capMs, baseMs << min<uint32_t>(attempt, 30));
+        return uniform_int_distribution<int64_t>(0, ceiling)(rng);
+    }
+};
+
+class NotificationOutbox {
+private:
+    fs::path dir;
+    SegmentedLog log;
+    SegmentedLog deadLetters;
+    RetryPolicy policy;
+    atomic<uint64_t> nextId;
+
+    fs::path cursorPath() const { return dir / "cursor"; }
+
+    LogPosition loadCursor() const {
+        ifstream in(cursorPath(), ios::binary);
+        LogPosition pos = 0;
+        if (in.read(reinterpret_cast<char*>(&pos), sizeof(pos))) return pos;
+        return log.begin();
+    }
+
+    void storeCursor(LogPosition pos) {
+        fs::path tmp = dir / "cursor.tmp";
+        {
+            int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) throw runtime_error("cannot write cursor");
+            bool ok = ::write(fd, &pos, sizeof(pos)) == (ssize_t)sizeof(pos);
+            fdatasync(fd);
+            ::close(fd);
+            if (!ok) throw runtime_error("cannot write cursor");
+        }
+        fs::rename(tmp, cursorPath());
+        log.dropBefore(pos);
+    }
+
+public:
+    NotificationOutbox(fs::path dir, RetryPolicy policy = {}, bool syncEveryAppend = false)
+        : dir(dir), log(dir / "log", 4 << 20, syncEveryAppend),
+          deadLetters(dir / "dead", 4 << 20, true), policy(policy),
+          nextId(static_cast<uint64_t>(wallMillis()) << 20) {}
+
+    // Called from the booking path. Once this returns the message will be delivered
+    // (or dead-lettered) even if the process crashes right after.
+    uint64_t enqueue(const string& userId, const string& message) {
+        OutboxRecord r;
+        r.id = nextId++;
+        r.userId = userId;
+        r.message = message;
+        log.append(r);
+        return r.id;
+    }
+
+    struct DrainStats {
+        long delivered = 0;
+        long retried = 0;
+        long deadLettered = 0;
+    };
+
+    // Delivers everything in the log with `workers` threads. Returns when every
+    // record (including retries) is delivered or dead-lettered, or when stopAfter
+    // deliveries were attempted (used to simulate a crash in the middle).
+    DrainStats drain(Notifier& notifier, int workers, long stopAfter = LONG_MAX) {
+        struct Item {
+            LogPosition pos;
+            OutboxRecord record;
+        };
+        auto laterFirst = [](const Item& a, const Item& b) {
+            return a.record.nextAttemptMs > b.record.nextAttemptMs;
+        };
+
+        mutex m;
+        condition_variable cv;
+        deque<Item> ready;
+        priority_queue<Item, vector<Item>, decltype(laterFirst)> delayed(laterFirst);
+        set<LogPosition> outstanding;      // read but not yet finished
+        LogPosition readPos = loadCursor();
+        long attempted = 0;
+        bool stopping = false;
+        exception_ptr workerError;         // first failure to write a retry / dead letter
+        DrainStats stats;
+
+        // Cursor = first position that is not finished yet.
+        LogPosition committed = readPos;
+        auto commit = [&] {
+            LogPosition pos = outstanding.empty() ? readPos : *outstanding.begin();
+            if (pos != committed) {
+                storeCursor(pos);
+                committed = pos;
+            }
+        };
+
+        auto worker = [&](int seed) {
+            mt19937_64 rng(seed * 7919 + wallMillis());
+            unique_lock<mutex> lk(m);
+            while (true) {
+                cv.wait(lk, [&] { return stopping || !ready.empty(); });
+                if (ready.empty()) return;
+                Item item = move(ready.front());
+                ready.pop_front();
+                lk.unlock();
+
+                bool ok = true;
+                try {
+                    notifier.notify(item.record.userId, item.record.message);
+                } catch (...) {
+                    ok = false;            // any provider failure is retried, whatever it throws
+                }
+
+                bool dead = false;
+                if (!ok) {
+                    // the retry (or dead letter) is made durable before the original
+                    // is marked finished, so a crash in between only duplicates
+                    OutboxRecord retry = item.record;
+                    retry.attempts++;
+                    try {
+                        if ((int)retry.attempts >= policy.maxAttempts) {
+                            deadLetters.append(retry);
+                            dead = true;
+                        } else {
+                            retry.nextAttemptMs = wallMillis() + policy.backoffMs(retry.attempts, rng);
+                            log.append(retry);
+                        }
+                    } catch (...) {
+                        // e.g. disk full : the original stays outstanding, so the cursor never
+                        // passes it and it is delivered again after the drain is restarted
+                        lk.lock();
+                        if (!workerError) workerError = current_exception();
+                        cv.notify_all();
+                        return;
+                    }
+                }
+
+                lk.lock();
+                outstanding.erase(item.pos);
+                if (ok) stats.delivered++;
+                else if (dead) stats.deadLettered++;
+                else stats.retried++;
+                cv.notify_all();
+            }
+        };
+
+        vector<thread> pool;
+        unique_lock<mutex> lk(m, defer_lock);
+        // On every way out (including a throw below) : stop and join the workers.
+        struct Shutdown {
+            unique_lock<mutex>& lk;
+            bool& stopping;
+            condition_variable& cv;
+            vector<thread>& pool;
+            ~Shutdown() {
+                if (!lk.owns_lock()) lk.lock();
+                stopping = true;
+                cv.notify_all();
+                lk.unlock();
+                for (auto& t : pool) if (t.joinable()) t.join();
+            }
+        } shutdown{lk, stopping, cv, pool};
+        for (int i = 0; i < workers; i++) pool.emplace_back(worker, i);
+
+        lk.lock();
+        while (!workerError) {
+            // pull newly visible records (retries are appended at the end too)
+            OutboxRecord record;
+            LogPosition next;
+            int pulled = 0;
+            while (attempted < stopAfter && pulled < 4096 && log.read(readPos, record, next)) {
+                outstanding.insert(readPos);
+                Item item{readPos, move(record)};
+                if (item.record.nextAttemptMs <= wallMillis()) {
+                    ready.push_back(move(item));
+                    attempted++;
+                } else {
+                    delayed.push(move(item));
+                }
+                readPos = next;
+                pulled++;
+            }
+            while (!delayed.empty() && delayed.top().record.nextAttemptMs <= wallMillis()
+                   && attempted < stopAfter) {
+                ready.push_back(delayed.top());
+                delayed.pop();
+                attempted++;
+            }
+            if (!ready.empty()) cv.notify_all();
+            commit();
+
+            bool caughtUp = !log.read(readPos, record, next);
+            if (attempted >= stopAfter) {
+                // record the progress made so far, then "crash" with work in flight
+                cv.wait(lk, [&] { return ready.empty() || workerError; });
+                if (!workerError) commit();
+                break;
+            }
+            if (caughtUp && outstanding.empty()) break;
+
+            if (pulled == 0) {
+                // nothing new : sleep until a worker finishes or a retry is due
+                auto wake = Clock::now() + chrono::milliseconds(
+                    delayed.empty() ? 5 : max<int64_t>(1, delayed.top().record.nextAttemptMs - wallMillis()));
+                cv.wait_until(lk, wake);
+            }
+        }
+        stopping = true;
+        cv.notify_all();
+        lk.unlock();
+        for (auto& t : pool) t.join();
+        lk.lock();
+        if (workerError) rethrow_exception(workerError);
+        if (stopAfter == LONG_MAX) commit();
+        return stats;
+    }
+
+    size_t segmentCount() const { return log.segmentCount(); }
+};
+
+
+//////////////////////////////////////////
+// Fake providers
+//////////////////////////////////////////
+
+class EmailNotifier : public Notifier {
+public:
+    void notify(const string& userId, const string& message) override {
+        cout << "Email to " << userId << " : " << message << "\n";
+    }
+};
+
+// Fails a fixed fraction of sends, and remembers what it delivered.
+class FlakyNotifier : public Notifier {
+private:
+    double failRate;
+    mutex lock;
+    mt19937 rng{42};
+
+public:
+    multiset<string> delivered;
+
+    FlakyNotifier(double failRate) : failRate(failRate) {}
+
+    void notify(const string& userId, const string& message) override {
+        lock_guard<mutex> guard(lock);
+        if (uniform_real_distribution<double>(0, 1)(rng) < failRate) {
+            throw runtime_error("provider unavailable");
+        }
+        delivered.insert(userId + "|" + message);
+    }
+};
+
+
+//////////////////////////////////////////
+// Crash-recovery checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void recoversFromTornWrite(const fs::path& dir) {
+    fs::remove_all(dir);
+    {
+        NotificationOutbox outbox(dir);
+        for (int i = 0; i < 10; i++) outbox.enqueue("u" + to_string(i), "Your ticket is booked!");
+    }
+    // simulate a crash in the middle of writing record #11
+    fs::path seg = dir / "log" / "seg-000001.log";
+    {
+        ofstream out(seg, ios::binary | ios::app);
+        out.write("\x40\x00\x00\x00garbage", 11);
+    }
+    NotificationOutbox reopened(dir);
+    FlakyNotifier provider(0.0);
+    auto stats = reopened.drain(provider, 2);
+    check(stats.delivered == 10, "torn tail is cut off and all 10 complete records are delivered");
+}
+
+void resumesAfterCrashMidDrain(const fs::path& dir) {
+    fs::remove_all(dir);
+    FlakyNotifier provider(0.0);
+    {
+        NotificationOutbox outbox(dir);
+        for (int i = 0; i < 1000; i++) outbox.enqueue("u" + to_string(i), "booking " + to_string(i));
+        outbox.drain(provider, 2, 400);   // "crash" after ~400 deliveries
+    }
+    NotificationOutbox reopened(dir);
+    reopened.drain(provider, 2);
+    bool all = true;
+    for (int i = 0; i < 1000; i++) {
+        all &= provider.delivered.count("u" + to_string(i) + "|booking " + to_string(i)) >= 1;
+    }
+    check(all, "every record is delivered at least once after restarting mid-drain");
+    check(provider.delivered.size() <= 1000 + 2, "only records in flight at the crash are sent twice");
+}
+
+void deadLettersPoisonMessages(const fs::path& dir) {
+    fs::remove_all(dir);
+    FlakyNotifier provider(1.0);
+    NotificationOutbox outbox(dir, RetryPolicy{3, 1, 4});
+    for (int i = 0; i < 20; i++) outbox.enqueue("u" + to_string(i), "never delivered");
+    auto stats = outbox.drain(provider, 2);
+    check(stats.deadLettered == 20 && stats.retried == 40,
+          "always-failing messages are retried twice and then dead-lettered");
+}
+
+void rollsBackShortAppend(const fs::path& dir) {
+    fs::remove_all(dir);
+    fs::path seg = dir / "log" / "seg-000001.log";
+    bool threw = false;
+    uintmax_t before;
+    {
+        NotificationOutbox outbox(dir);
+        for (int i = 0; i < 5; i++) outbox.enqueue("u" + to_string(i), "Your ticket is booked!");
+        before = fs::file_size(seg);
+
+        // a file size limit a few bytes past the end makes the next write() come back short
+        rlimit old;
+        getrlimit(RLIMIT_FSIZE, &old);
+        auto oldHandler = signal(SIGXFSZ, SIG_IGN);
+        rlimit tight = {before + 4, old.rlim_max};
+        setrlimit(RLIMIT_FSIZE, &tight);
+        try { outbox.enqueue("u5", "Your ticket is booked!"); } catch (const runtime_error&) { threw = true; }
+        setrlimit(RLIMIT_FSIZE, &old);
+        signal(SIGXFSZ, oldHandler);
+
+        outbox.enqueue("u6", "Your ticket is booked!");
+    }
+    NotificationOutbox reopened(dir);
+    FlakyNotifier provider(0.0);
+    auto stats = reopened.drain(provider, 1);
+    check(threw && stats.delivered == 6 && provider.delivered.count("u6|Your ticket is booked!") == 1 &&
+          fs::file_size(seg) > before,
+          "a short append is cut back, and the next record lands right after the last complete one");
+}
+
+void drainStopsWhenRetryCannotBeWritten(const fs::path& dir) {
+    fs::remove_all(dir);
+    bool threw = false;
+    {
+        NotificationOutbox outbox(dir);
+        for (int i = 0; i < 5; i++) outbox.enqueue("u" + to_string(i), "Your ticket is booked!");
+
+        // every send fails, and the log cannot grow : the retry append fails inside a worker
+        rlimit old;
+        getrlimit(RLIMIT_FSIZE, &old);
+        auto oldHandler = signal(SIGXFSZ, SIG_IGN);
+        rlimit tight = {fs::file_size(dir / "log" / "seg-000001.log"), old.rlim_max};
+        setrlimit(RLIMIT_FSIZE, &tight);
+        FlakyNotifier down(1.0);
+        try { outbox.drain(down, 2); } catch (const runtime_error&) { threw = true; }
+        setrlimit(RLIMIT_FSIZE, &old);
+        signal(SIGXFSZ, oldHandler);
+    }
+    NotificationOutbox reopened(dir);
+    FlakyNotifier provider(0.0);
+    reopened.drain(provider, 2);
+    bool all = true;
+    for (int i = 0; i < 5; i++) all &= provider.delivered.count("u" + to_string(i) + "|Your ticket is booked!") >= 1;
+    check(threw && all, "a worker that cannot write a retry stops the drain with its error, and nothing is lost");
+}
+
+// Throws something that is not a std::exception.
+class OddNotifier : public Notifier {
+public:
+    void notify(const string&, const string&) override { throw 42; }
+};
+
+void retriesNonStandardExceptions(const fs::path& dir) {
+    fs::remove_all(dir);
+    OddNotifier provider;
+    NotificationOutbox outbox(dir, RetryPolicy{2, 1, 4});
+    for (int i = 0; i < 5; i++) outbox.enqueue("u" + to_string(i), "never delivered");
+    auto stats = outbox.drain(provider, 2);
+    check(stats.deadLettered == 5 && stats.retried == 5, "a provider throwing a non-std exception is retried, not fatal");
+}
+
+
+//////////////////////////////////////////
+// Drain throughput benchmark
+//////////////////////////////////////////
+
+void benchmarkDrain(const fs::path& dir, int records, double failRate, int workers) {
+    fs::remove_all(dir);
+    NotificationOutbox outbox(dir, RetryPolicy{6, 1, 16});
+    FlakyNotifier provider(failRate);
+
+    auto start = Clock::now();
+    for (int i = 0; i < records; i++) outbox.enqueue("user-" + to_string(i), "Your ticket is booked!");
+    double appendSec = chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    auto stats = outbox.drain(provider, workers);
+    double drainSec = chrono::duration<double>(Clock::now() - start).count();
+
+    cout << records << " records, fail rate " << failRate << ", " << workers << " workers : "
+         << "append " << (long)(records / appendSec) << "/s, drain " << (long)(records / drainSec) << "/s"
+         << " (delivered " << stats.delivered << ", retried " << stats.retried
+         << ", dead " << stats.deadLettered << ")\n";
+}
+
+
+int main() {
+    fs::path base = fs::temp_directory_path() / "notification_outbox_demo";
+
+    // booking path only appends, the provider is called by the workers
+    {
+        fs::remove_all(base);
+        NotificationOutbox outbox(base);
+        outbox.enqueue("u123", "Your ticket is booked!");
+        EmailNotifier email;
+        outbox.drain(email, 1);
+    }
+
+    cout << "\n--- crash recovery ---\n";
+    recoversFromTornWrite(base);
+    resumesAfterCrashMidDrain(base);
+    deadLettersPoisonMessages(base);
+    rollsBackShortAppend(base);
+    retriesNonStandardExceptions(base);
+    drainStopsWhenRetryCannotBeWritten(base);
+
+    cout << "\n--- drain throughput ---\n";
+    benchmarkDrain(base, 100000, 0.0, 4);
+    benchmarkDrain(base, 100000, 0.05, 4);
+    benchmarkDrain(base, 100000, 0.20, 4);
+
+    fs::remove_all(base);
+    return 0;
+}
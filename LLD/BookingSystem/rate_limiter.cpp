@@ -0,0 +1,458 @@
+/*
+
+Rate Limiter for EmailSender / SmsSender / PushSender
+
+In SRP/examples.cpp we split notifications into EmailSender, SmsSender and PushSender.
+Each of them calls an external provider (SendGrid, Twilio, Firebase ...) and every
+provider throttles us. If we keep sending after being throttled, every failed send
+gets retried and we end up in a retry storm.
+
+So we put a limiter in front of every sender with two kinds of limits:
+
+> Per-provider (global) limit  : e.g. SendGrid allows 100 mails/sec for the account
+> Per-recipient limit          : e.g. at most 3 SMS per user per minute
+
+Algorithm used : GCRA (Generic Cell Rate Algorithm)
+
+GCRA is a token bucket written differently. Instead of storing "tokens left" and a
+refill timer, it stores only ONE number : TAT (theoretical arrival time).
+
+    T   = emission interval = 1 / rate
+    tau = burst tolerance   = (burst - 1) * T
+
+    On a request at time now :
+        tat = max(TAT, now)
+        if (tat - now > tau)  -> reject, retry after (tat - tau - now)
+        else                  -> allow,  TAT = tat + T
+
+> One 64-bit number per bucket -> one atomic CAS, no lock (lock-free).
+> Refill is lazy : nothing runs in the background, "now" does the refilling.
+> On reject we know exactly how long to wait, so the caller can defer the send
+  instead of spinning on it.
+> Per-recipient buckets live in a fixed open-addressing table, so the send path finds
+  its bucket with plain atomic loads too; only adding a new recipient takes a lock.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+static int64_t nowNanos() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Result of an acquire : either allowed, or denied with the delay after which to retry.
+struct Permit {
+    bool allowed;
+    chrono::nanoseconds retryAfter;
+};
+
+struct RateLimit {
+    double perSecond;   // sustained rate
+    int burst;          // how many requests may go back to back
+};
+
+
+//////////////////////////////////////////
+// Lock-free GCRA bucket
+//////////////////////////////////////////
+
+class GcraBucket {
+private:
+    int64_t interval;          // T
+    int64_t tolerance;         // tau
+    atomic<int64_t> tat{0};    // theoretical arrival time
+
+public:
+    GcraBucket(const RateLimit& limit) {
+        if (!(limit.perSecond > 0) || !isfinite(limit.perSecond)) {
+            throw invalid_argument("rate must be a positive number per second");
+        }
+        if (limit.perSecond > 1e9) throw invalid_argument("rate above 1e9/sec is below clock resolution");
+        if (limit.burst < 1) throw invalid_argument("burst must be at least 1");
+        double period = 1e9 / limit.perSecond;
+        if (period * limit.burst >= 9e18) throw invalid_argument("rate too slow for this burst");
+        interval = static_cast<int64_t>(period);
+        tolerance = interval * (limit.burst - 1);
+    }
+
+    Permit tryAcquire(int64_t now) {
+        int64_t current = tat.load(memory_order_relaxed);
+        while (true) {
+            int64_t base = max(current, now);
+            if (base - now > tolerance) {
+                return {false, chrono::nanoseconds(base - tolerance - now)};
+            }
+            // on failure current is reloaded and we try again
+            if (tat.compare_exchange_weak(current, base + interval, memory_order_acq_rel)) {
+                return {true, chrono::nanoseconds(0)};
+            }
+        }
+    }
+
+    // Give back a token taken by tryAcquire (used when a later check fails).
+    void release() {
+        tat.fetch_sub(interval, memory_order_acq_rel);
+    }
+
+    // A bucket whose TAT is in the past is completely refilled,
+    // so forgetting it is the same as keeping it.
+    bool isFull(int64_t now) const {
+        return tat.load(memory_order_relaxed) <= now;
+    }
+
+    int64_t nanosUntilFull(int64_t now) const {
+        return max<int64_t>(tat.load(memory_order_relaxed) - now, 0);
+    }
+};
+
+
+//////////////////////////////////////////
+// Per-recipient buckets in an open-addressing table
+//////////////////////////////////////////
+
+// A recipient is a 64-bit hash of its address that owns one slot among the kProbe slots
+// after its home slot. Finding it is a few atomic loads, then the bucket CAS : no lock on
+// the send path. The lock is taken only to give a new recipient a slot, so two threads
+// can never hand the same recipient two slots.
+//
+// A slot whose bucket is full can be handed to another recipient : a full bucket is the
+// same as no bucket, so nothing is forgotten. The table never grows; memory is fixed by
+// `slots`, and only recipients that are being throttled right now hold on to a slot.
+class RecipientLimiter {
+private:
+    static constexpr size_t kProbe = 16;
+
+    struct Slot {
+        atomic<uint64_t> key{0};   // 0 = never used
+        GcraBucket bucket;
+
+        Slot(const RateLimit& limit) : bucket(limit) {}
+    };
+
+    deque<Slot> table;   // deque : slots are built in place and never move
+    mutex claimLock;
+
+    static uint64_t keyOf(const string& recipient) {
+        return hash<string>{}(recipient) | 1;   // two recipients on one 64-bit hash share a bucket
+    }
+
+    Slot* find(uint64_t key) {
+        size_t home = key % table.size();
+        for (size_t i = 0; i < kProbe; i++) {
+            Slot& slot = table[(home + i) % table.size()];
+            uint64_t k = slot.key.load(memory_order_acquire);
+            if (k == key) return &slot;
+            if (k == 0) return nullptr;   // slots are filled in probe order
+        }
+        return nullptr;
+    }
+
+    // Under claimLock. Returns the slot now owned by key, or nullptr when every slot in
+    // its window is held by a recipient that is still throttled.
+    Slot* claim(uint64_t key, int64_t now) {
+        if (Slot* mine = find(key)) return mine;
+        size_t home = key % table.size();
+        for (size_t i = 0; i < kProbe; i++) {
+            Slot& slot = table[(home + i) % table.size()];
+            if (slot.key.load(memory_order_relaxed) == 0 || slot.bucket.isFull(now)) {
+                slot.key.store(key, memory_order_release);
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    int64_t untilFreeSlot(uint64_t key, int64_t now) {
+        size_t home = key % table.size();
+        int64_t soonest = INT64_MAX;
+        for (size_t i = 0; i < kProbe; i++) {
+            soonest = min(soonest, table[(home + i) % table.size()].bucket.nanosUntilFull(now));
+        }
+        return max<int64_t>(soonest, 1);
+    }
+
+public:
+    RecipientLimiter(RateLimit limit, size_t slots = 1 << 16) {
+        if (slots < kProbe) throw invalid_argument("recipient table needs at least " + to_string(kProbe) + " slots");
+        for (size_t i = 0; i < slots; i++) table.emplace_back(limit);
+    }
+
+    Permit tryAcquire(const string& recipient, int64_t now) {
+        uint64_t key = keyOf(recipient);
+        while (true) {
+            Slot* slot = find(key);
+            if (!slot) {
+                lock_guard<mutex> guard(claimLock);
+                slot = claim(key, now);
+                if (!slot) return {false, chrono::nanoseconds(untilFreeSlot(key, now))};
+            }
+            Permit permit = slot->bucket.tryAcquire(now);
+            // the slot was handed to another recipient between find and the CAS :
+            // the token came out of its bucket, give it back and look again
+            if (slot->key.load(memory_order_acquire) == key) return permit;
+            if (permit.allowed) slot->bucket.release();
+        }
+    }
+
+    void release(const string& recipient) {
+        if (Slot* slot = find(keyOf(recipient))) slot->bucket.release();
+    }
+
+    size_t trackedRecipients(int64_t now) {
+        size_t total = 0;
+        for (auto& slot : table) {
+            total += slot.key.load(memory_order_relaxed) != 0 && !slot.bucket.isFull(now);
+        }
+        return total;
+    }
+};
+
+
+//////////////////////////////////////////
+// Provider limiter = global bucket + recipient buckets
+//////////////////////////////////////////
+
+class ProviderLimiter {
+private:
+    GcraBucket global;
+    RecipientLimiter recipients;
+
+public:
+    ProviderLimiter(RateLimit globalLimit, RateLimit recipientLimit, size_t recipientSlots = 1 << 16)
+        : global(globalLimit), recipients(recipientLimit, recipientSlots) {}
+
+    Permit tryAcquire(const string& recipient) { return tryAcquire(recipient, nowNanos()); }
+
+    Permit tryAcquire(const string& recipient, int64_t now) {
+        Permit perUser = recipients.tryAcquire(recipient, now);
+        if (!perUser.allowed) return perUser;
+
+        Permit perProvider = global.tryAcquire(now);
+        if (!perProvider.allowed) {
+            // the recipient did nothing wrong, give its token back
+            recipients.release(recipient);
+        }
+        return perProvider;
+    }
+
+    // recipients currently holding a slot because their bucket is not full
+    size_t trackedRecipients() { return recipients.trackedRecipients(nowNanos()); }
+};
+
+
+//////////////////////////////////////////
+// Senders (same as SRP/examples.cpp)
+//////////////////////////////////////////
+
+class EmailSender {
+public:
+    void send(const std::string& to, const std::string& message) {
+        std::cout << "Sending Email to " << to << ": " << message << std::endl;
+    }
+};
+
+class SmsSender {
+public:
+    void send(const std::string& to, const std::string& message) {
+        std::cout << "Sending SMS to " << to << ": " << message << std::endl;
+    }
+};
+
+class PushSender {
+public:
+    void send(const std::string& to, const std::string& message) {
+        std::cout << "Sending Push Notification to " << to << ": " << message << std::endl;
+    }
+};
+
+// The senders stay unchanged (SRP) : limiting is a separate reason to change,
+// so it lives in its own wrapper. When the limit is hit the message is not sent
+// and the caller gets the delay back to schedule it later.
+template <typename Sender>
+class RateLimitedSender {
+private:
+    Sender& sender;
+    ProviderLimiter& limiter;
+
+public:
+    RateLimitedSender(Sender& sender, ProviderLimiter& limiter) : sender(sender), limiter(limiter) {}
+
+    Permit send(const string& to, const string& message) {
+        Permit permit = limiter.tryAcquire(to);
+        if (permit.allowed) {
+            sender.send(to, message);
+        }
+        return permit;
+    }
+};
+
+
+//////////////////////////////////////////
+// Benchmark : cost of one acquire under contention
+//////////////////////////////////////////
+
+void benchmarkAcquire(int threads, int opsPerThread) {
+    // limits high enough that most calls take the "allowed" path with real CAS traffic
+    ProviderLimiter limiter({1e9, 1000000}, {1e7, 1000});
+    atomic<long> allowed{0};
+    vector<thread> workers;
+
+    auto start = Clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            vector<string> users;
+            for (int i = 0; i < 1024; i++) users.push_back("user-" + to_string(t * 1024 + i));
+            long ok = 0;
+            for (int i = 0; i < opsPerThread; i++) {
+                ok += limiter.tryAcquire(users[i & 1023]).allowed;
+            }
+            allowed += ok;
+        });
+    }
+    for (auto& w : workers) w.join();
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+
+    long total = (long)threads * opsPerThread;
+    cout << threads << " threads : " << ns / total << " ns/acquire, "
+         << total / (ns / 1e9) / 1e6 << " M acquires/sec, allowed " << allowed << "/" << total << "\n";
+}
+
+void benchmarkGlobalBucket(int threads, int opsPerThread) {
+    // one hot atomic shared by every thread : worst case for the CAS loop
+    GcraBucket bucket({1e9, 1 << 30});
+    vector<thread> workers;
+
+    auto start = Clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < opsPerThread; i++) bucket.tryAcquire(nowNanos());
+        });
+    }
+    for (auto& w : workers) w.join();
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+    cout << threads << " threads (global bucket only) : "
+         << ns / ((long)threads * opsPerThread) << " ns/acquire\n";
+}
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    const int64_t t0 = 1'000'000'000'000, second = 1'000'000'000;
+    {
+        RecipientLimiter limiter({1, 3});
+        int allowed = 0;
+        for (int i = 0; i < 3; i++) allowed += limiter.tryAcquire("u1", t0).allowed;
+        Permit fourth = limiter.tryAcquire("u1", t0);
+        check(allowed == 3 && !fourth.allowed && fourth.retryAfter == chrono::seconds(1),
+              "a burst of 3 goes through back to back, the 4th waits one interval");
+    }
+    {
+        RecipientLimiter limiter({10, 1});
+        int allowed = 0;
+        for (int64_t ms = 0; ms < 10'000; ms++) allowed += limiter.tryAcquire("u1", t0 + ms * 1'000'000).allowed;
+        check(allowed == 100, "10/sec polled every ms for 10 s lets exactly 100 through");
+    }
+    {
+        RecipientLimiter limiter({1, 1});
+        bool first = limiter.tryAcquire("u1", t0).allowed;
+        bool again = limiter.tryAcquire("u1", t0).allowed;
+        limiter.release("u1");
+        check(first && !again && limiter.tryAcquire("u1", t0).allowed, "release() gives the token back");
+
+        ProviderLimiter provider({2, 1}, {1, 1});
+        provider.tryAcquire("u1", t0);
+        bool deniedByProvider = !provider.tryAcquire("u2", t0).allowed;
+        check(deniedByProvider && provider.tryAcquire("u2", t0 + second / 2).allowed,
+              "a recipient token is refunded when the provider limit says no");
+    }
+    {
+        RecipientLimiter limiter({1, 1});
+        bool u1 = limiter.tryAcquire("u1", t0).allowed;
+        bool u1Again = limiter.tryAcquire("u1", t0).allowed;
+        check(u1 && !u1Again && limiter.tryAcquire("u2", t0).allowed, "one recipient's limit does not touch another's");
+    }
+    {
+        RecipientLimiter limiter({1, 1}, 16);
+        int allowed = 0;
+        for (int i = 0; i < 16; i++) allowed += limiter.tryAcquire("u" + to_string(i), t0).allowed;
+        Permit crowded = limiter.tryAcquire("late", t0);
+        check(allowed == 16 && !crowded.allowed && crowded.retryAfter == chrono::seconds(1) &&
+              limiter.tryAcquire("late", t0 + second).allowed,
+              "a full table defers new recipients until a bucket refills, then reuses its slot");
+    }
+    {
+        auto rejects = [](RateLimit limit) {
+            try { GcraBucket bucket(limit); } catch (const invalid_argument&) { return true; }
+            return false;
+        };
+        check(rejects({0, 1}) && rejects({-1, 1}) && rejects({NAN, 1}) && rejects({1, 0}) &&
+              rejects({1e-9, 1 << 30}) && !rejects({1.0 / 30, 1}),
+              "zero, negative or NaN rates and bursts below 1 are rejected");
+    }
+    {
+        // a shared recipient plus 500 new ones per thread, all at the same instant
+        RecipientLimiter limiter({1e-3, 1000}, 4096);
+        atomic<int> shared{0}, fresh{0};
+        vector<thread> workers;
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < 1000; i++) shared += limiter.tryAcquire("hot", t0).allowed;
+                for (int i = 0; i < 500; i++) fresh += limiter.tryAcquire(to_string(t) + "-" + to_string(i), t0).allowed;
+            });
+        }
+        for (auto& w : workers) w.join();
+        check(shared == 1000 && fresh == 2000, "4 threads share one recipient's burst exactly and each new recipient gets its own bucket");
+    }
+}
+
+int main() {
+    checks();
+
+    EmailSender email;
+    SmsSender sms;
+
+    // SendGrid : 5 mails/sec, burst 5.  Each user : 2 mails back to back, then 1/sec.
+    ProviderLimiter emailLimits({5, 5}, {1, 2});
+    // Twilio : 10 sms/sec. Each user : 1 sms per 30 sec.
+    ProviderLimiter smsLimits({10, 10}, {1.0 / 30, 1});
+
+    RateLimitedSender<EmailSender> limitedEmail(email, emailLimits);
+    RateLimitedSender<SmsSender> limitedSms(sms, smsLimits);
+
+    for (int i = 0; i < 4; i++) {
+        Permit p = limitedEmail.send("u1@example.com", "Your ticket is booked!");
+        if (!p.allowed) {
+            cout << "Email deferred, retry after "
+                 << chrono::duration_cast<chrono::milliseconds>(p.retryAfter).count() << " ms\n";
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        Permit p = limitedSms.send("+911234567890", "OTP 4321");
+        if (!p.allowed) {
+            cout << "SMS deferred, retry after "
+                 << chrono::duration_cast<chrono::seconds>(p.retryAfter).count() << " s\n";
+        }
+    }
+
+    cout << "\n--- acquire cost under contention ---\n";
+    for (int threads : {1, 2, 4, 8}) {
+        benchmarkAcquire(threads, 200000);
+    }
+    for (int threads : {1, 4, 8}) {
+        benchmarkGlobalBucket(threads, 200000);
+    }
+
+    return 0;
+}
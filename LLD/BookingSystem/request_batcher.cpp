@@ -0,0 +1,369 @@
+/*
+
+Multi-Get Batching for Profile and Booking Lookups
+
+Problem :
+    UserProfileService::get(int userId) (SOLID/SRP/examples.cpp) and ITicketRepository only serve
+    one key per call. A page listing 50 attendees makes 50 round trips, and 1000 concurrent
+    requests for the same hot profile make 1000 identical backend calls.
+
+Solution :
+
+    getMany(span<const int>)   : one backend multi-get per call, duplicate keys fetched once
+
+    RequestBatcher<Key, Value> : sits in front of a multi-get backend and makes single-key
+                                 get() calls batch themselves
+        > the first caller of a window becomes its LEADER and waits up to `window` microseconds
+        > later callers in that window add their key (or join an existing one : dedupe)
+          and wait for the result
+        > the leader then sends ONE backend call with all distinct keys and hands each caller
+          its value. A window that reaches maxBatch keys is flushed at once by whoever filled it.
+        > a backend exception is delivered to every caller in the batch
+
+    The price is up to one window of extra latency per call; the benchmark measures it.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// The batcher
+//////////////////////////////////////////
+
+template <typename Key, typename Value>
+class RequestBatcher {
+public:
+    using MultiGet = function<vector<Value>(span<const Key>)>;
+
+    struct Stats {
+        long requests = 0;        // get() calls
+        long backendCalls = 0;
+        long backendKeys = 0;     // distinct keys sent
+    };
+
+private:
+    struct Batch {
+        vector<Key> keys;
+        unordered_map<Key, size_t> slot;
+        vector<Value> values;
+        exception_ptr error;
+        bool sent = false, done = false;
+        condition_variable changed;          // per batch : a finished batch wakes only its own callers
+    };
+
+    MultiGet backend;
+    chrono::microseconds window;
+    size_t maxBatch;
+
+    mutex lock;
+    shared_ptr<Batch> open;                  // the batch currently collecting keys
+    Stats stats;
+
+    // Called with the lock held; runs the backend call without it.
+    void dispatch(unique_lock<mutex>& guard, shared_ptr<Batch> batch) {
+        if (open == batch) open.reset();
+        batch->sent = true;
+        batch->changed.notify_all();         // the leader stops waiting for its window
+        stats.backendCalls++;
+        stats.backendKeys += batch->keys.size();
+        guard.unlock();
+        vector<Value> values;
+        exception_ptr error;
+        try {
+            values = backend(span<const Key>(batch->keys));
+            if (values.size() != batch->keys.size()) throw runtime_error("multi-get returned the wrong number of values");
+        } catch (...) {
+            error = current_exception();
+        }
+        guard.lock();
+        batch->values = move(values);
+        batch->error = error;
+        batch->done = true;
+        batch->changed.notify_all();
+    }
+
+public:
+    RequestBatcher(MultiGet backend, chrono::microseconds window, size_t maxBatch = 128)
+        : backend(move(backend)), window(window), maxBatch(maxBatch) {
+        if (maxBatch == 0) throw invalid_argument("maxBatch must be positive");
+    }
+
+    Value get(const Key& key) {
+        unique_lock<mutex> guard(lock);
+        stats.requests++;
+        bool leader = !open;
+        if (leader) open = make_shared<Batch>();
+        shared_ptr<Batch> batch = open;
+
+        auto [it, added] = batch->slot.try_emplace(key, batch->keys.size());
+        if (added) batch->keys.push_back(key);
+        size_t mine = it->second;
+
+        if (batch->keys.size() >= maxBatch) {
+            dispatch(guard, batch);
+        } else if (leader) {
+            auto deadline = Clock::now() + window;
+            batch->changed.wait_until(guard, deadline, [&] { return batch->sent; });
+            if (!batch->sent) dispatch(guard, batch);
+        }
+        batch->changed.wait(guard, [&] { return batch->done; });
+        if (batch->error) rethrow_exception(batch->error);
+        return batch->values[mine];
+    }
+
+    Stats statistics() {
+        lock_guard<mutex> guard(lock);
+        return stats;
+    }
+};
+
+// Straight multi-get with duplicate keys collapsed; results come back in request order.
+template <typename Key, typename Value, typename MultiGet>
+vector<Value> getManyDeduped(span<const Key> keys, MultiGet& backend) {
+    vector<Key> distinct;
+    unordered_map<Key, size_t> slot;
+    vector<size_t> position(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto [it, added] = slot.try_emplace(keys[i], distinct.size());
+        if (added) distinct.push_back(keys[i]);
+        position[i] = it->second;
+    }
+    vector<Value> fetched = backend(span<const Key>(distinct));
+    if (fetched.size() != distinct.size()) throw runtime_error("multi-get returned the wrong number of values");
+    vector<Value> out;
+    out.reserve(keys.size());
+    for (size_t p : position) out.push_back(fetched[p]);
+    return out;
+}
+
+
+//////////////////////////////////////////
+// Profiles + bookings behind a fake concurrent backend
+//////////////////////////////////////////
+
+struct UserProfile {
+    string name;
+    string email;
+    string profilePicture;
+};
+
+struct Booking {
+    int userId;
+    string movieId;
+};
+
+// Every call costs one round trip plus a little per key. Thread-safe; counts what it serves.
+class FakeBackend {
+private:
+    chrono::microseconds roundTrip, perKey;
+    atomic<long> calls{0}, keys{0};
+
+public:
+    FakeBackend(chrono::microseconds roundTrip, chrono::microseconds perKey) : roundTrip(roundTrip), perKey(perKey) {}
+
+    void call(size_t n) {
+        calls++;
+        keys += n;
+        this_thread::sleep_for(roundTrip + perKey * (long)n);
+    }
+
+    long callCount() const { return calls; }
+    long keyCount() const { return keys; }
+};
+
+class UserProfileService {
+private:
+    FakeBackend& db;
+    function<vector<optional<UserProfile>>(span<const int>)> multiGet;
+    RequestBatcher<int, optional<UserProfile>> batcher;
+    bool batching;
+
+    static optional<UserProfile> row(int userId) {
+        if (userId < 0) return nullopt;
+        string id = to_string(userId);
+        return UserProfile{"user" + id, "user" + id + "@example.com", "s3://pics/" + id + ".jpg"};
+    }
+
+public:
+    UserProfileService(FakeBackend& db, bool batching, chrono::microseconds window = chrono::microseconds(100))
+        : db(db),
+          multiGet([this](span<const int> ids) {
+              this->db.call(ids.size());
+              vector<optional<UserProfile>> out;
+              for (int id : ids) out.push_back(row(id));
+              return out;
+          }),
+          batcher(multiGet, window),
+          batching(batching) {}
+
+    optional<UserProfile> get(int userId) {
+        if (batching) return batcher.get(userId);
+        return multiGet(span<const int>(&userId, 1))[0];
+    }
+
+    vector<optional<UserProfile>> getMany(span<const int> userIds) {
+        return getManyDeduped<int, optional<UserProfile>>(userIds, multiGet);
+    }
+
+    RequestBatcher<int, optional<UserProfile>>::Stats batchStats() { return batcher.statistics(); }
+};
+
+class BookingLookup {
+private:
+    FakeBackend& db;
+    function<vector<optional<Booking>>(span<const int>)> multiGet;
+    RequestBatcher<int, optional<Booking>> batcher;
+
+public:
+    BookingLookup(FakeBackend& db, chrono::microseconds window = chrono::microseconds(100))
+        : db(db),
+          multiGet([this](span<const int> ids) {
+              this->db.call(ids.size());
+              vector<optional<Booking>> out;
+              for (int id : ids) out.push_back(id % 7 == 0 ? nullopt : optional<Booking>(Booking{id / 10, "m" + to_string(id % 10)}));
+              return out;
+          }),
+          batcher(multiGet, window) {}
+
+    optional<Booking> get(int bookingId) { return batcher.get(bookingId); }
+
+    vector<optional<Booking>> getMany(span<const int> bookingIds) {
+        return getManyDeduped<int, optional<Booking>>(bookingIds, multiGet);
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    {
+        FakeBackend db(chrono::microseconds(50), chrono::microseconds(0));
+        UserProfileService profiles(db, true);
+        vector<int> attendees;
+        for (int i = 0; i < 50; i++) attendees.push_back(i % 40);
+        auto page = profiles.getMany(attendees);
+        check(db.callCount() == 1 && db.keyCount() == 40 && page.size() == 50 && page[45]->name == "user5",
+              "getMany : one backend call, duplicates fetched once, results in request order");
+    }
+
+    {
+        FakeBackend db(chrono::microseconds(50), chrono::microseconds(0));
+        UserProfileService profiles(db, true, chrono::milliseconds(20));
+        vector<thread> callers;
+        vector<optional<UserProfile>> got(16);
+        for (int t = 0; t < 16; t++) callers.emplace_back([&, t] { got[t] = profiles.get(t % 4); });
+        for (auto& c : callers) c.join();
+        bool right = true;
+        for (int t = 0; t < 16; t++) right &= got[t] && got[t]->name == "user" + to_string(t % 4);
+        auto stats = profiles.batchStats();
+        check(right && stats.requests == 16 && db.keyCount() <= 4 * db.callCount() && db.callCount() < 16,
+              "concurrent get() calls merge and dedupe (16 calls -> " + to_string(db.callCount()) + " backend calls, " +
+                  to_string(db.keyCount()) + " keys)");
+    }
+
+    {
+        FakeBackend db(chrono::microseconds(10), chrono::microseconds(0));
+        BookingLookup bookings(db);
+        check(!bookings.get(14).has_value() && bookings.get(123)->movieId == "m3", "missing keys come back empty");
+    }
+
+    {
+        atomic<int> calls{0};
+        RequestBatcher<int, int> failing([&](span<const int>) -> vector<int> { calls++; throw runtime_error("db down"); },
+                                         chrono::milliseconds(20));
+        atomic<int> errors{0};
+        vector<thread> callers;
+        for (int t = 0; t < 4; t++) {
+            callers.emplace_back([&, t] {
+                try { failing.get(t); } catch (const runtime_error&) { errors++; }
+            });
+        }
+        for (auto& c : callers) c.join();
+        check(errors == 4 && calls < 4, "a backend error reaches every caller in the batch");
+    }
+
+    {
+        RequestBatcher<int, int> small([](span<const int> keys) { return vector<int>(keys.begin(), keys.end()); },
+                                       chrono::seconds(10), 1);
+        auto start = Clock::now();
+        check(small.get(7) == 7 && Clock::now() - start < chrono::seconds(1), "a full batch is sent without waiting for the window");
+    }
+}
+
+
+//////////////////////////////////////////
+// Benchmark
+//////////////////////////////////////////
+
+struct RunResult {
+    long calls, keys, requests;
+    double p50, p99;              // caller latency, microseconds
+};
+
+RunResult run(bool batching, int threads, int perThread, chrono::microseconds window) {
+    FakeBackend db(chrono::microseconds(300), chrono::microseconds(2));
+    UserProfileService profiles(db, batching, window);
+    vector<vector<double>> latency(threads);
+    vector<thread> callers;
+    for (int t = 0; t < threads; t++) {
+        callers.emplace_back([&, t] {
+            mt19937 rng(t);
+            for (int i = 0; i < perThread; i++) {
+                int user = rng() % 10 < 3 ? int(rng() % 20) : int(rng() % 100000);       // 30% go to 20 hot profiles
+                auto start = Clock::now();
+                auto profile = profiles.get(user);
+                latency[t].push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+                if (!profile) throw runtime_error("lookup failed");
+                this_thread::sleep_for(chrono::microseconds(500 + rng() % 1500));      // think time
+            }
+        });
+    }
+    for (auto& c : callers) c.join();
+    vector<double> all;
+    for (auto& l : latency) all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    return {db.callCount(), db.keyCount(), (long)all.size(), all[all.size() / 2], all[all.size() * 99 / 100]};
+}
+
+int main() {
+    checks();
+
+    const int threads = 64, perThread = 100;
+    cout << "\n--- " << threads << " threads x " << perThread << " profile lookups, backend = 300us round trip + 2us/key ---\n";
+    cout << left << setw(26) << "mode" << right << setw(15) << "backend calls" << setw(10) << "keys" << setw(16) << "keys/call"
+         << setw(12) << "p50" << setw(12) << "p99" << "\n";
+    auto row = [&](const string& label, RunResult r) {
+        cout << left << setw(26) << label << right << setw(15) << r.calls << setw(10) << r.keys << fixed << setprecision(1)
+             << setw(16) << (double)r.keys / r.calls << setw(10) << setprecision(0) << r.p50 << "us" << setw(10) << r.p99 << "us\n";
+    };
+    RunResult direct = run(false, threads, perThread, chrono::microseconds(0));
+    row("one call per get()", direct);
+    for (int w : {20, 100, 500}) {
+        RunResult batched = run(true, threads, perThread, chrono::microseconds(w));
+        row("batched, window " + to_string(w) + "us", batched);
+    }
+
+    FakeBackend db(chrono::microseconds(300), chrono::microseconds(2));
+    UserProfileService profiles(db, false);
+    vector<int> attendees(50);
+    iota(attendees.begin(), attendees.end(), 1000);
+    auto start = Clock::now();
+    for (int id : attendees) profiles.get(id);
+    double loop = chrono::duration<double, milli>(Clock::now() - start).count();
+    start = Clock::now();
+    profiles.getMany(attendees);
+    double many = chrono::duration<double, milli>(Clock::now() - start).count();
+    cout << "\nattendee page (50 profiles) : 50 x get() " << setprecision(2) << loop << " ms vs getMany() " << many << " ms\n";
+    return 0;
+}
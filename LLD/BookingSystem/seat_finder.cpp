@@ -0,0 +1,265 @@
+/*
+
+Best-Available Contiguous Seat Finder
+
+SeatChecker in SRP/theory.cpp only answers "is seat A1 free?". For a request like
+"6 seats together, best view first" we would call it seat by seat, row by row.
+
+Bitmap idea :
+
+    Every row is a bitmap, bit = 1 means the seat is FREE.
+
+        row C :  1 1 0 1 1 1 1 1 1 1 0 0 1 1 1
+                 (seat 0 is the lowest bit)
+
+    "Is there a run of N free seats starting at seat i ?"  is answered for ALL i at once :
+
+        runs = free
+        runs &= runs >> 1     ->  bit i set if seats i, i+1 are free
+        runs &= runs >> 2     ->  bit i set if seats i..i+3 are free
+        ...                       (shift by the length covered so far, ~log2(N) steps)
+
+    One AND + SHIFT checks 64 seats in one instruction. Set bits of `runs` are then
+    visited with countr_zero (one instruction per candidate).
+
+Scoring :
+    Every venue has a desirability map (centre seats of middle rows score highest).
+    Per row we keep prefix sums, so the score of any block is one subtraction.
+
+No locks :
+    Words are atomic. A search reads them with relaxed loads (it may see a slightly old
+    picture, that is fine for a suggestion). Booking a block is a CAS on the word(s);
+    if another booking won the race the CAS fails and we search again.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct SeatBlock {
+    int row = -1;
+    int start = -1;       // first seat index in the row
+    int count = 0;
+    double score = -numeric_limits<double>::infinity();
+
+    bool found() const { return row >= 0; }
+
+    string label() const {
+        if (!found()) return "none";
+        string rowName = row < 26 ? string(1, 'A' + row) : "R" + to_string(row + 1) + ":";
+        return rowName + to_string(start + 1) + "-" + rowName + to_string(start + count);
+    }
+};
+
+class SeatMap {
+private:
+    int rows, seatsPerRow, wordsPerRow;
+    vector<atomic<uint64_t>> free;       // rows * wordsPerRow words, bit = 1 -> free
+    vector<double> prefix;               // rows * (seatsPerRow + 1) desirability prefix sums
+
+    // For group sizes up to kMaxPruned : best score any block in the row could reach,
+    // and the rows sorted by it. Lets a search stop once no remaining row can win.
+    static constexpr int kMaxPruned = 16;
+    vector<vector<double>> rowBound;
+    vector<vector<int>> rowOrder;
+
+    atomic<uint64_t>& word(int row, int w) { return free[(size_t)row * wordsPerRow + w]; }
+
+    double blockScore(int row, int start, int count) const {
+        const double* p = &prefix[(size_t)row * (seatsPerRow + 1)];
+        return p[start + count] - p[start];
+    }
+
+    // runs[w] >> s across word boundaries, keeping only bits that stay inside the row.
+    static void shiftAnd(uint64_t* runs, int words, int s) {
+        int wordShift = s / 64, bitShift = s % 64;
+        for (int w = 0; w < words; w++) {
+            uint64_t lo = w + wordShift < words ? runs[w + wordShift] : 0;
+            uint64_t hi = w + wordShift + 1 < words ? runs[w + wordShift + 1] : 0;
+            uint64_t shifted = bitShift ? (lo >> bitShift) | (hi << (64 - bitShift)) : lo;
+            runs[w] &= shifted;
+        }
+    }
+
+    // Atomically flips `mask` bits of one word from free to taken. Fails if any is taken.
+    bool claimBits(atomic<uint64_t>& w, uint64_t mask) {
+        uint64_t current = w.load(memory_order_relaxed);
+        while ((current & mask) == mask) {
+            if (w.compare_exchange_weak(current, current & ~mask, memory_order_acq_rel)) return true;
+        }
+        return false;
+    }
+
+    static uint64_t maskFor(int from, int to) {       // bits [from, to) of one word
+        uint64_t upper = to >= 64 ? ~0ull : (1ull << to) - 1;
+        return upper & ~((1ull << from) - 1);
+    }
+
+public:
+    SeatMap(int rows, int seatsPerRow, function<double(int, int)> desirability)
+        : rows(rows), seatsPerRow(seatsPerRow), wordsPerRow((seatsPerRow + 63) / 64),
+          free((size_t)rows * ((seatsPerRow + 63) / 64)), prefix((size_t)rows * (seatsPerRow + 1)) {
+        for (int r = 0; r < rows; r++) {
+            for (int w = 0; w < wordsPerRow; w++) {
+                word(r, w).store(maskFor(0, min(64, seatsPerRow - w * 64)));
+            }
+            double* p = &prefix[(size_t)r * (seatsPerRow + 1)];
+            for (int s = 0; s < seatsPerRow; s++) p[s + 1] = p[s] + desirability(r, s);
+        }
+
+        rowBound.resize(kMaxPruned + 1);
+        rowOrder.resize(kMaxPruned + 1);
+        for (int count = 1; count <= min(kMaxPruned, seatsPerRow); count++) {
+            rowBound[count].resize(rows);
+            for (int r = 0; r < rows; r++) {
+                double best = -numeric_limits<double>::infinity();
+                for (int s = 0; s + count <= seatsPerRow; s++) best = max(best, blockScore(r, s, count));
+                rowBound[count][r] = best;
+            }
+            rowOrder[count].resize(rows);
+            iota(rowOrder[count].begin(), rowOrder[count].end(), 0);
+            stable_sort(rowOrder[count].begin(), rowOrder[count].end(),
+                        [&](int a, int b) { return rowBound[count][a] > rowBound[count][b]; });
+        }
+    }
+
+    int capacity() const { return rows * seatsPerRow; }
+
+    bool isSeatAvailable(int row, int seat) {
+        return word(row, seat / 64).load(memory_order_relaxed) >> (seat % 64) & 1;
+    }
+
+    // Best block of `count` adjacent free seats, by total desirability. Lock-free read.
+    SeatBlock findBest(int count) {
+        SeatBlock best;
+        if (count <= 0 || count > seatsPerRow) return best;
+        uint64_t runs[64];                                 // up to 4096 seats per row
+        if (wordsPerRow > 64) throw length_error("row too long");
+        bool pruned = count <= kMaxPruned;
+
+        for (int i = 0; i < rows; i++) {
+            int r = pruned ? rowOrder[count][i] : i;
+            if (pruned && rowBound[count][r] <= best.score) break;    // no later row can do better
+
+            bool any = false;
+            for (int w = 0; w < wordsPerRow; w++) {
+                runs[w] = word(r, w).load(memory_order_relaxed);
+                any |= runs[w] != 0;
+            }
+            if (!any) continue;
+
+            // after this loop bit i is set <=> seats i .. i+count-1 are all free
+            for (int covered = 1; covered < count;) {
+                int step = min(covered, count - covered);
+                shiftAnd(runs, wordsPerRow, step);
+                covered += step;
+            }
+
+            for (int w = 0; w < wordsPerRow; w++) {
+                for (uint64_t bits = runs[w]; bits; bits &= bits - 1) {
+                    int start = w * 64 + countr_zero(bits);
+                    double score = blockScore(r, start, count);
+                    if (score > best.score) best = {r, start, count, score};
+                }
+            }
+        }
+        return best;
+    }
+
+    // Marks the block as sold. Returns false (and changes nothing) if any seat was taken meanwhile.
+    bool claim(const SeatBlock& block) {
+        int first = block.start, last = block.start + block.count;     // [first, last)
+        vector<pair<int, uint64_t>> taken;
+        for (int w = first / 64; w <= (last - 1) / 64; w++) {
+            uint64_t mask = maskFor(max(first - w * 64, 0), min(last - w * 64, 64));
+            if (!claimBits(word(block.row, w), mask)) {
+                for (auto& [tw, tmask] : taken) word(block.row, tw).fetch_or(tmask);    // roll back
+                return false;
+            }
+            taken.push_back({w, mask});
+        }
+        return true;
+    }
+
+    // Search + claim, retrying when another booking wins the race.
+    SeatBlock bookBest(int count) {
+        while (true) {
+            SeatBlock block = findBest(count);
+            if (!block.found() || claim(block)) return block;
+        }
+    }
+
+    void sellRandom(double fillRate, mt19937& rng) {
+        uniform_real_distribution<double> coin(0, 1);
+        for (int r = 0; r < rows; r++) {
+            for (int s = 0; s < seatsPerRow; s++) {
+                if (coin(rng) < fillRate) word(r, s / 64).fetch_and(~(1ull << (s % 64)));
+            }
+        }
+    }
+};
+
+// Centre seats of rows ~60% back are the best view.
+function<double(int, int)> cinemaDesirability(int rows, int seatsPerRow) {
+    return [=](int r, int s) {
+        double centre = (seatsPerRow - 1) / 2.0;
+        double sideways = abs(s - centre) / max(centre, 1.0);
+        double depth = abs(r - 0.6 * rows) / rows;
+        return 1.0 - 0.5 * sideways - depth;
+    };
+}
+
+
+//////////////////////////////////////////
+// Benchmark
+//////////////////////////////////////////
+
+void benchmarkSearch(int rows, int seatsPerRow, double fillRate, int count) {
+    SeatMap venue(rows, seatsPerRow, cinemaDesirability(rows, seatsPerRow));
+    mt19937 rng(7);
+    venue.sellRandom(fillRate, rng);
+
+    int iterations = max(50, 2000000 / venue.capacity());
+    SeatBlock block;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) block = venue.findBest(count);
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count() / iterations;
+
+    cout << setw(6) << venue.capacity() << " seats (" << setw(3) << rows << " x " << setw(3) << seatsPerRow
+         << "), " << setw(3) << (int)(fillRate * 100) << "% sold : "
+         << setw(9) << fixed << setprecision(0) << ns << " ns/search, best " << block.label() << "\n";
+}
+
+
+int main() {
+    SeatMap hall(12, 20, cinemaDesirability(12, 20));
+
+    SeatBlock block = hall.bookBest(6);
+    cout << "Booked 6 together : " << block.label() << "\n";
+    block = hall.bookBest(6);
+    cout << "Next 6 together   : " << block.label() << "\n";
+    cout << "Seat H8 available ? " << hall.isSeatAvailable(7, 7) << "\n";
+
+    // concurrent bookings never get overlapping seats
+    atomic<int> seatsSold{12};
+    vector<thread> clerks;
+    for (int t = 0; t < 4; t++) {
+        clerks.emplace_back([&] {
+            while (hall.bookBest(4).found()) seatsSold += 4;
+        });
+    }
+    for (auto& c : clerks) c.join();
+    int actuallyTaken = 0;
+    for (int r = 0; r < 12; r++) for (int s = 0; s < 20; s++) actuallyTaken += !hall.isSeatAvailable(r, s);
+    cout << "Concurrent clerks sold " << seatsSold << " seats, bitmap shows " << actuallyTaken << " taken\n";
+
+    cout << "\n--- best block of 6, search latency ---\n";
+    vector<pair<int, int>> venues = {{20, 25}, {50, 100}, {100, 200}, {200, 400}};
+    for (auto [rows, perRow] : venues) {
+        for (double fill : {0.0, 0.5, 0.9, 0.98}) benchmarkSearch(rows, perRow, fill, 6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,593 @@
+/*
+
+Seat-State Snapshot + Log Replay for a Quick Warm Restart
+
+Problem :
+    Seat holds and sales live in memory. After a restart they would have to be rebuilt
+    from the repository one booking at a time, which is minutes of downtime at
+    10M sold seats.
+
+Solution : snapshot + log tail (like Redis RDB + AOF)
+
+    every change  ->  seats[seat] = state  +  append (lsn, seat, state, crc) to the booking log
+    periodically  ->  fork()  ->  child writes ALL seats to snapshot.tmp, rename -> snapshot.bin
+    restart       ->  load snapshot.bin (lsn S)  ->  replay only log records with lsn > S
+
+> fork() gives the child a copy-on-write view of memory frozen at lsn S, so the booking
+  path keeps running while the child writes. The only pause is fork() itself
+  (copying page tables), not the snapshot write.
+> At fork time the log is rotated : records <= S stay in the old segments, which are
+  deleted once the snapshot has been renamed into place.
+> Acknowledgement (Durability) :
+    Synced   (default) hold/sell/release return only after their record is on disk.
+             Group commit : the first waiter writes the whole buffer and runs one
+             fdatasync for every record appended so far; the others find their lsn
+             already durable. An acknowledged change survives a crash.
+    Buffered records sit in memory until bufferLimit of them are queued (or flush()).
+             Much faster, but a crash loses up to bufferLimit - 1 ACKNOWLEDGED changes.
+             Only for bulk loads that can be redone.
+> Each log record has a CRC. A record cut in half by a crash is detected, and
+  everything from it on is dropped. In Synced mode such a record was never
+  acknowledged; in Buffered mode it is inside the loss window above.
+> The snapshot is written to a temp file and renamed, so snapshot.bin is always either
+  the old one or the new one, never a mix.
+
+Recovery result is always a PREFIX of the booking history : "everything up to lsn L".
+
+*/
+
+#include<bits/stdc++.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+namespace fs = std::filesystem;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// On-disk formats
+//////////////////////////////////////////
+
+enum SeatState : uint8_t { Free = 0, Held = 1, Sold = 2 };
+
+struct LogRecord {
+    uint64_t lsn;
+    uint32_t seat;
+    uint8_t state;
+    uint8_t pad[3];
+    uint32_t crc;            // over the 16 bytes above
+    uint32_t pad2;
+};
+static_assert(sizeof(LogRecord) == 24);
+
+struct SnapshotHeader {
+    char magic[8];
+    uint64_t seats;
+    uint64_t lsn;
+    uint32_t crc;            // over the seat bytes
+    uint32_t pad;
+};
+
+static constexpr char kSnapshotMagic[8] = {'S', 'E', 'A', 'T', 'S', 'N', 'P', '1'};
+
+static uint32_t crc32(const char* data, size_t n) {
+    static const auto table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) c = table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+static bool writeAll(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= w;
+    }
+    return true;
+}
+
+
+//////////////////////////////////////////
+// Seat store
+//////////////////////////////////////////
+
+struct RecoveryStats {
+    uint64_t snapshotLsn = 0;
+    uint64_t replayed = 0;
+    uint64_t lastLsn = 0;
+    bool tornTail = false;
+    double millis = 0;
+};
+
+enum class Durability { Synced, Buffered };
+
+class SeatStore {
+private:
+    fs::path dir;
+    uint64_t seatCount;
+    unique_ptr<atomic<uint8_t>[]> seats;
+
+    mutex syncLock;                  // one group commit at a time; taken before `lock`
+    mutex lock;                      // orders log appends; held across fork()
+    uint64_t lastLsn = 0;
+    int logFd = -1;
+    vector<LogRecord> buffer;
+    Durability durability;
+    size_t bufferLimit;
+    atomic<uint64_t> durableLsn{0};
+    atomic<uint64_t> syncs{0};
+
+    pid_t snapshotPid = -1;
+    uint64_t pendingSnapshotLsn = 0;
+    RecoveryStats recovery;
+
+    fs::path segmentPath(uint64_t firstLsn) const {
+        char name[40];
+        snprintf(name, sizeof(name), "log-%016llu.log", (unsigned long long)firstLsn);
+        return dir / name;
+    }
+
+    vector<pair<uint64_t, fs::path>> segments() const {
+        vector<pair<uint64_t, fs::path>> list;
+        for (auto& entry : fs::directory_iterator(dir)) {
+            string name = entry.path().filename().string();
+            if (name.rfind("log-", 0) == 0) list.push_back({stoull(name.substr(4, 16)), entry.path()});
+        }
+        sort(list.begin(), list.end());
+        return list;
+    }
+
+    // Makes creates, renames and deletes in dir durable. No allocation : the snapshot child uses it.
+    static bool syncDirectory(const char* path) {
+        int fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool ok = fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    void openSegment(uint64_t firstLsn) {
+        if (logFd >= 0) ::close(logFd);
+        logFd = ::open(segmentPath(firstLsn).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (logFd < 0) throw runtime_error("cannot open log segment in " + dir.string());
+        // a synced record in this segment is only durable once the segment's name is
+        if (!syncDirectory(dir.c_str())) throw runtime_error("cannot sync " + dir.string());
+    }
+
+    void flushLocked() {
+        if (buffer.empty()) return;
+        if (!writeAll(logFd, reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(LogRecord))) {
+            throw runtime_error("booking log write failed");
+        }
+        buffer.clear();
+    }
+
+    void append(uint32_t seat, SeatState state) {
+        LogRecord r{++lastLsn, seat, state, {}, 0, 0};
+        r.crc = crc32(reinterpret_cast<const char*>(&r), 16);
+        buffer.push_back(r);
+        if (durability == Durability::Buffered && buffer.size() >= bufferLimit) flushLocked();
+    }
+
+    // Group commit : returns once every record up to `lsn` is on disk. The fdatasync runs
+    // outside `lock`, so other threads keep appending and are covered by the next one.
+    // Holding syncLock keeps startSnapshot() from rotating logFd underneath it.
+    void awaitDurable(uint64_t lsn) {
+        if (durableLsn.load(memory_order_acquire) >= lsn) return;
+        lock_guard<mutex> sync(syncLock);
+        if (durableLsn.load(memory_order_acquire) >= lsn) return;
+        uint64_t target;
+        {
+            lock_guard<mutex> guard(lock);
+            flushLocked();
+            target = lastLsn;
+        }
+        if (fdatasync(logFd) != 0) throw runtime_error("booking log fdatasync failed");
+        syncs.fetch_add(1, memory_order_relaxed);
+        durableLsn.store(target, memory_order_release);
+    }
+
+    bool transition(uint32_t seat, SeatState from, SeatState to) {
+        if (seat >= seatCount) throw out_of_range("no seat " + to_string(seat));
+        uint64_t lsn;
+        {
+            lock_guard<mutex> guard(lock);
+            if (seats[seat].load(memory_order_relaxed) != from) return false;
+            seats[seat].store(to, memory_order_relaxed);
+            append(seat, to);
+            lsn = lastLsn;
+        }
+        if (durability == Durability::Synced) awaitDurable(lsn);
+        return true;
+    }
+
+    bool loadSnapshot() {
+        fs::path path = dir / "snapshot.bin";
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        SnapshotHeader h;
+        bool ok = ::read(fd, &h, sizeof(h)) == (ssize_t)sizeof(h) && memcmp(h.magic, kSnapshotMagic, 8) == 0 && h.seats == seatCount;
+        char* data = reinterpret_cast<char*>(seats.get());
+        size_t got = 0;
+        while (ok && got < seatCount) {
+            ssize_t r = ::read(fd, data + got, seatCount - got);
+            if (r <= 0) break;
+            got += r;
+        }
+        ::close(fd);
+        if (!ok || got != seatCount || crc32(data, seatCount) != h.crc) {
+            throw runtime_error("snapshot " + path.string() + " is corrupt");
+        }
+        recovery.snapshotLsn = lastLsn = h.lsn;
+        return true;
+    }
+
+    // Replays segments in lsn order. Stops at the first torn record or gap and cuts the log there.
+    void replayLog() {
+        vector<LogRecord> chunk(1 << 16);
+        bool stopped = false;
+        for (auto& [firstLsn, path] : segments()) {
+            if (stopped) { fs::remove(path); continue; }
+            int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd < 0) throw runtime_error("cannot open " + path.string());
+            uint64_t offset = 0;
+            while (!stopped) {
+                ssize_t n = pread(fd, chunk.data(), chunk.size() * sizeof(LogRecord), offset);
+                if (n <= 0) break;
+                size_t records = n / sizeof(LogRecord);
+                for (size_t i = 0; i < records; i++) {
+                    const LogRecord& r = chunk[i];
+                    if (crc32(reinterpret_cast<const char*>(&r), 16) != r.crc || r.seat >= seatCount ||
+                        (r.lsn > lastLsn + 1)) {
+                        stopped = true;
+                        offset += i * sizeof(LogRecord);
+                        break;
+                    }
+                    if (r.lsn <= lastLsn) continue;             // already in the snapshot
+                    seats[r.seat].store(r.state, memory_order_relaxed);
+                    lastLsn = r.lsn;
+                    recovery.replayed++;
+                }
+                if (stopped) break;
+                offset += records * sizeof(LogRecord);
+                if (n % sizeof(LogRecord) != 0) stopped = true;  // half a record at the end
+            }
+            if (stopped) {
+                recovery.tornTail = true;
+                if (ftruncate(fd, offset) != 0) throw runtime_error("cannot truncate " + path.string());
+            }
+            ::close(fd);
+        }
+    }
+
+    // Runs in the forked child : no locks, no allocation, just write + rename.
+    [[noreturn]] void writeSnapshotAndExit(const char* dirPath, const char* tmp, const char* path, uint64_t lsn) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        const char* data = reinterpret_cast<const char*>(seats.get());
+        SnapshotHeader h{};
+        memcpy(h.magic, kSnapshotMagic, 8);
+        h.seats = seatCount;
+        h.lsn = lsn;
+        h.crc = crc32(data, seatCount);
+        int fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && writeAll(fd, reinterpret_cast<const char*>(&h), sizeof(h)) && writeAll(fd, data, seatCount) &&
+                  fsync(fd) == 0;
+        if (fd >= 0) ::close(fd);
+        // The parent deletes the old segments once we exit 0. The rename must be durable first, or
+        // after a power loss the old snapshot.bin could come back without the log it needs.
+        ok = ok && ::rename(tmp, path) == 0 && syncDirectory(dirPath);
+        _exit(ok ? 0 : 1);
+    }
+
+public:
+    // Opens (or recovers) the store in dir.
+    SeatStore(fs::path dir, uint64_t seatCount, Durability durability = Durability::Synced, size_t bufferLimit = 4096)
+        : dir(move(dir)), seatCount(seatCount), seats(new atomic<uint8_t>[seatCount]), durability(durability),
+          bufferLimit(bufferLimit) {
+        static_assert(sizeof(atomic<uint8_t>) == 1);
+        auto start = Clock::now();
+        fs::create_directories(this->dir);
+        fs::remove(this->dir / "snapshot.tmp");
+        memset(reinterpret_cast<char*>(seats.get()), Free, seatCount);
+        loadSnapshot();
+        replayLog();
+        recovery.lastLsn = lastLsn;
+        durableLsn = lastLsn;
+        openSegment(lastLsn + 1);
+        recovery.millis = chrono::duration<double, milli>(Clock::now() - start).count();
+        buffer.reserve(bufferLimit);
+    }
+
+    ~SeatStore() {
+        finishSnapshot(true);
+        lock_guard<mutex> guard(lock);
+        flushLocked();
+        ::close(logFd);
+    }
+
+    bool hold(uint32_t seat)    { return transition(seat, Free, Held); }
+    bool sell(uint32_t seat)    { return transition(seat, Held, Sold) || transition(seat, Free, Sold); }
+    bool release(uint32_t seat) { return transition(seat, Held, Free) || transition(seat, Sold, Free); }
+
+    SeatState state(uint32_t seat) const { return (SeatState)seats[seat].load(memory_order_relaxed); }
+
+    // Writes buffered records to the log (page cache). Survives a process crash, not power loss.
+    void flush() {
+        lock_guard<mutex> guard(lock);
+        flushLocked();
+    }
+
+    // Starts a background snapshot. Returns the time bookings were paused (the fork).
+    double startSnapshot() {
+        finishSnapshot(true);
+        string dirPath = dir, tmp = dir / "snapshot.tmp", path = dir / "snapshot.bin";   // built before fork : child must not malloc
+        auto start = Clock::now();
+        lock_guard<mutex> sync(syncLock);
+        lock_guard<mutex> guard(lock);
+        flushLocked();
+        if (durability == Durability::Synced) {           // the old segment is closed : make its tail durable now
+            if (fdatasync(logFd) != 0) throw runtime_error("booking log fdatasync failed");
+            durableLsn = lastLsn;
+        }
+        pid_t pid = fork();
+        if (pid < 0) throw runtime_error("fork failed");
+        if (pid == 0) writeSnapshotAndExit(dirPath.c_str(), tmp.c_str(), path.c_str(), lastLsn);
+        snapshotPid = pid;
+        pendingSnapshotLsn = lastLsn;
+        openSegment(lastLsn + 1);
+        return chrono::duration<double, milli>(Clock::now() - start).count();
+    }
+
+    // Reaps the snapshot child. On success deletes log segments it made redundant.
+    bool finishSnapshot(bool wait) {
+        if (snapshotPid < 0) return true;
+        int status = 0;
+        pid_t r = waitpid(snapshotPid, &status, wait ? 0 : WNOHANG);
+        if (r == 0) return false;
+        snapshotPid = -1;
+        if (r < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) throw runtime_error("snapshot failed");
+        for (auto& [firstLsn, path] : segments()) {
+            if (firstLsn <= pendingSnapshotLsn) fs::remove(path);
+        }
+        return true;
+    }
+
+    const RecoveryStats& recoveryStats() const { return recovery; }
+    uint64_t syncCount() const { return syncs.load(); }
+    uint64_t lsn() { lock_guard<mutex> guard(lock); return lastLsn; }
+};
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+// Deterministic booking history : op i holds, sells or releases some seat.
+struct Op { uint32_t seat; int kind; };   // 0 hold, 1 sell, 2 release
+
+vector<Op> history(size_t n, uint32_t seats, uint32_t seed) {
+    mt19937 rng(seed);
+    vector<Op> ops(n);
+    for (auto& op : ops) op = {(uint32_t)(rng() % seats), (int)(rng() % 10 < 6 ? 1 : rng() % 3)};
+    return ops;
+}
+
+template<class Store>
+void applyOp(Store& s, const Op& op) {
+    if (op.kind == 0) s.hold(op.seat);
+    else if (op.kind == 1) s.sell(op.seat);
+    else s.release(op.seat);
+}
+
+// Same transitions, no log : what the state must be after the first k ops that were logged.
+struct Model {
+    vector<uint8_t> seats;
+    uint64_t lsn = 0;
+    bool hold(uint32_t s)    { return set(s, Free, Held); }
+    bool sell(uint32_t s)    { return set(s, Held, Sold) || set(s, Free, Sold); }
+    bool release(uint32_t s) { return set(s, Held, Free) || set(s, Sold, Free); }
+    bool set(uint32_t s, uint8_t from, uint8_t to) {
+        if (seats[s] != from) return false;
+        seats[s] = to;
+        lsn++;
+        return true;
+    }
+};
+
+bool matchesPrefix(SeatStore& store, const vector<Op>& ops, uint32_t seats) {
+    Model model{vector<uint8_t>(seats, Free)};
+    for (auto& op : ops) {
+        if (model.lsn == store.lsn()) break;
+        applyOp(model, op);
+    }
+    if (model.lsn != store.lsn()) return false;
+    for (uint32_t s = 0; s < seats; s++) {
+        if (store.state(s) != model.seats[s]) return false;
+    }
+    return true;
+}
+
+void checks(const fs::path& root) {
+    const uint32_t seats = 20000;
+    auto ops = history(200000, seats, 11);
+
+    {
+        fs::path dir = root / "clean";
+        {
+            SeatStore store(dir, seats, Durability::Buffered);
+            for (size_t i = 0; i < ops.size(); i++) {
+                applyOp(store, ops[i]);
+                if (i == 80000) store.startSnapshot();
+            }
+        }
+        SeatStore again(dir, seats);
+        check(matchesPrefix(again, ops, seats) && again.lsn() > 0 && again.recoveryStats().snapshotLsn > 0,
+              "snapshot + log tail restores the exact state after a clean shutdown");
+    }
+
+    {
+        fs::path dir = root / "torn";
+        uint64_t lsn;
+        {
+            SeatStore store(dir, seats, Durability::Buffered);
+            for (size_t i = 0; i < 5000; i++) applyOp(store, ops[i]);
+            lsn = store.lsn();
+        }
+        auto segs = vector<fs::path>();
+        for (auto& e : fs::directory_iterator(dir)) if (e.path().filename().string().rfind("log-", 0) == 0) segs.push_back(e.path());
+        sort(segs.begin(), segs.end());
+        fs::resize_file(segs.back(), fs::file_size(segs.back()) - 7);        // half-written last record
+        SeatStore again(dir, seats);
+        check(again.recoveryStats().tornTail && again.lsn() == lsn - 1 && matchesPrefix(again, ops, seats),
+              "a half-written record is cut off and the rest is recovered");
+    }
+
+    // Kill the process at random points while it books and snapshots. The child publishes
+    // the lsn of its last acknowledged change, and whether a snapshot is in flight, in shared
+    // memory. Snapshots are taken every few ops (synced ops are slow) so most kills land
+    // during a fork, a snapshot write or a segment deletion.
+    ops = history(4000000, seats, 12);
+    struct Shared { atomic<uint64_t> acked; atomic<bool> snapshotting; };
+    auto* shared = static_cast<Shared*>(mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    mt19937 rng(5);
+    int midSnapshot = 0;
+    const int rounds = 12;
+    for (int round = 0; round < rounds; round++) {
+        Durability mode = round % 2 == 0 ? Durability::Synced : Durability::Buffered;
+        size_t bufferLimit = 1 + round * 50;
+        size_t snapshotEvery = mode == Durability::Synced ? 4 : 3000;
+        fs::path dir = root / ("kill" + to_string(round));
+        shared->acked.store(0);
+        shared->snapshotting.store(false);
+        pid_t pid = fork();
+        if (pid == 0) {
+            SeatStore store(dir, seats, mode, bufferLimit);
+            for (size_t i = 0;; i++) {
+                applyOp(store, ops[i % ops.size()]);
+                shared->acked.store(store.lsn(), memory_order_release);
+                if (i % snapshotEvery == snapshotEvery - 1) {
+                    shared->snapshotting.store(true);
+                    store.startSnapshot();
+                }
+                if (store.finishSnapshot(false)) shared->snapshotting.store(false);
+                if (i + 1 == ops.size()) { store.flush(); pause(); }
+            }
+        }
+        this_thread::sleep_for(chrono::milliseconds(5 + rng() % 200));
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        midSnapshot += shared->snapshotting.load();
+        this_thread::sleep_for(chrono::milliseconds(20));   // snapshot child dies with its parent
+
+        SeatStore recovered(dir, seats);
+        auto& st = recovered.recoveryStats();
+        uint64_t ack = shared->acked.load(), lost = ack > st.lastLsn ? ack - st.lastLsn : 0;
+        string what = string(mode == Durability::Synced ? "synced" : "buffered") + " round " + to_string(round) +
+                      " : recovered lsn " + to_string(st.lastLsn) + " (snapshot " + to_string(st.snapshotLsn) + " + " +
+                      to_string(st.replayed) + " replayed) is a consistent prefix, ";
+        if (mode == Durability::Synced) {
+            check(matchesPrefix(recovered, ops, seats) && lost == 0, what + "no acknowledged change lost");
+        } else {
+            check(matchesPrefix(recovered, ops, seats) && lost < bufferLimit,
+                  what + to_string(lost) + " acknowledged lost (window " + to_string(bufferLimit - 1) + ")");
+        }
+    }
+    check(midSnapshot >= rounds / 4, "kills landed while a snapshot was in flight in " + to_string(midSnapshot) + " of " +
+                                         to_string(rounds) + " rounds");
+    munmap(shared, sizeof(Shared));
+}
+
+void benchmark(const fs::path& root, uint32_t sold) {
+    const uint32_t seats = sold + sold / 5;
+    fs::path dir = root / "bench";
+    fs::remove_all(dir);
+
+    double pauseMs, snapMs;
+    {
+        SeatStore store(dir, seats, Durability::Buffered, 1 << 14);
+        auto t0 = Clock::now();
+        for (uint32_t s = 0; s < sold; s++) store.sell(s);
+        store.flush();
+        double sec = chrono::duration<double>(Clock::now() - t0).count();
+        cout << "sold " << sold << " seats in " << fixed << setprecision(2) << sec << "s ("
+             << (long)(sold / sec) << " logged sales/sec, buffered acks)\n";
+    }
+
+    // Synced acks : one fdatasync per group, so more concurrent bookers share each sync.
+    for (int threads : {1, 8}) {
+        fs::path syncedDir = root / "synced";
+        fs::remove_all(syncedDir);
+        SeatStore store(syncedDir, 1000000);
+        atomic<uint32_t> next{0};
+        auto t0 = Clock::now();
+        vector<thread> bookers;
+        for (int t = 0; t < threads; t++) {
+            bookers.emplace_back([&] {
+                while (chrono::duration<double>(Clock::now() - t0).count() < 0.5) store.sell(next++);
+            });
+        }
+        for (auto& b : bookers) b.join();
+        double sec = chrono::duration<double>(Clock::now() - t0).count();
+        cout << "synced acks, " << threads << " thread(s) : " << (long)(store.lsn() / sec) << " sales/sec, "
+             << setprecision(1) << (double)store.lsn() / max<uint64_t>(1, store.syncCount()) << " records per fdatasync\n";
+    }
+
+    {
+        SeatStore store(dir, seats, Durability::Buffered);
+        cout << "recovery, full log replay     : " << setprecision(0) << store.recoveryStats().millis << " ms ("
+             << store.recoveryStats().replayed << " records)\n";
+
+        auto t0 = Clock::now();
+        pauseMs = store.startSnapshot();
+        // the booking path keeps going while the child writes the snapshot
+        long during = 0;
+        for (uint32_t s = sold; !store.finishSnapshot(false); s++, during++) store.sell(s % seats);
+        snapMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+        cout << "snapshot : bookings paused " << setprecision(2) << pauseMs << " ms (fork), written in background in "
+             << setprecision(0) << snapMs << " ms, " << during << " sales done meanwhile\n";
+        for (uint32_t s = 0; s < 100000; s++) store.release(s);
+    }
+
+    {
+        SeatStore store(dir, seats);
+        cout << "recovery, snapshot + log tail : " << setprecision(0) << store.recoveryStats().millis << " ms ("
+             << store.recoveryStats().replayed << " records after lsn " << store.recoveryStats().snapshotLsn << ")\n";
+    }
+    fs::remove_all(dir);
+}
+
+
+int main(int argc, char** argv) {
+    fs::path root = "/tmp/seat_recovery_demo";
+    fs::remove_all(root);
+
+    checks(root);
+
+    uint32_t sold = argc > 1 ? stoul(argv[1]) : 10000000;
+    cout << "\n--- recovery at " << sold << " sold seats ---\n";
+    benchmark(root, sold);
+
+    fs::remove_all(root);
+    return 0;
+}
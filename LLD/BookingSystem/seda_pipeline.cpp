@@ -0,0 +1,490 @@
+/*
+
+Staged (SEDA) Ticket Booking Pipeline
+
+In SRP/theory.cpp Ticketbooking::bookTicket does everything in one blocking sequence :
+
+    seat check  ->  price  ->  payment (slow, ~ms)  ->  notification
+
+The thread that started the booking is stuck for the whole time, mostly waiting on the
+payment gateway. To serve more bookings we would need more and more threads.
+
+SEDA (Staged Event-Driven Architecture) :
+
+    [queue] -> SeatStage -> [queue] -> PriceStage -> [queue] -> PaymentStage -> [queue] -> NotifyStage
+               (2 threads)             (1 thread)              (16 threads)              (2 threads)
+
+> Each stage has its own bounded queue and its own thread pool sized for its work.
+  Slow payment gets many threads, cheap pricing gets one.
+> Bounded queues give back-pressure : when payment falls behind, its queue fills up
+  and the earlier stages block instead of piling up unlimited work in memory.
+> Every stage reports queue depth and latency, so we can see which stage is the bottleneck.
+> Adaptive batching : a stage takes more items at once when its queue is long.
+  Notifications are sent in one provider call per batch, so a backlog drains faster.
+> Shutdown drains stage by stage. Every request accepted before it finishes; bookTicket()
+  returns false once the pipeline no longer accepts work.
+
+The SeatChecker / PriceCalculator / PaymentService / NotificationService classes are
+the same as in SRP/theory.cpp, with a sleep standing in for the real I/O.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Services (from SRP/theory.cpp)
+//////////////////////////////////////////
+
+class SeatChecker {
+public:
+    bool isSeatAvailable(int movieId, string seatNumber) {
+        this_thread::sleep_for(chrono::microseconds(50));     // db lookup
+        return seatNumber != "Z99";
+    }
+};
+
+class PriceCalculator {
+public:
+    int getPrice(int movieId, string seatNumber) {
+        return seatNumber[0] == 'A' ? 150 : 100;
+    }
+};
+
+class PaymentService {
+public:
+    bool processPayment(int userId, int amount) {
+        this_thread::sleep_for(chrono::milliseconds(2));      // payment gateway round trip
+        return userId % 50 != 0;
+    }
+};
+
+class NotificationService {
+public:
+    void sendConfirmation(int userId, int movieId) {
+        this_thread::sleep_for(chrono::microseconds(300));    // one provider call
+    }
+
+    // The provider accepts up to 100 messages per call for about the same cost.
+    void sendConfirmationBatch(const vector<pair<int, int>>& userMovie) {
+        this_thread::sleep_for(chrono::microseconds(300 + 2 * userMovie.size()));
+    }
+};
+
+// Sequential version (SRP/theory.cpp), used as the baseline.
+class Ticketbooking {
+private:
+    SeatChecker &seatchecker;
+    PriceCalculator &pricecalculator;
+    PaymentService &paymentservice;
+    NotificationService &notificationservice;
+
+public:
+    Ticketbooking(SeatChecker &seatchecker,
+        PriceCalculator &pricecalculator, PaymentService &paymentservice,
+        NotificationService &notificationservice):
+        seatchecker(seatchecker), pricecalculator(pricecalculator),
+        paymentservice(paymentservice), notificationservice(notificationservice) {
+    }
+
+    bool bookTicket(int userId, int movieId, const string& seatNumber) {
+        if (!seatchecker.isSeatAvailable(movieId, seatNumber)) return false;
+        int price = pricecalculator.getPrice(movieId, seatNumber);
+        if (!paymentservice.processPayment(userId, price)) return false;
+        notificationservice.sendConfirmation(userId, movieId);
+        return true;
+    }
+};
+
+
+//////////////////////////////////////////
+// Bounded blocking queue
+//////////////////////////////////////////
+
+template <typename T>
+class BoundedQueue {
+private:
+    mutex lock;
+    condition_variable notEmpty, notFull;
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    // Blocks while full. Returns false, leaving item untouched, if the queue is or gets closed.
+    bool push(T&& item) {
+        unique_lock<mutex> lk(lock);
+        notFull.wait(lk, [&] { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Waits for at least one item, then takes up to maxItems. Empty result = closed.
+    void popBatch(vector<T>& out, size_t maxItems) {
+        unique_lock<mutex> lk(lock);
+        notEmpty.wait(lk, [&] { return !items.empty() || closed; });
+        while (!items.empty() && out.size() < maxItems) {
+            out.push_back(move(items.front()));
+            items.pop_front();
+        }
+        notFull.notify_all();
+    }
+
+    size_t size() {
+        lock_guard<mutex> lk(lock);
+        return items.size();
+    }
+
+    void close() {
+        lock_guard<mutex> lk(lock);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+
+//////////////////////////////////////////
+// Stage metrics
+//////////////////////////////////////////
+
+struct StageMetrics {
+    atomic<long> processed{0};
+    atomic<long> batches{0};
+    atomic<long> maxDepth{0};
+    atomic<long> queueWaitNanos{0};
+    atomic<long> serviceNanos{0};
+
+    void observeDepth(long depth) {
+        long seen = maxDepth.load(memory_order_relaxed);
+        while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth)) {}
+    }
+};
+
+
+//////////////////////////////////////////
+// Stage = bounded queue + thread pool + batch handler
+//////////////////////////////////////////
+
+struct BookingRequest {
+    int userId;
+    int movieId;
+    string seatNumber;
+    int price = 0;
+    Clock::time_point createdAt;
+    Clock::time_point enqueuedAt;     // when it entered the current stage's queue
+};
+
+class Stage {
+public:
+    using Handler = function<void(vector<BookingRequest>&)>;
+
+private:
+    string name;
+    BoundedQueue<BookingRequest> queue;
+    Handler handler;
+    size_t maxBatch;
+    StageMetrics metrics;
+    vector<thread> workers;       // last, so everything above exists before threads start
+
+    // Adaptive batching : share the backlog among the workers, but never more than maxBatch.
+    size_t nextBatchSize() {
+        size_t depth = queue.size();
+        metrics.observeDepth(depth);
+        return clamp<size_t>(depth / workers.size(), 1, maxBatch);
+    }
+
+    void run() {
+        vector<BookingRequest> batch;
+        while (true) {
+            batch.clear();
+            queue.popBatch(batch, nextBatchSize());
+            if (batch.empty()) return;
+
+            auto start = Clock::now();
+            long waited = 0;
+            for (auto& r : batch) waited += (start - r.enqueuedAt).count();
+            handler(batch);
+            metrics.serviceNanos += (Clock::now() - start).count();
+            metrics.queueWaitNanos += waited;
+            metrics.processed += batch.size();
+            metrics.batches++;
+        }
+    }
+
+public:
+    Stage(string name, size_t capacity, int threads, size_t maxBatch, Handler handler)
+        : name(move(name)), queue(capacity), handler(move(handler)), maxBatch(maxBatch) {
+        workers.resize(threads);
+        for (auto& t : workers) t = thread(&Stage::run, this);
+    }
+
+    // False once the stage is draining; the caller still owns r and must complete or reject it.
+    bool submit(BookingRequest&& r) {
+        r.enqueuedAt = Clock::now();
+        return queue.push(move(r));
+    }
+
+    // Stop accepting work and wait for everything already queued to finish. Safe to call twice.
+    void drain() {
+        queue.close();
+        for (auto& t : workers) if (t.joinable()) t.join();
+    }
+
+    ~Stage() { drain(); }
+
+    Stage(const Stage&) = delete;
+    Stage& operator=(const Stage&) = delete;
+
+    void report() {
+        long n = max(1L, metrics.processed.load());
+        long b = max(1L, metrics.batches.load());
+        cout << "  " << setw(8) << left << name
+             << " processed " << setw(6) << metrics.processed
+             << " max depth " << setw(5) << metrics.maxDepth
+             << " avg batch " << setw(6) << fixed << setprecision(1) << (double)n / b
+             << " avg wait " << setw(8) << metrics.queueWaitNanos / n / 1000 << "us"
+             << " avg service/batch " << metrics.serviceNanos / b / 1000 << "us\n";
+    }
+};
+
+
+//////////////////////////////////////////
+// Staged booking pipeline
+//////////////////////////////////////////
+
+class StagedTicketbooking {
+private:
+    SeatChecker& seatchecker;
+    PriceCalculator& pricecalculator;
+    PaymentService& paymentservice;
+    NotificationService& notificationservice;
+
+    atomic<long> succeeded{0}, failed{0}, rejected{0}, inFlight{0};
+    atomic<long> totalLatencyNanos{0};
+    mutex doneLock;
+    condition_variable allDone;
+
+    // stages are created last-to-first so each handler can forward to the next one
+    unique_ptr<Stage> notifyStage, paymentStage, priceStage, seatStage;
+
+    void leave() {
+        if (--inFlight == 0) {
+            lock_guard<mutex> lk(doneLock);
+            allDone.notify_all();
+        }
+    }
+
+    void finish(const BookingRequest& r, bool ok) {
+        (ok ? succeeded : failed)++;
+        totalLatencyNanos += (Clock::now() - r.createdAt).count();
+        leave();
+    }
+
+    // Hands r to the next stage, or fails it if that stage is already draining.
+    void forward(Stage& next, BookingRequest& r) {
+        if (!next.submit(move(r))) finish(r, false);
+    }
+
+public:
+    StagedTicketbooking(SeatChecker& seatchecker, PriceCalculator& pricecalculator,
+                        PaymentService& paymentservice, NotificationService& notificationservice,
+                        int paymentThreads = 16)
+        : seatchecker(seatchecker), pricecalculator(pricecalculator),
+          paymentservice(paymentservice), notificationservice(notificationservice) {
+
+        notifyStage = make_unique<Stage>("notify", 1024, 2, 100, [this](vector<BookingRequest>& batch) {
+            vector<pair<int, int>> userMovie;
+            for (auto& r : batch) userMovie.push_back({r.userId, r.movieId});
+            this->notificationservice.sendConfirmationBatch(userMovie);
+            for (auto& r : batch) finish(r, true);
+        });
+
+        paymentStage = make_unique<Stage>("payment", 1024, paymentThreads, 1, [this](vector<BookingRequest>& batch) {
+            for (auto& r : batch) {
+                if (this->paymentservice.processPayment(r.userId, r.price)) forward(*notifyStage, r);
+                else finish(r, false);
+            }
+        });
+
+        priceStage = make_unique<Stage>("price", 1024, 1, 64, [this](vector<BookingRequest>& batch) {
+            for (auto& r : batch) {
+                r.price = this->pricecalculator.getPrice(r.movieId, r.seatNumber);
+                forward(*paymentStage, r);
+            }
+        });
+
+        seatStage = make_unique<Stage>("seat", 1024, 2, 16, [this](vector<BookingRequest>& batch) {
+            for (auto& r : batch) {
+                if (this->seatchecker.isSeatAvailable(r.movieId, r.seatNumber)) forward(*priceStage, r);
+                else finish(r, false);
+            }
+        });
+    }
+
+    // Returns as soon as the request is queued. Blocks only when the pipeline is full.
+    // False if the pipeline is shutting down : the request was not accepted.
+    bool bookTicket(int userId, int movieId, const string& seatNumber) {
+        inFlight++;
+        if (seatStage->submit({userId, movieId, seatNumber, 0, Clock::now(), {}})) return true;
+        rejected++;
+        leave();
+        return false;
+    }
+
+    void waitForAll() {
+        unique_lock<mutex> lk(doneLock);
+        allDone.wait(lk, [&] { return inFlight == 0; });
+    }
+
+    // Upstream first, so every request already accepted flows through. Safe to call twice.
+    void shutdown() {
+        seatStage->drain();
+        priceStage->drain();
+        paymentStage->drain();
+        notifyStage->drain();
+    }
+
+    // A pipeline dropped without shutdown() still finishes its work and joins its threads.
+    ~StagedTicketbooking() { shutdown(); }
+
+    StagedTicketbooking(const StagedTicketbooking&) = delete;
+    StagedTicketbooking& operator=(const StagedTicketbooking&) = delete;
+
+    long settled() const { return succeeded + failed; }
+    long rejectedCount() const { return rejected; }
+
+    void report() {
+        long done = max(1L, succeeded + failed);
+        cout << "  succeeded " << succeeded << ", failed " << failed << ", rejected " << rejected
+             << ", avg end-to-end latency " << totalLatencyNanos / done / 1000 << "us\n";
+        seatStage->report();
+        priceStage->report();
+        paymentStage->report();
+        notifyStage->report();
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static string seatFor(int i) {
+    return string(1, 'A' + i % 10) + to_string(1 + i % 20);
+}
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    {
+        vector<int> seen;
+        Stage single("order", 16, 1, 8, [&](vector<BookingRequest>& batch) {
+            for (auto& r : batch) seen.push_back(r.userId);
+        });
+        bool accepted = true;
+        for (int i = 0; i < 1000; i++) accepted &= single.submit({i, 101, "A1", 0, Clock::now(), {}});
+        single.drain();
+        vector<int> expected(1000);
+        iota(expected.begin(), expected.end(), 0);
+        check(accepted && seen == expected, "a single-threaded stage handles requests in submission order");
+    }
+
+    {
+        BoundedQueue<int> queue(2);
+        int a = 1, b = 2, c = 3;
+        queue.push(move(a));
+        queue.push(move(b));
+        atomic<bool> pushed{false};
+        thread producer([&] { queue.push(move(c)); pushed = true; });
+        this_thread::sleep_for(chrono::milliseconds(50));
+        bool blockedWhileFull = !pushed;
+        vector<int> out;
+        queue.popBatch(out, 1);
+        producer.join();
+        check(blockedWhileFull && pushed && queue.size() == 2, "a full queue blocks the producer until a slot frees up");
+    }
+
+    {
+        BoundedQueue<int> queue(1);
+        int a = 1, b = 2;
+        queue.push(move(a));
+        auto late = async(launch::async, [&] { return queue.push(move(b)); });
+        this_thread::sleep_for(chrono::milliseconds(20));
+        queue.close();
+        check(late.get() == false && queue.size() == 1, "a push blocked at close() is refused, not silently queued");
+    }
+
+    {
+        SeatChecker s; PriceCalculator p; PaymentService pay; NotificationService n;
+        StagedTicketbooking booking(s, p, pay, n, 4);
+        long accepted = 0;
+        for (int i = 0; i < 200; i++) accepted += booking.bookTicket(i, 101, seatFor(i));
+        booking.shutdown();                                   // most requests are still in flight
+        bool refused = !booking.bookTicket(999, 101, "A1");
+        auto waited = async(launch::async, [&] { booking.waitForAll(); });
+        bool returned = waited.wait_for(chrono::seconds(5)) == future_status::ready;
+        check(accepted == 200 && booking.settled() == 200 && refused && booking.rejectedCount() == 1 && returned,
+              "shutdown finishes every accepted request, refuses new ones, and waitForAll returns");
+    }
+}
+
+
+//////////////////////////////////////////
+// Benchmark : sequential vs staged
+//////////////////////////////////////////
+
+void benchmarkSequential(int bookings, int threads) {
+    SeatChecker s; PriceCalculator p; PaymentService pay; NotificationService n;
+    Ticketbooking booking(s, p, pay, n);
+    atomic<int> next{0};
+
+    auto start = Clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (int i = next++; i < bookings; i = next++) booking.bookTicket(i, 101, seatFor(i));
+        });
+    }
+    for (auto& t : pool) t.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+    cout << "sequential, " << setw(2) << threads << " thread(s) : " << (long)(bookings / sec) << " bookings/sec\n";
+}
+
+void benchmarkStaged(int bookings, int paymentThreads) {
+    SeatChecker s; PriceCalculator p; PaymentService pay; NotificationService n;
+    StagedTicketbooking booking(s, p, pay, n, paymentThreads);
+
+    auto start = Clock::now();
+    for (int i = 0; i < bookings; i++) booking.bookTicket(i, 101, seatFor(i));
+    booking.waitForAll();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+    cout << "staged, " << paymentThreads << " payment threads : " << (long)(bookings / sec) << " bookings/sec\n";
+    booking.report();
+    booking.shutdown();
+}
+
+
+int main() {
+    checks();
+    cout << "\n";
+
+    const int bookings = 4000;
+
+    benchmarkSequential(bookings / 10, 1);
+    benchmarkSequential(bookings, 22);
+    benchmarkStaged(bookings, 16);
+    benchmarkStaged(bookings, 64);
+
+    return 0;
+}
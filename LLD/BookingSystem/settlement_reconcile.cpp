@@ -0,0 +1,575 @@
+/*
+
+Streaming Settlement Reconciliation (external sort + merge join)
+
+Problem :
+    PaymentService / PaymentStrategy (SOLID/OCP, SOLID/SRP) send money out, but nothing
+    checks what the gateways actually settled. The nightly settlement file and our own
+    payment log are bigger than RAM, and in random order.
+
+Solution : sort both files by transaction id with bounded memory, then walk them together.
+
+    1. Run generation (parallel) :
+         reader thread cuts the file into memory-sized chunks
+         -> worker threads sort each chunk by txn id -> write "run" files
+    2. Merge : k-way merge of the runs with a min-heap, each run read through a small
+       buffer. Too many runs? Merge groups of fanIn runs into bigger runs first.
+    3. Join : the two sorted streams are walked side by side (merge join), ONE pass :
+         same id on both sides -> status must be SETTLED, then compare amount / currency
+         only ours             -> missing at gateway
+         only theirs           -> unknown settlement
+         id seen twice         -> duplicate
+
+    The sorted files are never written out in full; the final merge feeds the join.
+
+Memory ~ memoryBudget during run generation, fanIn * readBuffer while merging.
+
+File formats (CSV) :
+    ours       : txnId,bookingId,amountCents,currency
+    settlement : txnId,amountCents,currency,status
+
+*/
+
+#include<bits/stdc++.h>
+#include <malloc.h>
+#include <sys/resource.h>
+using namespace std;
+namespace fs = std::filesystem;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Line I/O
+//////////////////////////////////////////
+
+static string_view keyOf(string_view line) {
+    return line.substr(0, line.find(','));
+}
+
+static vector<string_view> fields(string_view line) {
+    vector<string_view> out;
+    size_t start = 0;
+    while (true) {
+        size_t comma = line.find(',', start);
+        out.push_back(line.substr(start, comma - start));
+        if (comma == string_view::npos) return out;
+        start = comma + 1;
+    }
+}
+
+// Buffered line reader. The returned view stays valid until the next call.
+class LineReader {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t pos = 0, end = 0;
+    bool eof = false;
+
+public:
+    LineReader(const fs::path& path, size_t bufferBytes) : buffer(bufferBytes) {
+        file = fopen(path.c_str(), "rb");
+        if (!file) throw runtime_error("cannot open " + path.string());
+    }
+
+    ~LineReader() { fclose(file); }
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    bool next(string_view& line) {
+        while (true) {
+            char* nl = static_cast<char*>(memchr(buffer.data() + pos, '\n', end - pos));
+            if (nl) {
+                line = string_view(buffer.data() + pos, nl - (buffer.data() + pos));
+                pos = nl - buffer.data() + 1;
+                return true;
+            }
+            if (eof) {
+                if (pos == end) return false;
+                line = string_view(buffer.data() + pos, end - pos);     // last line without '\n'
+                pos = end;
+                return true;
+            }
+            memmove(buffer.data(), buffer.data() + pos, end - pos);      // keep the partial line
+            end -= pos;
+            pos = 0;
+            if (end == buffer.size()) buffer.resize(buffer.size() * 2);  // a line longer than the buffer
+            size_t got = fread(buffer.data() + end, 1, buffer.size() - end, file);
+            end += got;
+            if (got == 0) eof = true;
+        }
+    }
+};
+
+// close() writes everything out and reports any error, including one fclose() only finds
+// at the end. A writer destroyed without close() (an exception is unwinding) just drops
+// its file : a destructor must not throw, and the half-written output is discarded anyway.
+class LineWriter {
+private:
+    FILE* file;
+    fs::path path;
+    string buffer;
+
+public:
+    explicit LineWriter(const fs::path& path) : path(path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) throw runtime_error("cannot create " + path.string());
+        buffer.reserve(1 << 20);
+    }
+
+    ~LineWriter() {
+        if (file) fclose(file);
+    }
+
+    LineWriter(const LineWriter&) = delete;
+    LineWriter& operator=(const LineWriter&) = delete;
+
+    void close() {
+        flush();
+        if (fclose(exchange(file, nullptr)) != 0) throw runtime_error("write failed : " + path.string());
+    }
+
+    void write(string_view line) {
+        buffer.append(line);
+        buffer.push_back('\n');
+        if (buffer.size() >= (1 << 20)) flush();
+    }
+
+    void flush() {
+        if (!file) throw logic_error("LineWriter used after close()");
+        if (!buffer.empty() && fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            throw runtime_error("write failed : " + path.string());
+        }
+        buffer.clear();
+    }
+};
+
+
+//////////////////////////////////////////
+// External sort
+//////////////////////////////////////////
+
+template<typename T>
+class BoundedQueue {
+private:
+    mutex lock;
+    condition_variable notEmpty, notFull;
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(T item) {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [&] { return items.size() < capacity; });
+        items.push_back(move(item));
+        notEmpty.notify_one();
+    }
+
+    optional<T> pop() {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [&] { return !items.empty() || closed; });
+        if (items.empty()) return nullopt;
+        T item = move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+static bool lineLess(string_view a, string_view b) {
+    string_view ka = keyOf(a), kb = keyOf(b);
+    return ka != kb ? ka < kb : a < b;
+}
+
+// K-way merge of sorted run files, one line at a time.
+class MergedStream {
+private:
+    struct Cursor {
+        unique_ptr<LineReader> reader;
+        string_view line;
+    };
+    vector<Cursor> cursors;
+    vector<int> heap;            // indexes into cursors, min-heap on the current line
+    int current = -1;
+
+    bool greater(int a, int b) const { return lineLess(cursors[b].line, cursors[a].line); }
+
+public:
+    MergedStream(const vector<fs::path>& runs, size_t bufferBytes) {
+        for (auto& run : runs) {
+            Cursor c{make_unique<LineReader>(run, bufferBytes), {}};
+            if (c.reader->next(c.line)) {
+                cursors.push_back(move(c));
+                heap.push_back(cursors.size() - 1);
+            }
+        }
+        make_heap(heap.begin(), heap.end(), [&](int a, int b) { return greater(a, b); });
+    }
+
+    bool next(string_view& line) {
+        auto cmp = [&](int a, int b) { return greater(a, b); };
+        if (current >= 0) {                     // advance the run we returned last time
+            if (cursors[current].reader->next(cursors[current].line)) {
+                heap.push_back(current);
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+            current = -1;
+        }
+        if (heap.empty()) return false;
+        pop_heap(heap.begin(), heap.end(), cmp);
+        current = heap.back();
+        heap.pop_back();
+        line = cursors[current].line;
+        return true;
+    }
+};
+
+struct SortStats {
+    size_t runs = 0, mergePasses = 0;
+    uint64_t bytes = 0;
+};
+
+class ExternalSorter {
+private:
+    fs::path tmpDir;
+    size_t memoryBudget;
+    int threads;
+    size_t fanIn;
+    size_t readBuffer;
+    atomic<int> nextRun{0};
+
+    fs::path runPath() { return tmpDir / ("run-" + to_string(nextRun++) + ".txt"); }
+
+    static void sortAndWrite(const string& chunk, const fs::path& path) {
+        vector<string_view> lines;
+        lines.reserve(count(chunk.begin(), chunk.end(), '\n') + 1);
+        for (size_t start = 0; start < chunk.size();) {
+            size_t nl = chunk.find('\n', start);
+            if (nl == string::npos) nl = chunk.size();
+            if (nl > start) lines.emplace_back(chunk.data() + start, nl - start);
+            start = nl + 1;
+        }
+        sort(lines.begin(), lines.end(), lineLess);
+        LineWriter out(path);
+        for (auto line : lines) out.write(line);
+        out.close();
+    }
+
+    // Reader thread cuts chunks at line ends; `threads` workers sort and write them.
+    vector<fs::path> generateRuns(const fs::path& input, SortStats& stats) {
+        // chunks alive at once : one per worker + one queued + one being read.
+        // A sorting worker also holds a 16-byte view per line (~40% of the chunk here).
+        size_t chunkBytes = max<size_t>(1 << 16, memoryBudget / (threads * 3 / 2 + 2));
+        ifstream in(input, ios::binary);
+        if (!in) throw runtime_error("cannot open " + input.string());
+
+        BoundedQueue<pair<string, fs::path>> queue(1);
+        vector<thread> workers;
+        mutex errorLock;
+        exception_ptr workerError;
+        atomic<bool> failed{false};
+        // A failed worker keeps draining the queue so the reader never blocks on it.
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([&] {
+                while (auto job = queue.pop()) {
+                    if (failed) continue;
+                    try {
+                        sortAndWrite(job->first, job->second);
+                    } catch (...) {
+                        lock_guard<mutex> guard(errorLock);
+                        if (!workerError) workerError = current_exception();
+                        failed = true;
+                    }
+                }
+            });
+        }
+        struct Shutdown {
+            BoundedQueue<pair<string, fs::path>>& queue;
+            vector<thread>& workers;
+            ~Shutdown() {
+                queue.close();
+                for (auto& w : workers) if (w.joinable()) w.join();
+            }
+        } shutdown{queue, workers};
+
+        vector<fs::path> runs;
+        string carry;
+        while (!failed) {
+            string chunk = move(carry);
+            carry.clear();
+            size_t have = chunk.size();
+            chunk.resize(chunkBytes + have);
+            in.read(chunk.data() + have, chunkBytes);
+            chunk.resize(have + in.gcount());
+            stats.bytes += in.gcount();
+            if (chunk.empty()) break;
+            if (in) {                                  // not at EOF : the partial last line waits
+                size_t lastNl = chunk.rfind('\n');
+                if (lastNl != string::npos) {
+                    carry.assign(chunk, lastNl + 1);
+                    chunk.resize(lastNl + 1);
+                }
+            }
+            runs.push_back(runPath());
+            queue.push({move(chunk), runs.back()});
+            if (!in) break;
+        }
+        queue.close();
+        for (auto& w : workers) w.join();
+        if (workerError) rethrow_exception(workerError);
+        return runs;
+    }
+
+public:
+    ExternalSorter(fs::path tmpDir, size_t memoryBudget, int threads, size_t fanIn = 64, size_t readBuffer = 256 << 10)
+        : tmpDir(move(tmpDir)), memoryBudget(memoryBudget), threads(max(1, threads)), fanIn(max<size_t>(2, fanIn)),
+          readBuffer(readBuffer) {
+        fs::create_directories(this->tmpDir);
+    }
+
+    // Sorted view of input. Intermediate passes keep the final merge at <= fanIn runs.
+    unique_ptr<MergedStream> sorted(const fs::path& input, SortStats& stats) {
+        vector<fs::path> runs = generateRuns(input, stats);
+        stats.runs = runs.size();
+        while (runs.size() > fanIn) {
+            stats.mergePasses++;
+            vector<fs::path> merged;
+            for (size_t i = 0; i < runs.size(); i += fanIn) {
+                vector<fs::path> group(runs.begin() + i, runs.begin() + min(runs.size(), i + fanIn));
+                merged.push_back(runPath());
+                {
+                    MergedStream stream(group, readBuffer);
+                    LineWriter out(merged.back());
+                    for (string_view line; stream.next(line);) out.write(line);
+                    out.close();
+                }
+                for (auto& r : group) fs::remove(r);
+            }
+            runs = move(merged);
+        }
+        return make_unique<MergedStream>(runs, readBuffer);
+    }
+};
+
+
+//////////////////////////////////////////
+// Merge join
+//////////////////////////////////////////
+
+struct ReconcileReport {
+    long matched = 0, amountMismatch = 0, notSettled = 0, missingAtGateway = 0, unknownAtGateway = 0, duplicates = 0;
+    SortStats ours, theirs;
+};
+
+// ours : txnId,bookingId,amountCents,currency   settlement : txnId,amountCents,currency,status
+ReconcileReport reconcile(const fs::path& oursPath, const fs::path& settlementPath, const fs::path& reportPath,
+                          ExternalSorter& sorter) {
+    ReconcileReport r;
+    auto ours = sorter.sorted(oursPath, r.ours);
+    auto theirs = sorter.sorted(settlementPath, r.theirs);
+    LineWriter out(reportPath);
+
+    string_view a, b;
+    bool hasA = ours->next(a), hasB = theirs->next(b);
+    string lastA, lastB;          // previous keys, to catch duplicates
+    auto advanceA = [&] {
+        lastA.assign(keyOf(a));
+        hasA = ours->next(a);
+        while (hasA && keyOf(a) == lastA) { r.duplicates++; out.write("duplicate_ours," + string(a)); hasA = ours->next(a); }
+    };
+    auto advanceB = [&] {
+        lastB.assign(keyOf(b));
+        hasB = theirs->next(b);
+        while (hasB && keyOf(b) == lastB) { r.duplicates++; out.write("duplicate_settlement," + string(b)); hasB = theirs->next(b); }
+    };
+
+    while (hasA || hasB) {
+        string_view ka = hasA ? keyOf(a) : string_view(), kb = hasB ? keyOf(b) : string_view();
+        if (hasA && (!hasB || ka < kb)) {
+            r.missingAtGateway++;
+            out.write("missing_at_gateway," + string(a));
+            advanceA();
+        } else if (hasB && (!hasA || kb < ka)) {
+            r.unknownAtGateway++;
+            out.write("unknown_settlement," + string(b));
+            advanceB();
+        } else {
+            auto fa = fields(a), fb = fields(b);
+            if (fb.size() >= 4 && fb[3] != "SETTLED") {            // FAILED, REVERSED ... : money did not move
+                r.notSettled++;
+                out.write("not_settled," + string(a) + "," + string(b));
+            } else if (fa.size() < 4 || fb.size() < 4 || fa[2] != fb[1] || fa[3] != fb[2]) {
+                r.amountMismatch++;
+                out.write("amount_mismatch," + string(a) + "," + string(b));
+            } else {
+                r.matched++;
+            }
+            advanceA();
+            advanceB();
+        }
+    }
+    out.close();
+    return r;
+}
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+static string txnId(uint64_t i) {
+    uint64_t x = i + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    char buf[24];
+    snprintf(buf, sizeof(buf), "tx_%016llx", (unsigned long long)x);
+    return buf;
+}
+
+struct Injected { long missing = 0, unknown = 0, mismatch = 0; };
+
+// Every 1000th txn is missing at the gateway, shifted in amount, or an extra settlement appears.
+Injected generateFiles(const fs::path& ours, const fs::path& settlement, uint64_t n) {
+    Injected inj;
+    LineWriter a(ours), b(settlement);
+    uint64_t step = 7919;                        // coprime with n below : visits every i once
+    while (gcd(step, n) != 1) step++;
+    for (uint64_t i = 0; i < n; i++) {
+        int64_t amount = 500 + (i * 37) % 2000;
+        a.write(txnId(i) + ",b" + to_string(i) + "," + to_string(amount) + ",INR");
+
+        uint64_t j = (i * step) % n;             // settlement file in a different order
+        int64_t amountJ = 500 + (j * 37) % 2000;
+        if (j % 1000 == 1) { inj.missing++; continue; }
+        if (j % 1000 == 2) { inj.mismatch++; amountJ += 100; }
+        b.write(txnId(j) + "," + to_string(amountJ) + ",INR,SETTLED");
+        if (j % 1000 == 3) { inj.unknown++; b.write(txnId(n + j) + ",999,INR,SETTLED"); }
+    }
+    a.close();
+    b.close();
+    return inj;
+}
+
+static long peakRssMb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+}
+
+void checks(const fs::path& dir) {
+    Injected inj = generateFiles(dir / "ours.csv", dir / "settlement.csv", 50000);
+    ExternalSorter sorter(dir / "tmp", 256 << 10, 3, 4, 4096);        // tiny memory : many runs, several merge passes
+    ReconcileReport r = reconcile(dir / "ours.csv", dir / "settlement.csv", dir / "report.csv", sorter);
+
+    cout << "runs " << r.ours.runs << " + " << r.theirs.runs << ", merge passes " << r.ours.mergePasses << "\n";
+    check(r.ours.runs > 4 && r.ours.mergePasses >= 1, "input bigger than the memory budget is sorted through runs and merge passes");
+    check(r.missingAtGateway == inj.missing && r.unknownAtGateway == inj.unknown && r.amountMismatch == inj.mismatch,
+          "every injected mismatch is found (" + to_string(inj.missing) + " missing, " + to_string(inj.unknown) +
+          " unknown, " + to_string(inj.mismatch) + " amount)");
+    check(r.matched == 50000 - inj.missing - inj.mismatch && r.duplicates == 0, "everything else matches");
+
+    {
+        LineWriter extra(dir / "dupes.csv");
+        extra.write("tx_a,1,INR,SETTLED");
+        extra.write("tx_a,1,INR,SETTLED");
+        extra.write("tx_b,2,INR,SETTLED");
+        LineWriter mine(dir / "mine.csv");
+        mine.write("tx_b,b1,2,INR");
+        mine.write("tx_a,b2,1,INR");
+        extra.close();
+        mine.close();
+    }
+    ReconcileReport d = reconcile(dir / "mine.csv", dir / "dupes.csv", dir / "report2.csv", sorter);
+    check(d.duplicates == 1 && d.matched == 2, "a transaction settled twice is reported as a duplicate");
+
+    {
+        LineWriter mine(dir / "status_ours.csv");
+        mine.write("tx_1,b1,100,INR");
+        mine.write("tx_2,b2,200,INR");
+        mine.write("tx_3,b3,300,INR");
+        LineWriter gateway(dir / "status_settlement.csv");
+        gateway.write("tx_1,100,INR,SETTLED");
+        gateway.write("tx_2,200,INR,FAILED");
+        gateway.write("tx_3,300,INR,REVERSED");
+        mine.close();
+        gateway.close();
+    }
+    ReconcileReport st = reconcile(dir / "status_ours.csv", dir / "status_settlement.csv", dir / "report3.csv", sorter);
+    check(st.matched == 1 && st.notSettled == 2, "FAILED and REVERSED settlements are not counted as matched");
+
+    bool missingInput = false;
+    try { reconcile(dir / "nope.csv", dir / "dupes.csv", dir / "report4.csv", sorter); } catch (const runtime_error&) { missingInput = true; }
+    check(missingInput, "a missing input file fails before any worker starts");
+
+    ExternalSorter broken(dir / "gone", 256 << 10, 3, 4, 4096);
+    fs::remove_all(dir / "gone");                                       // run files can no longer be created
+    bool workerFailed = false;
+    try { reconcile(dir / "ours.csv", dir / "settlement.csv", dir / "report5.csv", broken); } catch (const runtime_error&) { workerFailed = true; }
+    check(workerFailed, "a sort worker's exception reaches the caller instead of terminating");
+
+    // Disk full while runs are written : short fwrite / failed fclose must be an error,
+    // not a truncated run that turns into bogus mismatches.
+    rlimit old;
+    getrlimit(RLIMIT_FSIZE, &old);
+    auto oldHandler = signal(SIGXFSZ, SIG_IGN);
+    rlimit tight = {16 << 10, old.rlim_max};
+    setrlimit(RLIMIT_FSIZE, &tight);
+    bool diskFull = false;
+    try { reconcile(dir / "ours.csv", dir / "settlement.csv", dir / "report6.csv", sorter); } catch (const runtime_error&) { diskFull = true; }
+    setrlimit(RLIMIT_FSIZE, &old);
+    signal(SIGXFSZ, oldHandler);
+    check(diskFull, "a run that cannot be fully written fails the reconcile");
+}
+
+void benchmark(const fs::path& dir, uint64_t n, size_t memoryBudget) {
+    fs::create_directories(dir);
+    generateFiles(dir / "ours.csv", dir / "settlement.csv", n);
+    double gb = (fs::file_size(dir / "ours.csv") + fs::file_size(dir / "settlement.csv")) / 1e9;
+    long rssBefore = peakRssMb();
+
+    int threads = max(2u, thread::hardware_concurrency());
+    ExternalSorter sorter(dir / "tmp", memoryBudget, threads);
+    auto t0 = Clock::now();
+    ReconcileReport r = reconcile(dir / "ours.csv", dir / "settlement.csv", dir / "report.csv", sorter);
+    double minutes = chrono::duration<double>(Clock::now() - t0).count() / 60;
+
+    cout << fixed << setprecision(2) << gb << " GB input (" << n << " txns), memory budget " << (memoryBudget >> 20)
+         << " MB, " << threads << " sort threads, " << r.ours.runs + r.theirs.runs << " runs\n";
+    cout << "reconciled in " << minutes * 60 << "s = " << gb / minutes << " GB/min, peak RSS " << peakRssMb()
+         << " MB (before : " << rssBefore << " MB)\n";
+    cout << r.matched << " matched, " << r.missingAtGateway << " missing at gateway, " << r.unknownAtGateway
+         << " unknown, " << r.amountMismatch << " amount mismatches, " << r.notSettled << " not settled\n";
+}
+
+
+int main(int argc, char** argv) {
+    mallopt(M_MMAP_THRESHOLD, 1 << 20);     // big chunks go back to the OS when freed, so RSS follows the budget
+    fs::path dir = "/tmp/settlement_reconcile_demo";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    checks(dir);
+
+    uint64_t n = argc > 1 ? stoull(argv[1]) : 6000000;
+    cout << "\n--- throughput ---\n";
+    benchmark(dir / "bench", n, 64 << 20);
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,452 @@
+/*
+
+Data-Oriented Shape Collection (per-type SoA batches)
+
+Problem :
+    printArea(const Shape&) in SOLID/LSP/theory.cpp is one virtual getArea() per object.
+    The venue layout engine keeps millions of seat and zone shapes as vector<unique_ptr<Shape>> :
+        > every object is its own heap block, scattered in memory
+        > every area is an indirect call the compiler cannot inline or vectorise
+
+Solution :
+
+    ShapeCollection<Rectangle, Square, ...>
+        one Batch<T> per concrete type, each a structure of arrays :
+            Batch<Rectangle> : x[] y[] width[] height[]
+            Batch<Square>    : x[] y[] side[]
+        bulk operations run as one tight loop per type over plain int arrays :
+            totalArea(), areas(out), bounds(), filterByArea(min)
+        per-object access is still there : forEach(f), at(ShapeRef), filter(pred)
+
+    A new shape type = a plain struct + a ShapeTraits<T> specialisation that lists its fields
+    and says how to compute its area and box from them. Nothing else changes.
+
+Order : a collection is grouped by type (all Rectangles, then all Squares ...). areas(out) and
+forEach follow that order; ShapeRef { type, index } identifies one object.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+
+//////////////////////////////////////////
+// Shapes + traits
+//////////////////////////////////////////
+
+struct Rectangle {
+    int x, y;
+    int width, height;
+
+    int getArea() const { return width * height; }
+};
+
+struct Square {
+    int x, y;
+    int side;
+
+    int getArea() const { return side * side; }
+};
+
+struct Box {
+    int minX, minY, maxX, maxY;
+};
+
+// Field list + kernels, written against column pointers so loops stay branch-free.
+template <typename T>
+struct ShapeTraits;
+
+template <>
+struct ShapeTraits<Rectangle> {
+    static constexpr auto fields = make_tuple(&Rectangle::x, &Rectangle::y, &Rectangle::width, &Rectangle::height);
+    enum { X, Y, W, H };
+
+    static int64_t area(const int* const* c, size_t i) { return (int64_t)c[W][i] * c[H][i]; }
+    static int maxX(const int* const* c, size_t i) { return c[X][i] + c[W][i]; }
+    static int maxY(const int* const* c, size_t i) { return c[Y][i] + c[H][i]; }
+};
+
+template <>
+struct ShapeTraits<Square> {
+    static constexpr auto fields = make_tuple(&Square::x, &Square::y, &Square::side);
+    enum { X, Y, S };
+
+    static int64_t area(const int* const* c, size_t i) { return (int64_t)c[S][i] * c[S][i]; }
+    static int maxX(const int* const* c, size_t i) { return c[X][i] + c[S][i]; }
+    static int maxY(const int* const* c, size_t i) { return c[Y][i] + c[S][i]; }
+};
+
+
+//////////////////////////////////////////
+// One SoA batch per type
+//////////////////////////////////////////
+
+template <typename T>
+class Batch {
+private:
+    using Traits = ShapeTraits<T>;
+    static constexpr size_t FieldCount = tuple_size_v<decay_t<decltype(Traits::fields)>>;
+
+    array<vector<int>, FieldCount> columns;
+
+    array<const int*, FieldCount> pointers() const {
+        array<const int*, FieldCount> p;
+        for (size_t f = 0; f < FieldCount; f++) p[f] = columns[f].data();
+        return p;
+    }
+
+public:
+    size_t size() const { return columns[0].size(); }
+
+    void reserve(size_t n) {
+        for (auto& c : columns) c.reserve(n);
+    }
+
+    size_t add(const T& shape) {
+        size_t f = 0;
+        apply([&](auto... member) { ((columns[f++].push_back(shape.*member)), ...); }, Traits::fields);
+        return size() - 1;
+    }
+
+    T get(size_t i) const {
+        T shape{};
+        size_t f = 0;
+        apply([&](auto... member) { ((shape.*member = columns[f++][i]), ...); }, Traits::fields);
+        return shape;
+    }
+
+    int64_t totalArea() const {
+        auto c = pointers();
+        int64_t sum = 0;
+        for (size_t i = 0, n = size(); i < n; i++) sum += Traits::area(c.data(), i);
+        return sum;
+    }
+
+    int64_t* areas(int64_t* out) const {
+        auto c = pointers();
+        for (size_t i = 0, n = size(); i < n; i++) out[i] = Traits::area(c.data(), i);
+        return out + size();
+    }
+
+    void extend(Box& box) const {
+        auto c = pointers();
+        int minX = box.minX, minY = box.minY, maxX = box.maxX, maxY = box.maxY;
+        for (size_t i = 0, n = size(); i < n; i++) {
+            minX = min(minX, c[0][i]);
+            minY = min(minY, c[1][i]);
+            maxX = max(maxX, Traits::maxX(c.data(), i));
+            maxY = max(maxY, Traits::maxY(c.data(), i));
+        }
+        box = {minX, minY, maxX, maxY};
+    }
+
+    // Writes matching indices without a branch per element; returns how many matched.
+    size_t filterByArea(int64_t minArea, uint32_t* out) const {
+        auto c = pointers();
+        size_t k = 0;
+        for (size_t i = 0, n = size(); i < n; i++) {
+            out[k] = (uint32_t)i;
+            k += Traits::area(c.data(), i) >= minArea;
+        }
+        return k;
+    }
+
+    void clear() {
+        for (auto& c : columns) c.clear();
+    }
+};
+
+
+//////////////////////////////////////////
+// The heterogeneous collection
+//////////////////////////////////////////
+
+struct ShapeRef {
+    uint32_t type;            // position of the type in ShapeCollection<Types...>
+    uint32_t index;           // position inside that type's batch
+
+    bool operator==(const ShapeRef&) const = default;
+};
+
+template <typename... Types>
+class ShapeCollection {
+private:
+    tuple<Batch<Types>...> batches;
+
+    template <typename T, size_t I = 0>
+    static constexpr uint32_t typeIndex() {
+        static_assert(I < sizeof...(Types), "type is not part of this collection");
+        if constexpr (is_same_v<T, tuple_element_t<I, tuple<Types...>>>) return I;
+        else return typeIndex<T, I + 1>();
+    }
+
+    template <typename F>
+    void eachBatch(F f) const {
+        [&]<size_t... I>(index_sequence<I...>) { (f(integral_constant<uint32_t, I>{}, get<I>(batches)), ...); }(index_sequence_for<Types...>{});
+    }
+
+    template <typename F>
+    void eachBatch(F f) {
+        [&]<size_t... I>(index_sequence<I...>) { (f(integral_constant<uint32_t, I>{}, get<I>(batches)), ...); }(index_sequence_for<Types...>{});
+    }
+
+public:
+    using Shape = variant<Types...>;
+
+    template <typename T>
+    ShapeRef add(const T& shape) {
+        return {typeIndex<T>(), (uint32_t)get<Batch<T>>(batches).add(shape)};
+    }
+
+    template <typename T>
+    const Batch<T>& batch() const { return get<Batch<T>>(batches); }
+
+    template <typename T>
+    void reserve(size_t n) { get<Batch<T>>(batches).reserve(n); }
+
+    size_t size() const {
+        size_t n = 0;
+        eachBatch([&](auto, auto& b) { n += b.size(); });
+        return n;
+    }
+
+    int64_t totalArea() const {
+        int64_t sum = 0;
+        eachBatch([&](auto, auto& b) { sum += b.totalArea(); });
+        return sum;
+    }
+
+    // out must hold size() values; they come out grouped by type, in forEach order.
+    void areas(span<int64_t> out) const {
+        if (out.size() < size()) throw invalid_argument("areas : output span too small");
+        int64_t* cursor = out.data();
+        eachBatch([&](auto, auto& b) { cursor = b.areas(cursor); });
+    }
+
+    Box bounds() const {
+        Box box{INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+        eachBatch([&](auto, auto& b) { b.extend(box); });
+        return box;
+    }
+
+    // const and reentrant : the index buffer belongs to the call, so concurrent queries do not share it.
+    vector<ShapeRef> filterByArea(int64_t minArea) const {
+        vector<ShapeRef> out;
+        vector<uint32_t> hits;
+        eachBatch([&](auto type, auto& b) {
+            hits.resize(b.size() + 1);
+            size_t k = b.filterByArea(minArea, hits.data());
+            out.reserve(out.size() + k);
+            for (size_t i = 0; i < k; i++) out.push_back({type, hits[i]});
+        });
+        return out;
+    }
+
+    // Per-object iteration : f is called with each concrete shape (a generic lambda works).
+    template <typename F>
+    void forEach(F f) const {
+        eachBatch([&](auto, auto& b) {
+            for (size_t i = 0, n = b.size(); i < n; i++) f(b.get(i));
+        });
+    }
+
+    template <typename Pred>
+    vector<ShapeRef> filter(Pred pred) const {
+        vector<ShapeRef> out;
+        eachBatch([&](auto type, auto& b) {
+            for (size_t i = 0, n = b.size(); i < n; i++) {
+                if (pred(b.get(i))) out.push_back({type, (uint32_t)i});
+            }
+        });
+        return out;
+    }
+
+    Shape at(ShapeRef ref) const {
+        if (ref.type >= sizeof...(Types)) throw out_of_range("ShapeRef type out of range");
+        Shape result;
+        eachBatch([&](auto type, auto& b) {
+            if (type == ref.type) {
+                if (ref.index >= b.size()) throw out_of_range("ShapeRef index out of range");
+                result = b.get(ref.index);
+            }
+        });
+        return result;
+    }
+
+    void clear() {
+        eachBatch([&](auto, auto& b) { b.clear(); });
+    }
+};
+
+using VenueShapes = ShapeCollection<Rectangle, Square>;
+
+
+//////////////////////////////////////////
+// Baseline : the LSP hierarchy behind unique_ptr
+//////////////////////////////////////////
+
+class Shape {
+public:
+    virtual int getArea() const = 0;
+    virtual Box box() const = 0;
+    virtual ~Shape() = default;
+};
+
+class RectangleShape : public Shape {
+private:
+    int x, y, width, height;
+
+public:
+    RectangleShape(int x, int y, int w, int h) : x(x), y(y), width(w), height(h) {}
+    int getArea() const override { return width * height; }
+    Box box() const override { return {x, y, x + width, y + height}; }
+};
+
+class SquareShape : public Shape {
+private:
+    int x, y, side;
+
+public:
+    SquareShape(int x, int y, int s) : x(x), y(y), side(s) {}
+    int getArea() const override { return side * side; }
+    Box box() const override { return {x, y, x + side, y + side}; }
+};
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    VenueShapes shapes;
+    auto r = shapes.add(Rectangle{0, 0, 5, 10});
+    auto s = shapes.add(Square{20, -5, 10});
+    shapes.add(Rectangle{-3, 2, 2, 2});
+
+    check(shapes.size() == 3 && shapes.totalArea() == 50 + 100 + 4, "totalArea sums every batch");
+
+    vector<int64_t> areas(shapes.size());
+    shapes.areas(areas);
+    check(areas == vector<int64_t>{50, 4, 100}, "areas(out) is grouped by type, rectangles first");
+
+    Box b = shapes.bounds();
+    check(b.minX == -3 && b.minY == -5 && b.maxX == 30 && b.maxY == 10, "bounds covers all shapes");
+
+    auto big = shapes.filterByArea(50);
+    check(big == vector<ShapeRef>{r, s}, "filterByArea returns references to matching shapes");
+    check(holds_alternative<Square>(shapes.at(s)) && get<Square>(shapes.at(s)).side == 10, "a ShapeRef resolves back to the concrete shape");
+    auto rejected = [&](ShapeRef ref) {
+        try { shapes.at(ref); } catch (const out_of_range&) { return true; }
+        return false;
+    };
+    check(rejected({0, 2}) && rejected({2, 0}) && !rejected({1, 0}), "at() rejects a bad index or a bad type");
+
+    const VenueShapes& readOnly = shapes;
+    vector<vector<ShapeRef>> results(4);
+    vector<thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t] { for (int i = 0; i < 1000; i++) results[t] = readOnly.filterByArea(50); });
+    }
+    for (auto& reader : readers) reader.join();
+    check(all_of(results.begin(), results.end(), [&](auto& found) { return found == big; }),
+          "filterByArea is const and safe to run from several threads at once");
+
+    int rectangles = 0, squares = 0;
+    shapes.forEach([&](const auto& shape) {
+        if constexpr (is_same_v<decay_t<decltype(shape)>, Rectangle>) rectangles++;
+        else squares++;
+    });
+    auto wide = shapes.filter([](const auto& shape) { return shape.x >= 0; });
+    check(rectangles == 2 && squares == 1 && wide.size() == 2, "per-object forEach and filter see concrete types");
+}
+
+
+//////////////////////////////////////////
+// Benchmark vs vector<unique_ptr<Shape>>
+//////////////////////////////////////////
+
+template <typename F>
+double msFor(int repeats, F body) {
+    body();
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) body();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+}
+
+int main() {
+    checks();
+
+    const size_t n = 4000000;                         // ~85% seats (squares), the rest zones
+    mt19937 rng(7);
+    VenueShapes soa;
+    soa.reserve<Square>(n);
+    soa.reserve<Rectangle>(n / 4);
+    vector<unique_ptr<Shape>> objects;
+    objects.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int x = int(rng() % 100000), y = int(rng() % 100000);
+        if (rng() % 100 < 85) {
+            int side = 40 + int(rng() % 20);
+            soa.add(Square{x, y, side});
+            objects.push_back(make_unique<SquareShape>(x, y, side));
+        } else {
+            int w = 100 + int(rng() % 2000), h = 100 + int(rng() % 1000);
+            soa.add(Rectangle{x, y, w, h});
+            objects.push_back(make_unique<RectangleShape>(x, y, w, h));
+        }
+    }
+
+    int64_t soaTotal = soa.totalArea(), ptrTotal = 0;
+    for (auto& o : objects) ptrTotal += o->getArea();
+    check(soaTotal == ptrTotal, "both layouts agree on total area");
+
+    vector<int64_t> out(n);
+    int64_t sink = 0;
+    const int repeats = 10;
+    const int64_t threshold = 100000;
+
+    cout << "\n--- " << n << " shapes, ms per pass ---\n";
+    cout << left << setw(18) << "operation" << right << setw(22) << "unique_ptr<Shape>" << setw(16) << "SoA batches" << setw(10) << "speedup" << "\n";
+    auto row = [&](const string& label, double ptrMs, double soaMs) {
+        cout << left << setw(18) << label << right << fixed << setprecision(2) << setw(19) << ptrMs << " ms" << setw(13) << soaMs
+             << " ms" << setw(9) << setprecision(1) << ptrMs / soaMs << "x\n";
+    };
+
+    row("totalArea",
+        msFor(repeats, [&] { int64_t t = 0; for (auto& o : objects) t += o->getArea(); sink += t; }),
+        msFor(repeats, [&] { sink += soa.totalArea(); }));
+    row("areas(out)",
+        msFor(repeats, [&] { for (size_t i = 0; i < n; i++) out[i] = objects[i]->getArea(); sink += out[n / 2]; }),
+        msFor(repeats, [&] { soa.areas(out); sink += out[n / 2]; }));
+    row("bounds",
+        msFor(repeats, [&] {
+            Box b{INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+            for (auto& o : objects) {
+                Box s = o->box();
+                b = {min(b.minX, s.minX), min(b.minY, s.minY), max(b.maxX, s.maxX), max(b.maxY, s.maxY)};
+            }
+            sink += b.maxX;
+        }),
+        msFor(repeats, [&] { sink += soa.bounds().maxX; }));
+    row("filterByArea",
+        msFor(repeats, [&] {
+            vector<const Shape*> hits;
+            for (auto& o : objects) if (o->getArea() >= threshold) hits.push_back(o.get());
+            sink += hits.size();
+        }),
+        msFor(repeats, [&] { sink += soa.filterByArea(threshold).size(); }));
+    row("forEach (object)",
+        msFor(repeats, [&] { int64_t t = 0; for (auto& o : objects) t += o->getArea(); sink += t; }),
+        msFor(repeats, [&] { int64_t t = 0; soa.forEach([&](const auto& s) { t += s.getArea(); }); sink += t; }));
+
+    size_t soaBytes = soa.batch<Square>().size() * 3 * sizeof(int) + soa.batch<Rectangle>().size() * 4 * sizeof(int);
+    size_t ptrBytes = n * (sizeof(unique_ptr<Shape>) + 32);      // pointer + 24..32 byte heap block incl. malloc header
+    cout << "memory : SoA " << soaBytes / 1e6 << " MB vs ~" << ptrBytes / 1e6 << " MB for pointers + heap blocks\n";
+    if (sink == 42) cout << "";
+    return 0;
+}
@@ -0,0 +1,535 @@
+/*
+
+Consistent-Hash Sharding of Shows Across Worker Processes
+
+Today all booking state is in one process. ITicketRepository (DIP/example.cpp) is an
+abstraction, so the service does not care WHERE bookTicket runs. We use that to fan out :
+
+    BookTicketServiceDIP -> ShardedTicketRepository (router) --unix socket--> worker 0
+                                                             --unix socket--> worker 1
+                                                             --unix socket--> worker 2
+
+> Every show (movieId) lives on exactly one worker, so a show's seats are never
+  touched by two processes -> no cross-process locking.
+> Which worker? Consistent hashing :
+      - every worker is placed on a hash ring 128 times ("virtual nodes")
+      - a show goes to the first virtual node clockwise from hash(movieId)
+  Adding or removing a worker only moves ~1/N of the shows (plain hash % N would move
+  almost all of them), and virtual nodes keep the load even.
+> Rebalance : when the ring changes, the router asks the old owner to hand over
+  each moved show's state (EXPORT) and gives it to the new owner (IMPORT).
+  The router pauses requests while this happens.
+> Workers are real processes talking over SOCK_SEQPACKET unix sockets, so everything
+  runs on one machine. They are forked by a ZYGOTE : a tiny helper process started at the
+  top of main(), before any thread exists. The router asks it for a worker and gets the
+  socket back over SCM_RIGHTS, so workers can be added while client threads are booking
+  (forking the multi-threaded router itself would not be safe).
+
+*/
+
+#include<bits/stdc++.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Wire format
+//////////////////////////////////////////
+
+enum class Op : uint32_t { Book, Export, Import, Stop };
+
+struct Message {
+    Op op;
+    int64_t value;          // Book reply : seat sequence (-1 = sold out). Export/Import : seats sold.
+    char movieId[24];
+    char userId[24];
+};
+
+// Ids must fit whole : truncating would let two shows that share a 23-byte prefix share
+// one seat counter on a worker.
+static void copyField(char (&dst)[24], const string& src) {
+    if (src.size() >= sizeof(dst) || src.find('\0') != string::npos) {
+        throw invalid_argument("id '" + src.substr(0, 32) + "' must be under 24 bytes with no NUL");
+    }
+    memset(dst, 0, sizeof(dst));
+    memcpy(dst, src.data(), src.size());
+}
+
+static void sendMessage(int fd, const Message& m) {
+    if (::send(fd, &m, sizeof(m), MSG_NOSIGNAL) != (ssize_t)sizeof(m)) throw runtime_error("worker connection lost");
+}
+
+static Message receiveMessage(int fd) {
+    Message m;
+    if (::recv(fd, &m, sizeof(m), 0) != (ssize_t)sizeof(m)) throw runtime_error("worker connection lost");
+    return m;
+}
+
+
+//////////////////////////////////////////
+// Worker process
+//////////////////////////////////////////
+
+// Owns the seat inventory of the shows that hash to it.
+void workerMain(int fd, int capacityPerShow, chrono::microseconds writeLatency) {
+    unordered_map<string, int64_t> soldPerShow;
+    while (true) {
+        Message m;
+        if (::recv(fd, &m, sizeof(m), 0) != (ssize_t)sizeof(m)) break;
+        string movie(m.movieId);
+        switch (m.op) {
+            case Op::Book: {
+                int64_t& sold = soldPerShow[movie];
+                this_thread::sleep_for(writeLatency);             // persisting the booking
+                m.value = sold < capacityPerShow ? ++sold : -1;
+                break;
+            }
+            case Op::Export: {
+                auto it = soldPerShow.find(movie);
+                m.value = it == soldPerShow.end() ? 0 : it->second;
+                if (it != soldPerShow.end()) soldPerShow.erase(it);
+                break;
+            }
+            case Op::Import:
+                soldPerShow[movie] = m.value;
+                break;
+            case Op::Stop:
+                ::close(fd);
+                return;
+        }
+        sendMessage(fd, m);
+    }
+    ::close(fd);
+}
+
+
+//////////////////////////////////////////
+// Zygote : forks workers on the router's behalf
+//////////////////////////////////////////
+
+struct SpawnRequest {
+    int capacityPerShow;
+    int64_t writeLatencyMicros;
+};
+
+static void sendWithFd(int sock, const void* data, size_t len, int fd) {
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    iovec iov{const_cast<void*>(data), len};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) != (ssize_t)len) throw runtime_error("zygote connection lost");
+}
+
+static int receiveWithFd(int sock, void* data, size_t len) {
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    iovec iov{data, len};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != (ssize_t)len) throw runtime_error("zygote connection lost");
+    cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    if (!c || c->cmsg_type != SCM_RIGHTS) throw runtime_error("zygote sent no socket");
+    int fd;
+    memcpy(&fd, CMSG_DATA(c), sizeof(int));
+    return fd;
+}
+
+class Zygote {
+private:
+    pid_t pid = -1;
+    int fd = -1;
+    mutex lock;                   // one spawn at a time on the control socket
+
+    Zygote() = default;
+
+    // Runs in the zygote. Single-threaded, so forking from here is always safe.
+    [[noreturn]] static void serve(int control) {
+        signal(SIGCHLD, SIG_IGN);                  // workers are reaped automatically
+        SpawnRequest request;
+        while (::recv(control, &request, sizeof(request), 0) == (ssize_t)sizeof(request)) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) < 0) _exit(1);
+            pid_t worker = fork();
+            if (worker == 0) {
+                ::close(control);
+                ::close(fds[0]);
+                workerMain(fds[1], request.capacityPerShow, chrono::microseconds(request.writeLatencyMicros));
+                _exit(0);
+            }
+            ::close(fds[1]);
+            sendWithFd(control, &worker, sizeof(worker), fds[0]);
+            ::close(fds[0]);
+        }
+        _exit(0);
+    }
+
+public:
+    // Call once at the top of main(), before any thread is started.
+    static Zygote& start() {
+        static Zygote* z = [] {
+            auto* z = new Zygote();
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) throw runtime_error("socketpair failed");
+            z->pid = fork();
+            if (z->pid < 0) throw runtime_error("fork failed");
+            if (z->pid == 0) {
+                ::close(fds[0]);
+                serve(fds[1]);
+            }
+            ::close(fds[1]);
+            z->fd = fds[0];
+            return z;
+        }();
+        return *z;
+    }
+
+    // Thread-safe. Returns the router's end of the new worker's socket.
+    pair<pid_t, int> spawn(int capacityPerShow, chrono::microseconds writeLatency) {
+        lock_guard<mutex> guard(lock);
+        SpawnRequest request{capacityPerShow, writeLatency.count()};
+        if (::send(fd, &request, sizeof(request), MSG_NOSIGNAL) != (ssize_t)sizeof(request)) throw runtime_error("zygote connection lost");
+        pid_t worker;
+        int socket = receiveWithFd(fd, &worker, sizeof(worker));
+        return {worker, socket};
+    }
+};
+
+
+//////////////////////////////////////////
+// Consistent hash ring
+//////////////////////////////////////////
+
+class HashRing {
+private:
+    int virtualNodes;
+    vector<pair<uint64_t, int>> ring;      // (point, worker id), sorted
+
+    // 64-bit FNV-1a + a final mix so nearby strings land far apart
+    static uint64_t hash(string_view s) {
+        uint64_t h = 1469598103934665603ull;
+        for (char c : s) h = (h ^ (uint8_t)c) * 1099511628211ull;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+public:
+    HashRing(int virtualNodes = 128) : virtualNodes(virtualNodes) {}
+
+    void add(int worker) {
+        for (int v = 0; v < virtualNodes; v++) {
+            ring.push_back({hash("worker-" + to_string(worker) + "#" + to_string(v)), worker});
+        }
+        sort(ring.begin(), ring.end());
+    }
+
+    void remove(int worker) {
+        erase_if(ring, [&](auto& p) { return p.second == worker; });
+    }
+
+    int ownerOf(string_view key) const {
+        if (ring.empty()) throw runtime_error("no workers");
+        auto it = lower_bound(ring.begin(), ring.end(), make_pair(hash(key), INT_MIN));
+        return it == ring.end() ? ring.front().second : it->second;
+    }
+};
+
+
+//////////////////////////////////////////
+// Router = ITicketRepository that forwards to the owning worker
+//////////////////////////////////////////
+
+class ITicketRepository {
+public:
+    virtual string bookTicket(const string& userId, const string& movieId) = 0;
+    virtual ~ITicketRepository() = default;
+};
+
+class ShardedTicketRepository : public ITicketRepository {
+private:
+    struct Worker {
+        pid_t pid;
+        int fd;
+        mutex lock;          // one request at a time per connection
+    };
+
+    Zygote& zygote;
+    int capacityPerShow;
+    chrono::microseconds writeLatency;
+    shared_mutex ringLock;   // shared for bookings, exclusive while rebalancing
+    mutex turnstile;         // a waiting rebalance holds this so new bookings queue behind it
+                             // (shared_mutex alone lets a steady stream of readers starve it)
+    HashRing ring;
+    map<int, unique_ptr<Worker>> workers;
+    set<string> knownShows;  // inserted under shared ringLock + showsLock
+    mutex showsLock;
+    int nextWorkerId = 0;
+
+    Message call(Worker& w, const Message& request) {
+        lock_guard<mutex> guard(w.lock);
+        sendMessage(w.fd, request);
+        return receiveMessage(w.fd);
+    }
+
+    // Sends Stop and waits for the worker to close its end (it is the zygote's child, not ours).
+    static void stopWorker(Worker& w) {
+        Message stop{Op::Stop, 0, {}, {}};
+        sendMessage(w.fd, stop);
+        char byte;
+        while (::recv(w.fd, &byte, 1, 0) > 0) {}
+        ::close(w.fd);
+    }
+
+    // Moves every show whose owner changed. Caller holds ringLock exclusively, so no
+    // booking can add a show while we walk the copy.
+    int migrate(const function<int(const string&)>& oldOwner) {
+        set<string> shows;
+        {
+            lock_guard<mutex> guard(showsLock);
+            shows = knownShows;
+        }
+        int moved = 0;
+        for (const string& show : shows) {
+            int from = oldOwner(show), to = ring.ownerOf(show);
+            if (from == to) continue;
+            Message m{Op::Export, 0, {}, {}};
+            copyField(m.movieId, show);
+            m = call(*workers.at(from), m);
+            m.op = Op::Import;
+            call(*workers.at(to), m);
+            moved++;
+        }
+        return moved;
+    }
+
+public:
+    ShardedTicketRepository(Zygote& zygote, int capacityPerShow, chrono::microseconds writeLatency)
+        : zygote(zygote), capacityPerShow(capacityPerShow), writeLatency(writeLatency) {}
+
+    ~ShardedTicketRepository() {
+        for (auto& [id, w] : workers) {
+            try { stopWorker(*w); } catch (const exception&) { ::close(w->fd); }
+        }
+    }
+
+    // Starts a new worker and moves the shows it now owns. Returns how many moved.
+    // Safe while other threads are booking : they wait on ringLock during the move.
+    int addWorker() {
+        auto [pid, fd] = zygote.spawn(capacityPerShow, writeLatency);
+
+        lock_guard<mutex> gate(turnstile);
+        unique_lock<shared_mutex> guard(ringLock);
+        int id = nextWorkerId++;
+        auto w = make_unique<Worker>();
+        w->pid = pid;
+        w->fd = fd;
+        workers[id] = move(w);
+
+        HashRing before = ring;
+        ring.add(id);
+        if (workers.size() == 1) return 0;
+        return migrate([&](const string& show) { return before.ownerOf(show); });
+    }
+
+    // Hands the worker's shows to the remaining workers, then stops it.
+    int removeWorker(int id) {
+        lock_guard<mutex> gate(turnstile);
+        unique_lock<shared_mutex> guard(ringLock);
+        auto it = workers.find(id);
+        if (it == workers.end()) throw invalid_argument("no worker " + to_string(id));
+        if (workers.size() <= 1) throw runtime_error("cannot remove the last worker");
+        HashRing before = ring;
+        ring.remove(id);
+        int moved = migrate([&](const string& show) { return before.ownerOf(show); });
+
+        stopWorker(*it->second);
+        workers.erase(it);
+        return moved;
+    }
+
+    string bookTicket(const string& userId, const string& movieId) override {
+        Message m{Op::Book, 0, {}, {}};
+        copyField(m.movieId, movieId);        // rejects bad ids before the show is remembered
+        copyField(m.userId, userId);
+        { lock_guard<mutex> gate(turnstile); }
+        shared_lock<shared_mutex> guard(ringLock);
+        {
+            lock_guard<mutex> shows(showsLock);
+            knownShows.insert(movieId);
+        }
+        int owner = ring.ownerOf(movieId);
+        m = call(*workers.at(owner), m);
+        if (m.value < 0) throw runtime_error("show " + movieId + " is sold out");
+        return movieId + "-" + to_string(m.value) + "@w" + to_string(owner);
+    }
+
+    int ownerOf(const string& movieId) {
+        shared_lock<shared_mutex> guard(ringLock);
+        return ring.ownerOf(movieId);
+    }
+
+    vector<int> workerIds() {
+        shared_lock<shared_mutex> guard(ringLock);
+        vector<int> ids;
+        for (auto& [id, w] : workers) ids.push_back(id);
+        return ids;
+    }
+};
+
+class BookTicketServiceDIP {
+    ITicketRepository* repo;
+public:
+    BookTicketServiceDIP(ITicketRepository* repository) : repo(repository) {}
+
+    string execute(const string& userId, const string& movieId) {
+        return repo->bookTicket(userId, movieId);
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void rebalanceDemo(Zygote& zygote) {
+    ShardedTicketRepository repo(zygote, 1000, chrono::microseconds(0));
+    BookTicketServiceDIP service(&repo);
+    for (int i = 0; i < 3; i++) repo.addWorker();
+
+    const int shows = 1000;
+    for (int s = 0; s < shows; s++) service.execute("u1", "m" + to_string(s));
+
+    int moved = repo.addWorker();
+    cout << "adding a 4th worker moved " << moved << " of " << shows << " shows\n";
+    check(moved > shows / 8 && moved < shows / 2, "roughly 1/4 of the shows move when going from 3 to 4 workers");
+
+    bool continued = true;
+    for (int s = 0; s < shows; s++) {
+        string id = service.execute("u2", "m" + to_string(s));
+        continued &= id.rfind("m" + to_string(s) + "-2@", 0) == 0;    // second seat of every show
+    }
+    check(continued, "moved shows keep their seat counts on the new worker");
+
+    moved = repo.removeWorker(repo.ownerOf("m7"));
+    cout << "removing the owner of m7 moved " << moved << " shows\n";
+    check(service.execute("u3", "m7").rfind("m7-3@", 0) == 0, "shows of a removed worker survive on another worker");
+
+    size_t before = repo.workerIds().size();
+    bool unknownRejected = false;
+    try { repo.removeWorker(12345); } catch (const invalid_argument&) { unknownRejected = true; }
+    check(unknownRejected && repo.workerIds().size() == before && service.execute("u4", "m7").rfind("m7-4@", 0) == 0,
+          "removing an unknown worker id is rejected and leaves the ring alone");
+
+    string prefix(23, 'x');
+    int rejected = 0;
+    for (string id : {prefix + "-evening", prefix + "-morning", string("m1\0b", 4)}) {
+        try { service.execute("u5", id); } catch (const invalid_argument&) { rejected++; }
+    }
+    try { service.execute(string(30, 'u'), "m1"); } catch (const invalid_argument&) { rejected++; }
+    check(rejected == 4 && repo.addWorker() >= 0, "ids that do not fit the wire format are rejected instead of truncated");
+}
+
+// Workers come and go while 8 client threads book. Every show must end up with exactly
+// as many seats sold as bookings that succeeded.
+void rebalanceUnderTraffic(Zygote& zygote) {
+    ShardedTicketRepository repo(zygote, INT_MAX, chrono::microseconds(0));
+    BookTicketServiceDIP service(&repo);
+    for (int i = 0; i < 2; i++) repo.addWorker();
+
+    const int shows = 200;
+    vector<atomic<long>> booked(shows);
+    atomic<bool> stop{false};
+    atomic<long> errors{0};
+    vector<thread> clients;
+    for (int t = 0; t < 8; t++) {
+        clients.emplace_back([&, t] {
+            mt19937 rng(t);
+            while (!stop) {
+                int s = rng() % shows;
+                try {
+                    service.execute("u" + to_string(t), "m" + to_string(s));
+                    booked[s]++;
+                } catch (const exception&) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    int changes = 0;
+    for (int round = 0; round < 6; round++) {
+        this_thread::sleep_for(chrono::milliseconds(30));
+        repo.addWorker();
+        this_thread::sleep_for(chrono::milliseconds(30));
+        if (round % 2) repo.removeWorker(repo.workerIds().front());
+        changes++;
+    }
+    stop = true;
+    for (auto& c : clients) c.join();
+
+    bool consistent = true;
+    long total = 0;
+    for (int s = 0; s < shows; s++) {
+        string id = service.execute("check", "m" + to_string(s));
+        consistent &= id.rfind("m" + to_string(s) + "-" + to_string(booked[s] + 1) + "@", 0) == 0;
+        total += booked[s];
+    }
+    check(errors == 0 && consistent && total > 0,
+          "workers added/removed " + to_string(changes) + "x under traffic : " + to_string(total) + " bookings, no seat lost or doubled");
+}
+
+void benchmarkScaling(Zygote& zygote, int maxWorkers) {
+    for (int n = 1; n <= maxWorkers; n *= 2) {
+        ShardedTicketRepository repo(zygote, INT_MAX, chrono::microseconds(100));
+        for (int i = 0; i < n; i++) repo.addWorker();
+        BookTicketServiceDIP service(&repo);
+
+        atomic<long> done{0};
+        vector<thread> clients;
+        auto start = Clock::now();
+        for (int t = 0; t < 16; t++) {
+            clients.emplace_back([&, t] {
+                mt19937 rng(t);
+                for (int i = 0; i < 300; i++) {
+                    service.execute("u" + to_string(t), "m" + to_string(rng() % 500));
+                    done++;
+                }
+            });
+        }
+        for (auto& c : clients) c.join();
+        double sec = chrono::duration<double>(Clock::now() - start).count();
+        cout << setw(2) << n << " shard(s) : " << (long)(done / sec) << " bookings/sec\n";
+    }
+}
+
+
+int main() {
+    Zygote& zygote = Zygote::start();             // before any thread
+    rebalanceDemo(zygote);
+    rebalanceUnderTraffic(zygote);
+
+    cout << "\n--- throughput, 16 client threads, 100us write per booking ---\n";
+    benchmarkScaling(zygote, 8);
+
+    return 0;
+}
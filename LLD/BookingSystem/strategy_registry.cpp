@@ -0,0 +1,508 @@
+/*
+
+Hot-Swappable Strategy Registry (epoch-based RCU)
+
+Problem :
+    PaymentProcessor and DiscountEngine (SOLID/OCP) own one unique_ptr strategy, fixed at
+    construction. Changing it under traffic (new discount rules, turning off a broken gateway)
+    means either rebuilding every processor or putting a lock around every call.
+
+Solution : read-copy-update
+
+    StrategyRegistry<Strategy>
+        current -> immutable State { name -> shared_ptr<const Strategy>, version }
+
+    Readers  : snapshot() = announce the epoch + one atomic load. No lock, no refcount,
+               no retry loop : wait-free. The State stays alive while the Snapshot exists.
+    Writers  : copy State, change the copy, publish it with one atomic store,
+               then RETIRE the old State instead of deleting it.
+    EpochDomain (one per process) frees a retired State once every reader that could still see it has left.
+
+    LivePaymentProcessor / LiveDiscountEngine : look up their strategy by name on each call,
+    so a registry update takes effect on the very next request.
+
+Strategies must be safe to call from many threads at once, so pay() / getDiscount() are const.
+
+*/
+
+#include<bits/stdc++.h>
+#include<ctime>
+using namespace std;
+
+
+//////////////////////////////////////////
+// Epoch-based reclamation
+//////////////////////////////////////////
+
+class EpochDomain {
+private:
+    static constexpr int MaxThreads = 128;
+
+    struct alignas(64) Slot {
+        atomic<uint64_t> active{0};           // epoch the reader entered with, 0 = not reading
+        atomic<bool> used{false};
+        uint32_t depth = 0;                   // nesting count, touched only by the owning thread
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        function<void()> free;
+    };
+
+    atomic<uint64_t> epoch{1};
+    Slot slots[MaxThreads];
+    mutex retireLock;
+    deque<Retired> retired;
+
+    EpochDomain() = default;
+
+    // One slot per thread, handed back when the thread exits. The domain itself is never
+    // destroyed, so a thread exiting late can always release its slot safely.
+    Slot& mySlot() {
+        struct Claim {
+            Slot* slot = nullptr;
+            ~Claim() { if (slot) slot->used.store(false, memory_order_release); }
+        };
+        static thread_local Claim claim;
+        if (claim.slot) [[likely]] return *claim.slot;
+        for (auto& s : slots) {
+            bool expected = false;
+            if (s.used.compare_exchange_strong(expected, true)) return *(claim.slot = &s);
+        }
+        throw runtime_error("EpochDomain : too many reader threads");
+    }
+
+    uint64_t oldestActive() const {
+        uint64_t oldest = UINT64_MAX;
+        for (auto& s : slots) {
+            uint64_t e = s.active.load(memory_order_seq_cst);
+            if (e) oldest = min(oldest, e);
+        }
+        return oldest;
+    }
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain* domain = new EpochDomain();
+        return *domain;
+    }
+
+    class Guard {
+        Slot* slot;
+    public:
+        explicit Guard(Slot* slot) : slot(slot) {}
+        Guard(Guard&& other) noexcept : slot(exchange(other.slot, nullptr)) {}
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() { if (slot && --slot->depth == 0) slot->active.store(0, memory_order_release); }
+    };
+
+    // Reader side. The fence orders "I am reading epoch e" before every load that follows,
+    // so a writer that later sees active == 0 knows we cannot hold anything it retired.
+    // Sections nest : only the outermost one announces an epoch, and only its exit clears it,
+    // so an inner exit cannot expose what the outer section still holds.
+    Guard enter() {
+        Slot& s = mySlot();
+        if (s.depth++ == 0) {
+            s.active.store(epoch.load(memory_order_relaxed), memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+        }
+        return Guard(&s);
+    }
+
+    bool inReadSection() { return mySlot().depth > 0; }
+
+    // Call AFTER unpublishing the object. Readers that entered at or before the returned
+    // epoch may still see it; readers entering later cannot.
+    void retire(function<void()> free) {
+        uint64_t e = epoch.fetch_add(1, memory_order_seq_cst);
+        lock_guard<mutex> guard(retireLock);
+        retired.push_back({e, move(free)});
+    }
+
+    size_t reclaim() {
+        vector<function<void()>> ready;
+        {
+            lock_guard<mutex> guard(retireLock);
+            uint64_t oldest = oldestActive();
+            while (!retired.empty() && retired.front().epoch < oldest) {
+                ready.push_back(move(retired.front().free));
+                retired.pop_front();
+            }
+        }
+        for (auto& f : ready) f();
+        return ready.size();
+    }
+
+    size_t pending() {
+        lock_guard<mutex> guard(retireLock);
+        return retired.size();
+    }
+
+    // Blocks until everything retired so far has been freed. From inside a read section it
+    // would wait on this thread's own epoch forever, so that is refused.
+    void synchronize() {
+        if (inReadSection()) throw logic_error("EpochDomain : synchronize() inside a read section would deadlock");
+        while (reclaim(), pending()) this_thread::yield();
+    }
+};
+
+
+//////////////////////////////////////////
+// The registry
+//////////////////////////////////////////
+
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(string_view s) const { return hash<string_view>{}(s); }
+};
+
+template <typename Strategy>
+class StrategyRegistry {
+public:
+    using Table = unordered_map<string, shared_ptr<const Strategy>, StringHash, equal_to<>>;
+
+private:
+    struct State {
+        Table byName;
+        uint64_t version;
+    };
+
+    EpochDomain& domain;
+    atomic<const State*> current;
+    mutex writers;
+    size_t maxPending;
+
+public:
+    class Snapshot {
+        EpochDomain::Guard guard;
+        const State* state;
+    public:
+        Snapshot(EpochDomain::Guard guard, const State* state) : guard(move(guard)), state(state) {}
+
+        const Strategy* find(string_view name) const {
+            auto it = state->byName.find(name);
+            return it == state->byName.end() ? nullptr : it->second.get();
+        }
+
+        uint64_t version() const { return state->version; }
+        const Table& all() const { return state->byName; }
+    };
+
+    explicit StrategyRegistry(size_t maxPending = 1024)
+        : domain(EpochDomain::instance()), current(new State{{}, 0}), maxPending(maxPending) {}
+
+    ~StrategyRegistry() {
+        const State* last = current.load();
+        domain.retire([last] { delete last; });
+        if (domain.inReadSection()) domain.reclaim();
+        else domain.synchronize();
+    }
+
+    Snapshot snapshot() {
+        auto guard = domain.enter();
+        return Snapshot(move(guard), current.load(memory_order_acquire));
+    }
+
+    // Copy, mutate, publish, retire. Writers are serialised; readers never wait for them.
+    template <typename Mutate>
+    uint64_t update(Mutate mutate) {
+        lock_guard<mutex> guard(writers);
+        const State* old = current.load(memory_order_relaxed);
+        auto* next = new State{old->byName, old->version + 1};
+        mutate(next->byName);
+        current.store(next, memory_order_seq_cst);
+        domain.retire([old] { delete old; });
+        // A reader is stuck : don't grow without bound. A writer that is itself reading can
+        // only reclaim; the next update from outside a read section catches up.
+        if (domain.reclaim(), domain.pending() > maxPending && !domain.inReadSection()) {
+            domain.synchronize();
+        }
+        return next->version;
+    }
+
+    uint64_t put(const string& name, shared_ptr<const Strategy> strategy) {
+        return update([&](Table& t) { t[name] = move(strategy); });
+    }
+
+    uint64_t remove(const string& name) {
+        return update([&](Table& t) { t.erase(name); });
+    }
+};
+
+
+//////////////////////////////////////////
+// Strategies + live contexts (SOLID/OCP)
+//////////////////////////////////////////
+
+class PaymentStrategy {
+public:
+    virtual bool pay(int amount) const = 0;
+    virtual ~PaymentStrategy() = default;
+};
+
+class CreditCardPayment : public PaymentStrategy {
+public:
+    bool pay(int amount) const override { return amount > 0; }
+};
+
+class UPIPayment : public PaymentStrategy {
+public:
+    bool pay(int amount) const override { return amount > 0 && amount < 100000; }
+};
+
+class DiscountStrategy {
+public:
+    virtual int getDiscount(int amount) const = 0;
+    virtual ~DiscountStrategy() = default;
+};
+
+class PercentDiscount : public DiscountStrategy {
+    int percent;
+public:
+    explicit PercentDiscount(int percent) : percent(percent) {}
+    int getDiscount(int amount) const override { return amount * percent / 100; }
+};
+
+class NoDiscount : public DiscountStrategy {
+public:
+    int getDiscount(int amount) const override { return 0; }
+};
+
+using PaymentRegistry = StrategyRegistry<PaymentStrategy>;
+using DiscountRegistry = StrategyRegistry<DiscountStrategy>;
+
+class LivePaymentProcessor {
+    PaymentRegistry& registry;
+    string method;
+public:
+    LivePaymentProcessor(PaymentRegistry& registry, string method) : registry(registry), method(move(method)) {}
+
+    bool process(int amount) const {
+        auto snap = registry.snapshot();
+        const PaymentStrategy* strategy = snap.find(method);
+        if (!strategy) throw runtime_error("payment method disabled : " + method);
+        return strategy->pay(amount);
+    }
+};
+
+class LiveDiscountEngine {
+    DiscountRegistry& registry;
+    string rule;
+public:
+    LiveDiscountEngine(DiscountRegistry& registry, string rule) : registry(registry), rule(move(rule)) {}
+
+    int applyDiscount(int amount) const {
+        auto snap = registry.snapshot();
+        const DiscountStrategy* discount = snap.find(rule);
+        return amount - (discount ? discount->getDiscount(amount) : 0);
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+struct CountedDiscount : DiscountStrategy {
+    static inline atomic<int> alive{0};
+    int percent;
+    explicit CountedDiscount(int percent) : percent(percent) { alive++; }
+    ~CountedDiscount() { alive--; }
+    int getDiscount(int amount) const override { return amount * percent / 100; }
+};
+
+void checks() {
+    EpochDomain& domain = EpochDomain::instance();
+    {
+        PaymentRegistry payments;
+        payments.put("card", make_shared<CreditCardPayment>());
+        payments.put("upi", make_shared<UPIPayment>());
+        LivePaymentProcessor upi(payments, "upi");
+        check(upi.process(500), "a live processor resolves its strategy through the registry");
+        payments.remove("upi");
+        bool threw = false;
+        try { upi.process(500); } catch (const runtime_error&) { threw = true; }
+        check(threw, "disabling a gateway takes effect on the next call");
+    }
+
+    {
+        DiscountRegistry discounts;
+        discounts.put("festival", make_shared<CountedDiscount>(10));
+        LiveDiscountEngine festival(discounts, "festival");
+        check(festival.applyDiscount(1000) == 900, "discount rule applied");
+
+        auto before = discounts.snapshot();
+        const DiscountStrategy* oldRule = before.find("festival");
+        thread([&] { discounts.put("festival", make_shared<CountedDiscount>(25)); domain.reclaim(); }).join();
+        check(CountedDiscount::alive == 2 && oldRule->getDiscount(1000) == 100 && before.version() == 1,
+              "a reader's snapshot keeps the old rule alive after an update");
+
+        { auto dropped = move(before); }
+        domain.synchronize();
+        check(CountedDiscount::alive == 1 && festival.applyDiscount(1000) == 750, "old rule is freed once the last reader leaves");
+    }
+    check(CountedDiscount::alive == 0, "registry destructor frees everything");
+
+    {
+        DiscountRegistry other;
+        auto held = other.snapshot();         // still reading when `discounts` below is destroyed
+        DiscountRegistry discounts(4);
+        discounts.put("festival", make_shared<CountedDiscount>(10));
+        auto outer = discounts.snapshot();
+        const DiscountStrategy* outerRule = outer.find("festival");
+        { auto inner = discounts.snapshot(); }
+        for (int v = 1; v <= 10; v++) discounts.put("festival", make_shared<CountedDiscount>(v));
+        check(domain.inReadSection() && outerRule->getDiscount(1000) == 100 && outer.version() == 1,
+              "an inner snapshot's exit does not end the outer read section");
+        check(domain.pending() > 4, "update() past maxPending inside a read section returns instead of deadlocking");
+        bool threw = false;
+        try { domain.synchronize(); } catch (const logic_error&) { threw = true; }
+        check(threw, "synchronize() inside a read section is refused");
+    }
+    domain.synchronize();
+    check(CountedDiscount::alive == 0, "a registry destroyed inside a read section still frees everything");
+
+    // Readers check an invariant every writer keeps : both rules carry the same version number.
+    {
+        DiscountRegistry discounts;
+        auto publish = [&](int v) {
+            discounts.update([v](DiscountRegistry::Table& t) {
+                t["a"] = make_shared<CountedDiscount>(v);
+                t["b"] = make_shared<CountedDiscount>(v);
+            });
+        };
+        publish(0);
+        atomic<bool> stop{false};
+        atomic<long> torn{0}, reads{0};
+        vector<thread> readers;
+        for (int r = 0; r < 3; r++) {
+            readers.emplace_back([&] {
+                while (!stop) {
+                    auto snap = discounts.snapshot();
+                    if (snap.find("a")->getDiscount(100) != snap.find("b")->getDiscount(100)) torn++;
+                    reads++;
+                }
+            });
+        }
+        for (int v = 1; v <= 20000; v++) publish(v % 100);
+        stop = true;
+        for (auto& r : readers) r.join();
+        check(torn == 0 && reads > 0, "readers never see a half-applied update (" + to_string(reads.load()) + " reads)");
+        domain.synchronize();
+        check(CountedDiscount::alive == 2, "every retired state was reclaimed");
+    }
+}
+
+
+//////////////////////////////////////////
+// Benchmark : read-side cost while a writer updates in a tight loop
+//////////////////////////////////////////
+
+static double threadCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Lock-based alternative : same copy-on-write table, but readers take a mutex.
+class MutexDiscounts {
+    mutex lock;
+    DiscountRegistry::Table table;
+public:
+    void put(const string& name, shared_ptr<const DiscountStrategy> s) {
+        auto next = table;
+        next[name] = move(s);
+        lock_guard<mutex> guard(lock);
+        table.swap(next);
+    }
+    int applyDiscount(string_view rule, int amount) {
+        lock_guard<mutex> guard(lock);
+        auto it = table.find(rule);
+        return amount - (it == table.end() ? 0 : it->second->getDiscount(amount));
+    }
+};
+
+// Refcounted alternative : readers copy an atomic<shared_ptr> (a refcount inc + dec per read).
+class SharedPtrDiscounts {
+    atomic<shared_ptr<const DiscountRegistry::Table>> table{make_shared<const DiscountRegistry::Table>()};
+public:
+    void put(const string& name, shared_ptr<const DiscountStrategy> s) {
+        auto next = make_shared<DiscountRegistry::Table>(*table.load());
+        (*next)[name] = move(s);
+        table.store(move(next));
+    }
+    int applyDiscount(string_view rule, int amount) {
+        auto t = table.load();
+        auto it = t->find(rule);
+        return amount - (it == t->end() ? 0 : it->second->getDiscount(amount));
+    }
+};
+
+template <typename Read, typename Write>
+pair<double, long> measure(Read read, Write write, bool withWriter, long reads) {
+    atomic<bool> stop{false};
+    atomic<long> writes{0};
+    thread writer;
+    if (withWriter) {
+        writer = thread([&] {
+            for (int v = 0; !stop.load(memory_order_relaxed); v++) { write(v); writes.fetch_add(1, memory_order_relaxed); }
+        });
+    }
+    long sink = 0;
+    double cpu = threadCpuSeconds();
+    for (long i = 0; i < reads; i++) sink += read(1000 + (i & 255));
+    cpu = threadCpuSeconds() - cpu;
+    stop = true;
+    if (writer.joinable()) writer.join();
+    if (sink == 42) cout << "";
+    return {cpu * 1e9 / reads, writes.load()};
+}
+
+void benchmark() {
+    const long reads = 5000000;
+    auto rule = [](int v) { return make_shared<PercentDiscount>(5 + v % 20); };
+
+    cout << "\n--- applyDiscount read cost (reader thread CPU time), " << reads << " reads ---\n";
+    cout << left << setw(44) << "mode" << right << setw(14) << "idle writer" << setw(14) << "busy writer" << setw(12) << "writes" << "\n";
+
+    auto row = [&](const string& label, auto read, auto write) {
+        auto idle = measure(read, write, false, reads);
+        auto busy = measure(read, write, true, reads);
+        cout << left << setw(44) << label << right << fixed << setprecision(1) << setw(11) << idle.first << " ns"
+             << setw(11) << busy.first << " ns" << setw(12) << busy.second << "\n";
+    };
+
+    {
+        auto fixedRule = make_unique<PercentDiscount>(10);
+        row("fixed unique_ptr (DiscountEngine, no swap)", [&](int a) { return a - fixedRule->getDiscount(a); }, [](int) {});
+    }
+    {
+        MutexDiscounts m;
+        m.put("festival", rule(0));
+        row("mutex around the table", [&](int a) { return m.applyDiscount("festival", a); }, [&](int v) { m.put("festival", rule(v)); });
+    }
+    {
+        SharedPtrDiscounts s;
+        s.put("festival", rule(0));
+        row("atomic<shared_ptr> table", [&](int a) { return s.applyDiscount("festival", a); }, [&](int v) { s.put("festival", rule(v)); });
+    }
+    {
+        DiscountRegistry registry;
+        registry.put("festival", rule(0));
+        LiveDiscountEngine engine(registry, "festival");
+        row("StrategyRegistry (epoch RCU)", [&](int a) { return engine.applyDiscount(a); }, [&](int v) { registry.put("festival", rule(v)); });
+    }
+}
+
+
+int main() {
+    checks();
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,430 @@
+/*
+
+Sliding-Window Velocity Checks for Payment Screening
+
+Problem :
+    PaymentService::processPayment(userId, amount) (SOLID/SRP) accepts any call.
+    A stolen card can be used 200 times in a minute. We want rules like
+        "more than 5 payments or more than 20000 in 10 minutes per user"
+        "more than 3 payments in 1 minute per card"
+    checked inline, in well under a microsecond, for millions of users and cards.
+
+Solution : per key, a ring of time buckets.
+
+    window = 10 min, 10 buckets of 1 min :
+
+        [ 1 | 0 | 2 | 0 | 0 | 1 | 0 | 0 | 0 | 3 ]    + running totals (count, amount)
+                                              ^ current minute
+
+> Lazy expiry : nothing runs in the background. When a key is touched we move its
+  "current bucket" forward and subtract the buckets that fell out of the window.
+  So a check is O(1) : compare running totals with the limit.
+> Sharded store : key -> hash -> shard. Each shard has its own lock, an open-addressing
+  index and a fixed pool of entries (~160 bytes per key). Bucket counters are as wide
+  as the running totals (32-bit counts, 64-bit amounts), so a hot key cannot wrap one.
+> Memory is bounded : when a shard's pool is full, a least recently used key is
+  evicted (CLOCK, an LRU approximation). A key idle for a whole window holds
+  nothing useful anyway.
+> Several rules : all must pass. If a later rule says no, the earlier ones are
+  rolled back so a declined payment does not count against the user.
+
+Measured cost (one core, two rules = two lookups per check) :
+    ~0.3 us per check while the active keys fit in cache, but ~1.1-1.4 us with
+    1M users, where both lookups miss cache (index slot + entry, per rule).
+    So the "well under a microsecond" target only holds for a hot working set;
+    at 1M users it is missed by about 1.5x. A multi-thread row needs more than one
+    CPU to mean anything; on a 1-CPU host it only shows the threads taking turns.
+
+*/
+
+#include<bits/stdc++.h>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+
+//////////////////////////////////////////
+// Window counter
+//////////////////////////////////////////
+
+static constexpr int kBuckets = 10;
+
+struct WindowCounter {
+    uint32_t lastBucket = 0;          // absolute bucket number of the newest bucket
+    uint32_t totalCount = 0;
+    uint64_t totalAmount = 0;
+    uint32_t counts[kBuckets] = {};   // same width as the totals : a bucket cannot wrap before they do
+    uint64_t amounts[kBuckets] = {};
+
+    // Slides the window so that `bucket` is the newest one.
+    void advance(uint32_t bucket) {
+        if (bucket <= lastBucket) return;
+        uint32_t steps = bucket - lastBucket;
+        if (steps >= kBuckets) {
+            *this = WindowCounter{};
+        } else {
+            for (uint32_t i = 1; i <= steps; i++) {
+                int idx = (lastBucket + i) % kBuckets;
+                totalCount -= counts[idx];
+                totalAmount -= amounts[idx];
+                counts[idx] = 0;
+                amounts[idx] = 0;
+            }
+        }
+        lastBucket = bucket;
+    }
+
+    void add(uint32_t amount) {
+        int idx = lastBucket % kBuckets;
+        counts[idx]++;
+        amounts[idx] += amount;
+        totalCount++;
+        totalAmount += amount;
+    }
+
+    void remove(uint32_t amount) {
+        int idx = lastBucket % kBuckets;
+        if (counts[idx] == 0) return;
+        counts[idx]--;
+        amounts[idx] -= amount;
+        totalCount--;
+        totalAmount -= amount;
+    }
+};
+
+
+//////////////////////////////////////////
+// Sharded store with CLOCK (approximate LRU) eviction
+//////////////////////////////////////////
+
+static uint64_t hashKey(string_view s) {
+    uint64_t h = 1469598103934665603ull;
+    for (char c : s) h = (h ^ (uint8_t)c) * 1099511628211ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+class WindowStore {
+private:
+    struct Entry {
+        uint64_t key;
+        WindowCounter window;
+        bool referenced;              // CLOCK bit : set on every touch, cleared by the hand
+    };
+
+    struct alignas(64) Shard {
+        mutex lock;
+        vector<Entry> entries;
+        vector<uint32_t> index;       // open addressing : entry + 1, 0 = empty
+        uint32_t hand = 0;
+        uint64_t evictions = 0;
+    };
+
+    vector<Shard> shards;
+    uint32_t perShardCapacity;
+    int shardBits;
+
+    int indexBits() const { return 64 - __builtin_clzll((uint64_t)perShardCapacity * 2 - 1); }
+    size_t slotFor(uint64_t key) const { return (key * 0x9E3779B97F4A7C15ull) >> (64 - indexBits()); }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    void eraseFromIndex(Shard& s, uint64_t key) {
+        size_t mask = s.index.size() - 1;
+        size_t i = slotFor(key);
+        while (s.entries[s.index[i] - 1].key != key) i = (i + 1) & mask;
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask; s.index[j] != 0; j = (j + 1) & mask) {
+            size_t home = slotFor(s.entries[s.index[j] - 1].key);
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                s.index[hole] = s.index[j];
+                hole = j;
+            }
+        }
+        s.index[hole] = 0;
+    }
+
+    // CLOCK : skip (and clear) recently used entries, evict the first one not used since
+    // the hand last passed. Close to LRU, but a touch is one store instead of list surgery.
+    uint32_t evict(Shard& s) {
+        while (s.entries[s.hand].referenced) {
+            s.entries[s.hand].referenced = false;
+            s.hand = (s.hand + 1) % s.entries.size();
+        }
+        uint32_t e = s.hand;
+        s.hand = (s.hand + 1) % s.entries.size();
+        eraseFromIndex(s, s.entries[e].key);
+        s.evictions++;
+        return e;
+    }
+
+    // Returns the entry for key, creating it (and evicting an old key if full).
+    Entry& lookup(Shard& s, uint64_t key) {
+        size_t mask = s.index.size() - 1;
+        size_t i = slotFor(key);
+        for (; s.index[i] != 0; i = (i + 1) & mask) {
+            Entry& x = s.entries[s.index[i] - 1];
+            if (x.key == key) {
+                x.referenced = true;
+                return x;
+            }
+        }
+
+        uint32_t e;
+        if (s.entries.size() < perShardCapacity) {
+            e = s.entries.size();
+            s.entries.push_back({});
+        } else {
+            e = evict(s);
+            i = slotFor(key);                                   // the shift may have moved things
+            while (s.index[i] != 0) i = (i + 1) & mask;
+        }
+        s.entries[e] = Entry{key, {}, true};
+        s.index[i] = e + 1;
+        return s.entries[e];
+    }
+
+public:
+    WindowStore(size_t maxKeys, int shardBits = 6) : shards(size_t(1) << shardBits), shardBits(shardBits) {
+        perShardCapacity = max<uint32_t>(16, (maxKeys + shards.size() - 1) / shards.size());
+        for (auto& s : shards) {
+            s.entries.reserve(perShardCapacity);
+            s.index.assign(size_t(1) << indexBits(), 0);
+        }
+    }
+
+    // Runs f(window) under the shard lock for key.
+    template<class F>
+    auto withWindow(uint64_t key, F&& f) {
+        Shard& s = shards[key >> (64 - shardBits)];
+        lock_guard<mutex> guard(s.lock);
+        return f(lookup(s, key).window);
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for (auto& s : shards) { lock_guard<mutex> guard(s.lock); n += s.entries.size(); }
+        return n;
+    }
+
+    uint64_t evictions() {
+        uint64_t n = 0;
+        for (auto& s : shards) { lock_guard<mutex> guard(s.lock); n += s.evictions; }
+        return n;
+    }
+
+    size_t bytesPerKey() const {
+        return sizeof(Entry) + sizeof(uint32_t) * (size_t(1) << indexBits()) / perShardCapacity;
+    }
+};
+
+
+//////////////////////////////////////////
+// Rules + guard
+//////////////////////////////////////////
+
+enum class KeyKind { User, Card };
+
+struct VelocityRule {
+    string name;
+    KeyKind kind;
+    chrono::milliseconds window;
+    uint32_t maxCount;
+    uint64_t maxAmount;
+};
+
+struct Decision {
+    bool allowed;
+    string rule;                  // which rule declined
+};
+
+class VelocityGuard {
+private:
+    struct Limiter {
+        VelocityRule rule;
+        int64_t bucketMillis;
+        unique_ptr<WindowStore> store;
+    };
+    vector<Limiter> limiters;
+
+    static int64_t nowMillis() {
+        return chrono::duration_cast<chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+public:
+    VelocityGuard(const vector<VelocityRule>& rules, size_t maxKeysPerRule) {
+        for (auto& r : rules) {
+            if (r.window.count() < kBuckets) throw invalid_argument("window too small for rule " + r.name);
+            limiters.push_back({r, r.window.count() / kBuckets, make_unique<WindowStore>(maxKeysPerRule)});
+        }
+    }
+
+    // Checks every rule and records the payment if all pass. nowMs defaults to the steady clock.
+    Decision check(string_view userId, string_view cardFingerprint, uint32_t amount, int64_t nowMs = -1) {
+        if (nowMs < 0) nowMs = nowMillis();
+        uint64_t userKey = hashKey(userId), cardKey = hashKey(cardFingerprint);
+        for (size_t i = 0; i < limiters.size(); i++) {
+            Limiter& l = limiters[i];
+            uint32_t bucket = nowMs / l.bucketMillis;
+            uint64_t key = l.rule.kind == KeyKind::User ? userKey : cardKey;
+            bool ok = l.store->withWindow(key, [&](WindowCounter& w) {
+                w.advance(bucket);
+                if ((uint64_t)w.totalCount + 1 > l.rule.maxCount || amount > l.rule.maxAmount ||
+                    w.totalAmount > l.rule.maxAmount - amount) return false;       // no overflow near UINT64_MAX
+                w.add(amount);
+                return true;
+            });
+            if (!ok) {
+                for (size_t j = 0; j < i; j++) {                       // undo the rules that already counted it
+                    Limiter& p = limiters[j];
+                    uint64_t k = p.rule.kind == KeyKind::User ? userKey : cardKey;
+                    p.store->withWindow(k, [&](WindowCounter& w) { w.advance(nowMs / p.bucketMillis); w.remove(amount); });
+                }
+                return {false, l.rule.name};
+            }
+        }
+        return {true, ""};
+    }
+
+    size_t trackedKeys() {
+        size_t n = 0;
+        for (auto& l : limiters) n += l.store->size();
+        return n;
+    }
+
+    size_t bytesPerKey() const { return limiters.empty() ? 0 : limiters[0].store->bytesPerKey(); }
+};
+
+
+//////////////////////////////////////////
+// Payment path
+//////////////////////////////////////////
+
+class PaymentService {
+public:
+    bool processPayment(int userId, int amount) {
+        // Simulate payment gateway
+        return true;
+    }
+};
+
+// Same processPayment, screened first. Declined calls never reach the gateway.
+class ScreenedPaymentService {
+private:
+    PaymentService& payments;
+    VelocityGuard& guard;
+
+public:
+    ScreenedPaymentService(PaymentService& payments, VelocityGuard& guard) : payments(payments), guard(guard) {}
+
+    bool processPayment(int userId, int amount, string_view cardFingerprint, string* declinedBy = nullptr) {
+        Decision d = guard.check(to_string(userId), cardFingerprint, amount);
+        if (!d.allowed) {
+            if (declinedBy) *declinedBy = d.rule;
+            return false;
+        }
+        return payments.processPayment(userId, amount);
+    }
+};
+
+
+//////////////////////////////////////////
+// Checks + benchmark
+//////////////////////////////////////////
+
+static void check(bool condition, const string& what) {
+    cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) exit(1);
+}
+
+void checks() {
+    using namespace chrono_literals;
+    VelocityGuard guard({{"user-5-per-10min", KeyKind::User, 10min, 5, 20000},
+                         {"card-3-per-1min", KeyKind::Card, 1min, 3, UINT64_MAX}}, 10000);
+    int64_t t = 1000000000;
+
+    int allowed = 0;
+    for (int i = 0; i < 5; i++) allowed += guard.check("alice", "card-" + to_string(i), 100, t + i * 1000).allowed;
+    Decision sixth = guard.check("alice", "card-9", 100, t + 6000);
+    check(allowed == 5 && !sixth.allowed && sixth.rule == "user-5-per-10min", "6th payment in 10 minutes is declined");
+    check(guard.check("alice", "card-9", 100, t + 11 * 60000).allowed, "allowed again once the window has slid past");
+
+    Decision big = guard.check("bob", "card-b", 25000, t);
+    check(!big.allowed && big.rule == "user-5-per-10min", "amount limit declines a large payment");
+
+    for (int i = 0; i < 3; i++) guard.check("u" + to_string(i), "shared-card", 10, t);
+    Decision carded = guard.check("carol", "shared-card", 10, t);
+    check(!carded.allowed && carded.rule == "card-3-per-1min", "card used by many users is declined");
+    int carolAllowed = 0;
+    for (int i = 0; i < 5; i++) carolAllowed += guard.check("carol", "carol-card-" + to_string(i), 10, t + i).allowed;
+    check(carolAllowed == 5, "a declined payment is rolled back and does not count against the user");
+
+    WindowStore small(1024, 2);
+    for (uint64_t k = 1; k <= 5000; k++) small.withWindow(hashKey(to_string(k)), [](WindowCounter& w) { w.add(1); });
+    bool recentKept = small.withWindow(hashKey("5000"), [](WindowCounter& w) { return w.totalCount == 1; });
+    bool oldGone = small.withWindow(hashKey("1"), [](WindowCounter& w) { return w.totalCount == 0; });
+    check(small.size() <= 1024 && small.evictions() > 0 && recentKept && oldGone,
+          "memory is bounded : least recently used keys are evicted");
+
+    WindowCounter busy;
+    busy.advance(100);
+    for (int i = 0; i < 70000; i++) busy.add(100000);          // 70000 payments, 7e9 in one bucket
+    bool exact = busy.totalCount == 70000 && busy.totalAmount == 7000000000ull;
+    busy.advance(101);
+    busy.add(1);
+    busy.advance(100 + kBuckets);                              // the busy bucket slides out
+    check(exact && busy.totalCount == 1 && busy.totalAmount == 1, "a bucket holding more than 65535 payments / 4e9 does not wrap");
+
+    PaymentService payments;
+    ScreenedPaymentService screened(payments, guard);
+    string rule;
+    int ok = 0;
+    for (int i = 0; i < 7; i++) ok += screened.processPayment(42, 100, "card-42-" + to_string(i), &rule);
+    check(ok == 5 && rule == "user-5-per-10min", "ScreenedPaymentService declines before the gateway");
+}
+
+void benchmark(size_t users, int threads, long checksPerThread) {
+    using namespace chrono_literals;
+    VelocityGuard guard({{"user-10min", KeyKind::User, 10min, 50, 1000000},
+                         {"card-1min", KeyKind::Card, 1min, 20, 500000}}, users);
+
+    vector<string> ids(users), cards(users);
+    for (size_t i = 0; i < users; i++) { ids[i] = "user" + to_string(i); cards[i] = "card" + to_string(i * 7); }
+
+    atomic<long> declined{0};
+    auto start = Clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            mt19937_64 rng(t);
+            long d = 0;
+            for (long i = 0; i < checksPerThread; i++) {
+                size_t u = rng() % users;
+                d += !guard.check(ids[u], cards[u], 100 + (rng() & 1023)).allowed;
+            }
+            declined += d;
+        });
+    }
+    for (auto& w : workers) w.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+    long total = checksPerThread * threads;
+    cout << setw(2) << threads << " thread(s)" << (threads > (int)thread::hardware_concurrency() ? "*" : "") << ", " << users << " users : " << (long)(total / sec) << " checks/sec ("
+         << fixed << setprecision(0) << sec * 1e9 / total << " ns per check), "
+         << guard.trackedKeys() << " windows, " << guard.bytesPerKey() << " bytes per key, " << declined << " declined\n";
+}
+
+
+int main() {
+    checks();
+
+    cout << "\n--- throughput (2 rules : per user, per card), " << thread::hardware_concurrency() << " CPU(s) ---\n";
+    benchmark(10000, 1, 3000000);          // active users fit in cache
+    benchmark(1000000, 1, 3000000);        // every check misses cache
+    benchmark(1000000, 4, 750000);
+    if (thread::hardware_concurrency() < 4) {
+        cout << "* more threads than CPUs : the threads just take turns, so this row says nothing about scaling\n";
+    }
+
+    return 0;
+}